@@ -64,6 +64,7 @@ void EffectContainer::addSlider(const juce::String& parameterID,
         
         DBG("Storing control for: " + parameterID);
         // Store the control
+        control.parameterID = parameterID;
         controls.push_back(std::move(control));
         DBG("Control stored successfully for: " + parameterID);
     }
@@ -105,6 +106,7 @@ void EffectContainer::addToggleButton(const juce::String& parameterID,
         
         DBG("Storing toggle control for: " + parameterID);
         // Store the control
+        control.parameterID = parameterID;
         controls.push_back(std::move(control));
         DBG("Toggle control stored successfully for: " + parameterID);
     }
@@ -115,6 +117,117 @@ void EffectContainer::addToggleButton(const juce::String& parameterID,
     }
 }
 
+void EffectContainer::addComboBox(const juce::String& parameterID,
+                                  const juce::String& labelText,
+                                  juce::AudioProcessorValueTreeState& apvts)
+{
+    DBG("EffectContainer::addComboBox - Parameter: " + parameterID + ", Label: " + labelText);
+    
+    try 
+    {
+        ParameterControl control;
+        
+        // Create the drop-down with the parameter's own options, before attaching
+        control.comboBox = std::make_unique<juce::ComboBox>();
+        
+        if (auto* choice = dynamic_cast<juce::AudioParameterChoice*>(apvts.getParameter(parameterID)))
+            control.comboBox->addItemList(choice->choices, 1);  // Start IDs from 1
+        
+        // Create label
+        control.label = std::make_unique<juce::Label>();
+        control.label->setText(labelText, juce::dontSendNotification);
+        control.label->setFont(juce::Font(12.0f));
+        control.label->setJustificationType(juce::Justification::centred);
+        control.label->setColour(juce::Label::textColourId, juce::Colours::white);
+        
+        // Create attachment
+        control.comboBoxAttachment = std::make_unique<juce::AudioProcessorValueTreeState::ComboBoxAttachment>(
+            apvts, parameterID, *control.comboBox);
+        
+        // Add to component and make visible
+        addAndMakeVisible(*control.comboBox);
+        addAndMakeVisible(*control.label);
+        
+        // Store the control
+        control.parameterID = parameterID;
+        controls.push_back(std::move(control));
+    }
+    catch (const std::exception& e)
+    {
+        DBG("EXCEPTION in EffectContainer::addComboBox for " + parameterID + ": " + juce::String(e.what()));
+        throw;
+    }
+}
+
+void EffectContainer::addSelector(const juce::String& labelText,
+                                  const juce::StringArray& items,
+                                  std::function<void(int)> onChange)
+{
+    ParameterControl control;
+    
+    // Create the drop-down, starting on the first item without calling back
+    control.comboBox = std::make_unique<juce::ComboBox>();
+    control.comboBox->addItemList(items, 1);  // Start IDs from 1
+    control.comboBox->setSelectedItemIndex(0, juce::dontSendNotification);
+    
+    auto* comboBox = control.comboBox.get();
+    control.comboBox->onChange = [comboBox, onChange = std::move(onChange)]
+    {
+        if (onChange != nullptr)
+            onChange(comboBox->getSelectedItemIndex());
+    };
+    
+    // Create label
+    control.label = std::make_unique<juce::Label>();
+    control.label->setText(labelText, juce::dontSendNotification);
+    control.label->setFont(juce::Font(12.0f));
+    control.label->setJustificationType(juce::Justification::centred);
+    control.label->setColour(juce::Label::textColourId, juce::Colours::white);
+    
+    // Add to component and make visible
+    addAndMakeVisible(*control.comboBox);
+    addAndMakeVisible(*control.label);
+    
+    // Store the control
+    controls.push_back(std::move(control));
+}
+
+void EffectContainer::retargetControl(const juce::String& currentID,
+                                      const juce::String& newID,
+                                      juce::AudioProcessorValueTreeState& apvts)
+{
+    for (auto& control : controls)
+    {
+        if (control.parameterID != currentID)
+            continue;
+        
+        // Drop the old attachment before the new one takes the control over
+        if (control.slider)
+        {
+            control.sliderAttachment.reset();
+            control.sliderAttachment = std::make_unique<juce::AudioProcessorValueTreeState::SliderAttachment>(
+                apvts, newID, *control.slider);
+        }
+        else if (control.toggleButton)
+        {
+            control.buttonAttachment.reset();
+            control.buttonAttachment = std::make_unique<juce::AudioProcessorValueTreeState::ButtonAttachment>(
+                apvts, newID, *control.toggleButton);
+        }
+        else if (control.comboBox)
+        {
+            control.comboBoxAttachment.reset();
+            control.comboBoxAttachment = std::make_unique<juce::AudioProcessorValueTreeState::ComboBoxAttachment>(
+                apvts, newID, *control.comboBox);
+        }
+        
+        control.parameterID = newID;
+        return;
+    }
+    
+    jassertfalse;   // no control shows currentID
+}
+
 //==============================================================================
 void EffectContainer::setEnabledState(bool enabled)
 {
@@ -144,6 +257,11 @@ void EffectContainer::setEnabledState(bool enabled)
         {
             control.toggleButton->setEnabled(isEnabled);
         }
+        else if (control.comboBox)
+        {
+            control.comboBox->setEnabled(isEnabled);
+            control.label->setColour(juce::Label::textColourId, isEnabled ? juce::Colours::white : juce::Colours::grey);
+        }
     }
 
     repaint();
@@ -213,6 +331,12 @@ void EffectContainer::resized()
                 // For toggle buttons, use the full space
                 controls[i].toggleButton->setBounds(controlBounds);
             }
+            else if (controls[i].comboBox)
+            {
+                // For drop-downs, label below and the box centred above it
+                controls[i].label->setBounds(controlBounds.removeFromBottom(labelHeight));
+                controls[i].comboBox->setBounds(controlBounds.withSizeKeepingCentre(controlBounds.getWidth(), juce::jmin(controlBounds.getHeight(), 24)));
+            }
         }
     }
     else
@@ -239,6 +363,12 @@ void EffectContainer::resized()
                 // For toggle buttons, use the full space
                 control.toggleButton->setBounds(controlBounds);
             }
+            else if (control.comboBox)
+            {
+                // For drop-downs, label below and the box centred above it
+                control.label->setBounds(controlBounds.removeFromBottom(labelHeight));
+                control.comboBox->setBounds(controlBounds.withSizeKeepingCentre(controlBounds.getWidth(), juce::jmin(controlBounds.getHeight(), 24)));
+            }
 
             // Add spacing between controls
             if (&control != &controls.back())
@@ -10,6 +10,7 @@
 
 #include <juce_gui_basics/juce_gui_basics.h>
 #include <juce_audio_processors/juce_audio_processors.h>
+#include <functional>
 #include <memory>
 #include <vector>
 
@@ -40,6 +41,24 @@ public:
                         const juce::String& labelText,
                         juce::AudioProcessorValueTreeState& apvts);
 
+    /** Adds a drop-down listing a choice parameter's options, with automatic
+        attachment to APVTS parameter. */
+    void addComboBox(const juce::String& parameterID,
+                     const juce::String& labelText,
+                     juce::AudioProcessorValueTreeState& apvts);
+
+    /** Adds a drop-down that is not tied to a parameter, calling onChange with
+        the index of the item picked. The first item starts out selected. */
+    void addSelector(const juce::String& labelText,
+                     const juce::StringArray& items,
+                     std::function<void(int)> onChange);
+
+    /** Re-attaches the control showing currentID to newID, keeping its place
+        and label, so one set of controls can edit several similar parameters. */
+    void retargetControl(const juce::String& currentID,
+                         const juce::String& newID,
+                         juce::AudioProcessorValueTreeState& apvts);
+
     /** Sets the enabled state of the container (affects visual appearance). */
     void setEnabledState(bool enabled);
 
@@ -57,9 +76,12 @@ private:
     {
         std::unique_ptr<juce::Slider> slider;
         std::unique_ptr<juce::ToggleButton> toggleButton;
+        std::unique_ptr<juce::ComboBox> comboBox;
         std::unique_ptr<juce::Label> label;
         std::unique_ptr<juce::AudioProcessorValueTreeState::SliderAttachment> sliderAttachment;
         std::unique_ptr<juce::AudioProcessorValueTreeState::ButtonAttachment> buttonAttachment;
+        std::unique_ptr<juce::AudioProcessorValueTreeState::ComboBoxAttachment> comboBoxAttachment;
+        juce::String parameterID;   // empty for a selector
         
         ParameterControl() = default;
         ~ParameterControl() = default;
@@ -0,0 +1,116 @@
+/*
+  ==============================================================================
+
+    BatchBitCrusherNode.cpp
+
+  ==============================================================================
+*/
+
+#include "BatchBitCrusherNode.h"
+
+//==============================================================================
+BatchBitCrusherNode::BatchBitCrusherNode()
+{
+    // Every lane starts at the same defaults as BitCrusherNode
+    for (size_t lane = 0; lane < numBatchLanes; ++lane)
+    {
+        setBitDepth(lane, 16.0f);
+        setSampleRateReduction(lane, 1.0f);
+    }
+}
+
+//==============================================================================
+void BatchBitCrusherNode::prepare(const juce::dsp::ProcessSpec& spec)
+{
+    currentSampleRate = spec.sampleRate;
+    mix.reset(currentSampleRate, smoothingTimeSeconds);
+
+    // One sample and hold per channel, covering every lane
+    holdValues.resize(spec.numChannels);
+    sampleCounters.resize(spec.numChannels);
+
+    reset();
+}
+
+void BatchBitCrusherNode::reset()
+{
+    std::fill(holdValues.begin(), holdValues.end(), BatchLane::expand(0.0f));
+    std::fill(sampleCounters.begin(), sampleCounters.end(), BatchLane::expand(0.0f));
+}
+
+//==============================================================================
+void BatchBitCrusherNode::setBitDepth(size_t lane, float depth)
+{
+    const float bitDepth = juce::jlimit(1.0f, 16.0f, depth);
+    const float levels = std::pow(2.0f, bitDepth);
+
+    quantizationLevels.set(lane, levels);
+    stepSizes.set(lane, 1.0f / levels);
+    setLaneMask(quantizing, lane, bitDepth < 16.0f);
+}
+
+void BatchBitCrusherNode::setSampleRateReduction(size_t lane, float reduction)
+{
+    const float sampleRateReduction = juce::jlimit(1.0f, 50.0f, reduction);
+
+    reductionFactors.set(lane, static_cast<float>(static_cast<int>(sampleRateReduction)));
+    setLaneMask(reducing, lane, sampleRateReduction > 1.0f);
+}
+
+void BatchBitCrusherNode::setMix(size_t lane, float mixValue)
+{
+    mix.setTargetValue(lane, juce::jlimit(0.0f, 1.0f, mixValue));
+}
+
+void BatchBitCrusherNode::setSmoothingTime(double seconds)
+{
+    smoothingTimeSeconds = seconds;
+    mix.reset(currentSampleRate, smoothingTimeSeconds);
+}
+
+//==============================================================================
+void BatchBitCrusherNode::process(const juce::dsp::AudioBlock<BatchLane>& block) noexcept
+{
+    const auto numSamples = block.getNumSamples();
+    const auto one = BatchLane::expand(1.0f);
+    const auto half = BatchLane::expand(0.5f);
+
+    for (size_t start = 0; start < numSamples; start += static_cast<size_t>(maxSubBlockSize))
+    {
+        const auto subBlockSize = juce::jmin(numSamples - start, static_cast<size_t>(maxSubBlockSize));
+        const bool mixRamping = mix.advance(static_cast<int>(subBlockSize));
+        const BatchLane steadyMix = mix.getCurrentValue();
+
+        for (size_t channel = 0; channel < block.getNumChannels(); ++channel)
+        {
+            auto* data = block.getChannelPointer(channel) + start;
+            BatchLane hold = holdValues[channel];
+            BatchLane counter = sampleCounters[channel];
+
+            for (size_t sample = 0; sample < subBlockSize; ++sample)
+            {
+                const BatchLane input = data[sample];
+
+                // Sample and hold: a lane takes a new sample once its counter reaches
+                // the factor. Lanes without reduction pass the input and keep their state.
+                const auto due = BatchLane::greaterThanOrEqual(counter, reductionFactors);
+                const BatchLane held = selectLanes(due, input, hold);
+
+                hold = selectLanes(reducing, held, hold);
+                counter = selectLanes(reducing, selectLanes(due, BatchLane::expand(0.0f), counter) + one, counter);
+
+                BatchLane wetSignal = selectLanes(reducing, held, input);
+
+                // Bit depth reduction
+                const BatchLane quantized = floorLanes(wetSignal * quantizationLevels + half) * stepSizes;
+                wetSignal = selectLanes(quantizing, quantized, wetSignal);
+
+                const BatchLane mixAmount = mixRamping ? mix.getRamp()[sample] : steadyMix;
+                data[sample] = input * (one - mixAmount) + wetSignal * mixAmount;
+            }
+
+            holdValues[channel] = hold;
+            sampleCounters[channel] = counter;
+        }
+    }
+}
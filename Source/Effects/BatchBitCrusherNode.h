@@ -0,0 +1,80 @@
+/*
+  ==============================================================================
+
+    BatchBitCrusherNode.h
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <juce_dsp/juce_dsp.h>
+#include <juce_audio_basics/juce_audio_basics.h>
+#include <juce_core/juce_core.h>
+#include <array>
+#include <vector>
+#include "BatchLanes.h"
+
+//==============================================================================
+/**
+    The bit crusher for a batch of instances, one per SIMD lane.
+    
+    Every lane does what BitCrusherNode<float> does, with its own bit depth,
+    sample rate reduction and mix. The sample and hold is branch-free, so lanes
+    with and without reduction share the same instructions. Quantization
+    multiplies by the step size rather than dividing by the step count, which
+    can differ from BitCrusherNode in the last bit.
+*/
+class BatchBitCrusherNode
+{
+public:
+    //==============================================================================
+    BatchBitCrusherNode();
+    ~BatchBitCrusherNode() = default;
+    
+    //==============================================================================
+    /** Prepares every lane for playback. spec describes a single instance. */
+    void prepare(const juce::dsp::ProcessSpec& spec);
+    
+    /** Resets every lane's internal state. */
+    void reset();
+    
+    /** Crushes every lane of the block in place. */
+    void process(const juce::dsp::AudioBlock<BatchLane>& block) noexcept;
+    
+    //==============================================================================
+    /** Sets one lane's bit depth (1-16 bits). */
+    void setBitDepth(size_t lane, float depth);
+    
+    /** Sets one lane's sample rate reduction factor (1-50). */
+    void setSampleRateReduction(size_t lane, float reduction);
+    
+    /** Sets one lane's wet/dry mix (0.0 = dry, 1.0 = wet). */
+    void setMix(size_t lane, float mixValue);
+    
+    /** Sets the ramp length used when a lane's mix changes. */
+    void setSmoothingTime(double seconds);
+    
+private:
+    //==============================================================================
+    /** The mix ramp is computed this many samples at a time. */
+    static constexpr int maxSubBlockSize = BatchLaneParameter<>::maxRampLength;
+    
+    // Per-lane settings, already in the form the kernel uses
+    BatchLane quantizationLevels = BatchLane::expand(65536.0f);
+    BatchLane stepSizes = BatchLane::expand(1.0f / 65536.0f);
+    BatchLane reductionFactors = BatchLane::expand(1.0f);
+    BatchLaneMask quantizing {};
+    BatchLaneMask reducing {};
+    BatchLaneParameter<> mix { 0.5f };
+    
+    // Sample and hold state for each channel, sized in prepare(). The counters
+    // are kept as floats so they compare against the factors lane by lane.
+    std::vector<BatchLane> holdValues;
+    std::vector<BatchLane> sampleCounters;
+    
+    double currentSampleRate = 44100.0;
+    double smoothingTimeSeconds = 0.02;
+    
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(BatchBitCrusherNode)
+};
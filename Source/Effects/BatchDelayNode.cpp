@@ -0,0 +1,230 @@
+/*
+  ==============================================================================
+
+    BatchDelayNode.cpp
+
+  ==============================================================================
+*/
+
+#include "BatchDelayNode.h"
+
+//==============================================================================
+BatchDelayNode::BatchDelayNode()
+{
+    // Every lane starts at the same defaults as DelayNode
+    delayTimesMs.fill(250.0f);
+    lowPassCutoffs.fill(8000.0f);
+
+    for (size_t lane = 0; lane < numBatchLanes; ++lane)
+    {
+        updateDelayTime(lane);
+        updateLowPassFilter(lane);
+    }
+}
+
+//==============================================================================
+void BatchDelayNode::prepare(const juce::dsp::ProcessSpec& spec)
+{
+    currentSampleRate = spec.sampleRate;
+
+    // Room for the longest delay at this sample rate. An unchanged size keeps the
+    // buffer it has, and reset() leaves its contents for the reads to clear.
+    maxDelayInSamples = static_cast<int>(std::ceil(maxDelaySeconds * currentSampleRate));
+    bufferLength = maxDelayInSamples + 2;
+
+    delayBuffer.resize(static_cast<size_t>(bufferLength) * spec.numChannels);
+    lowPassStates.resize(spec.numChannels);
+
+    // Update parameters and snap the smoothers to their targets
+    for (size_t lane = 0; lane < numBatchLanes; ++lane)
+    {
+        updateDelayTime(lane);
+        updateLowPassFilter(lane);
+    }
+
+    delayTimeInSamples.reset(currentSampleRate, smoothingTimeSeconds);
+    feedback.reset(currentSampleRate, smoothingTimeSeconds);
+    mix.reset(currentSampleRate, smoothingTimeSeconds);
+
+    reset();
+}
+
+void BatchDelayNode::reset()
+{
+    // Forget the delay line; the part the next reads reach is zeroed as they get there
+    writePosition = 0;
+    writtenHistory = 0;
+
+    for (auto& state : lowPassStates)
+        state.reset();
+}
+
+//==============================================================================
+void BatchDelayNode::setDelayTime(size_t lane, float timeMs)
+{
+    delayTimesMs[lane] = juce::jlimit(0.0f, 2000.0f, timeMs);
+    updateDelayTime(lane);
+}
+
+void BatchDelayNode::setFeedback(size_t lane, float feedbackAmount)
+{
+    feedback.setTargetValue(lane, juce::jlimit(0.0f, 0.95f, feedbackAmount));
+}
+
+void BatchDelayNode::setMix(size_t lane, float mixValue)
+{
+    mix.setTargetValue(lane, juce::jlimit(0.0f, 1.0f, mixValue));
+}
+
+void BatchDelayNode::setLowPassCutoff(size_t lane, float cutoffHz)
+{
+    lowPassCutoffs[lane] = juce::jlimit(200.0f, 20000.0f, cutoffHz);
+    updateLowPassFilter(lane);
+}
+
+void BatchDelayNode::setSmoothingTime(double seconds)
+{
+    smoothingTimeSeconds = seconds;
+    delayTimeInSamples.reset(currentSampleRate, smoothingTimeSeconds);
+    feedback.reset(currentSampleRate, smoothingTimeSeconds);
+    mix.reset(currentSampleRate, smoothingTimeSeconds);
+}
+
+//==============================================================================
+void BatchDelayNode::updateDelayTime(size_t lane)
+{
+    auto samples = (delayTimesMs[lane] / 1000.0f) * static_cast<float>(currentSampleRate);
+    delayTimeInSamples.setTargetValue(lane, juce::jlimit(0.0f, static_cast<float>(maxDelayInSamples), samples));
+}
+
+void BatchDelayNode::updateLowPassFilter(size_t lane)
+{
+    const BiquadDesign design { BiquadDesign::Shape::lowPass, currentSampleRate, static_cast<double>(lowPassCutoffs[lane]) };
+    setLaneCoefficients(lowPassCoefficients, lane, design.makeCoefficients());
+}
+
+void BatchDelayNode::clearStaleHistory(int numSamples, bool delayRamping) noexcept
+{
+    // The shortest and longest delay any lane reads anywhere in the sub-block
+    float shortest = std::numeric_limits<float>::max();
+    float longest = 0.0f;
+
+    auto takeDelays = [&shortest, &longest](BatchLane delays)
+    {
+        for (size_t lane = 0; lane < numBatchLanes; ++lane)
+        {
+            shortest = juce::jmin(shortest, delays.get(lane));
+            longest = juce::jmax(longest, delays.get(lane));
+        }
+    };
+
+    if (delayRamping)
+    {
+        for (int sample = 0; sample < numSamples; ++sample)
+            takeDelays(delayTimeInSamples.getRamp()[sample]);
+    }
+    else
+    {
+        takeDelays(delayTimeInSamples.getCurrentValue());
+    }
+
+    auto clearPositions = [this](int first, int count)
+    {
+        for (size_t channel = 0; channel < lowPassStates.size(); ++channel)
+        {
+            auto* history = delayBuffer.data() + channel * static_cast<size_t>(bufferLength);
+            const int firstRun = juce::jmin(count, bufferLength - first);
+
+            std::fill(history + first, history + first + firstRun, BatchLane::expand(0.0f));
+            std::fill(history, history + (count - firstRun), BatchLane::expand(0.0f));
+        }
+    };
+
+    // Every lane writes in step, so what is stale is the same in every lane; the
+    // lane reading furthest back decides how much of it to clear
+    const int reach = juce::jmin(static_cast<int>(longest) + 1, bufferLength);
+
+    if (reach > writtenHistory)
+    {
+        const int first = (writePosition - reach + bufferLength) % bufferLength;
+        clearPositions(first, reach - writtenHistory);
+        writtenHistory = reach;
+    }
+
+    // A lane with a delay under one sample reads the positions this sub-block
+    // writes as they were a lap ago
+    if (static_cast<int>(shortest) == 0 && writtenHistory < bufferLength)
+        clearPositions(writePosition, juce::jmin(numSamples, bufferLength - writtenHistory));
+}
+
+//==============================================================================
+void BatchDelayNode::process(const juce::dsp::AudioBlock<BatchLane>& block) noexcept
+{
+    const auto numSamples = block.getNumSamples();
+    const auto one = BatchLane::expand(1.0f);
+
+    for (size_t start = 0; start < numSamples; start += static_cast<size_t>(maxSubBlockSize))
+    {
+        const auto subBlockSize = juce::jmin(numSamples - start, static_cast<size_t>(maxSubBlockSize));
+        const int subBlockSamples = static_cast<int>(subBlockSize);
+
+        const bool delayRamping = delayTimeInSamples.advance(subBlockSamples);
+        const bool feedbackRamping = feedback.advance(subBlockSamples);
+        const bool mixRamping = mix.advance(subBlockSamples);
+
+        // Until a whole buffer has been written since reset(), part of it is stale
+        if (writtenHistory < bufferLength)
+            clearStaleHistory(subBlockSamples, delayRamping);
+
+        for (size_t channel = 0; channel < block.getNumChannels(); ++channel)
+        {
+            auto* data = block.getChannelPointer(channel) + start;
+            BatchLane* history = delayBuffer.data() + channel * static_cast<size_t>(bufferLength);
+            auto& lowPass = lowPassStates[channel];
+
+            for (size_t sample = 0; sample < subBlockSize; ++sample)
+            {
+                const BatchLane delaySamples = delayRamping ? delayTimeInSamples.getRamp()[sample] : delayTimeInSamples.getCurrentValue();
+                const BatchLane feedbackAmount = feedbackRamping ? feedback.getRamp()[sample] : feedback.getCurrentValue();
+                const BatchLane mixAmount = mixRamping ? mix.getRamp()[sample] : mix.getCurrentValue();
+
+                int position = writePosition + static_cast<int>(sample);
+
+                if (position >= bufferLength)
+                    position -= bufferLength;
+
+                // Each lane reads its own delay, so the two taps are gathered lane by lane
+                BatchLane delayFrac, newerTap, olderTap;
+
+                for (size_t lane = 0; lane < numBatchLanes; ++lane)
+                {
+                    const float delay = delaySamples.get(lane);
+                    const int delayInt = static_cast<int>(delay);
+                    delayFrac.set(lane, delay - static_cast<float>(delayInt));
+
+                    int index1 = position - delayInt;
+
+                    if (index1 < 0)
+                        index1 += bufferLength;
+
+                    const int index2 = index1 > 0 ? index1 - 1 : bufferLength - 1;
+                    newerTap.set(lane, history[index1].get(lane));
+                    olderTap.set(lane, history[index2].get(lane));
+                }
+
+                const BatchLane input = data[sample];
+                const BatchLane delayedSample = newerTap + delayFrac * (olderTap - newerTap);
+
+                // Filter the feedback and write it back with the input
+                const BatchLane filteredFeedback = lowPass.processSample(delayedSample, lowPassCoefficients.data());
+                history[position] = input + filteredFeedback * feedbackAmount;
+
+                data[sample] = input * (one - mixAmount) + delayedSample * mixAmount;
+            }
+        }
+
+        // Every channel wrote in step, so one position serves them all
+        writePosition = (writePosition + subBlockSamples) % bufferLength;
+        writtenHistory = juce::jmin(writtenHistory + subBlockSamples, bufferLength);
+    }
+}
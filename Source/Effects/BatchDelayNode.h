@@ -0,0 +1,110 @@
+/*
+  ==============================================================================
+
+    BatchDelayNode.h
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <juce_dsp/juce_dsp.h>
+#include <juce_audio_basics/juce_audio_basics.h>
+#include <juce_core/juce_core.h>
+#include <array>
+#include <vector>
+#include "BatchLanes.h"
+#include "BiquadDesigner.h"
+#include "BiquadState.h"
+
+//==============================================================================
+/**
+    The delay for a batch of instances, one per SIMD lane.
+    
+    Every lane does what DelayNode<float> does, with its own delay time,
+    feedback, mix and feedback filter. The two taps of each read are fetched
+    lane by lane, since every lane reads from its own delay; everything else
+    is done once for all lanes. The feedback filter runs in float, where
+    DelayNode runs it in double, and is designed inline as DelayNode does
+    when rendering offline.
+*/
+class BatchDelayNode
+{
+public:
+    //==============================================================================
+    BatchDelayNode();
+    ~BatchDelayNode() = default;
+    
+    //==============================================================================
+    /** Prepares every lane for playback. spec describes a single instance. The
+        delay lines are only reallocated if the sample rate or channel count changed. */
+    void prepare(const juce::dsp::ProcessSpec& spec);
+    
+    /** Resets every lane's internal state. The delay lines are not cleared here
+        but as the reads reach them, as in DelayNode. */
+    void reset();
+    
+    /** Delays every lane of the block in place. */
+    void process(const juce::dsp::AudioBlock<BatchLane>& block) noexcept;
+    
+    //==============================================================================
+    /** Sets one lane's delay time in milliseconds (0-2000ms). */
+    void setDelayTime(size_t lane, float timeMs);
+    
+    /** Sets one lane's feedback amount (0.0-0.95). */
+    void setFeedback(size_t lane, float feedbackAmount);
+    
+    /** Sets one lane's wet/dry mix (0.0 = dry, 1.0 = wet). */
+    void setMix(size_t lane, float mixValue);
+    
+    /** Sets one lane's feedback low-pass cutoff (200-20000Hz). */
+    void setLowPassCutoff(size_t lane, float cutoffHz);
+    
+    /** Sets the ramp length used when a lane's delay time, feedback or mix change. */
+    void setSmoothingTime(double seconds);
+    
+private:
+    //==============================================================================
+    static constexpr double maxDelaySeconds = 2.0;
+    
+    /** Parameter ramps are computed this many samples at a time. */
+    static constexpr int maxSubBlockSize = BatchLaneParameter<>::maxRampLength;
+    
+    // The longest delay at the prepared sample rate, and the history kept per
+    // channel: two more samples than that, as in DelayNode
+    int maxDelayInSamples = 88200;
+    int bufferLength = 88202;
+    
+    // Every channel's history back to back, bufferLength samples of every lane
+    // each, and one feedback filter per channel covering every lane
+    std::vector<BatchLane> delayBuffer;
+    std::vector<BiquadState<BatchLane>> lowPassStates;
+    std::array<BatchLane, 5> lowPassCoefficients {};
+    int writePosition = 0;
+    
+    // As in DelayNode: the last this many samples before writePosition have been
+    // written (or zeroed) since reset(), and anything older is zeroed by
+    // clearStaleHistory() just before some lane can read it
+    int writtenHistory = 0;
+    
+    std::array<float, numBatchLanes> delayTimesMs {};
+    std::array<float, numBatchLanes> lowPassCutoffs {};
+    BatchLaneParameter<> delayTimeInSamples;
+    BatchLaneParameter<> feedback { 0.3f };
+    BatchLaneParameter<> mix { 0.3f };
+    
+    double currentSampleRate = 44100.0;
+    double smoothingTimeSeconds = 0.02;
+    
+    /** Zeroes, on every channel, the stale history the sub-block can read at any
+        lane's delay times. */
+    void clearStaleHistory(int numSamples, bool delayRamping) noexcept;
+    
+    /** Updates one lane's delay time in samples from the current sample rate. */
+    void updateDelayTime(size_t lane);
+    
+    /** Redesigns one lane's feedback filter. */
+    void updateLowPassFilter(size_t lane);
+    
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(BatchDelayNode)
+};
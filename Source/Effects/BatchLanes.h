@@ -0,0 +1,170 @@
+/*
+  ==============================================================================
+
+    BatchLanes.h
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <juce_dsp/juce_dsp.h>
+#include <juce_audio_basics/juce_audio_basics.h>
+#include <juce_core/juce_core.h>
+#include <array>
+#include "BiquadState.h"
+#include "SmoothedParameter.h"
+
+//==============================================================================
+/**
+    One sample of every instance in a batch, one instance per SIMD lane.
+
+    The batch nodes keep all of their state as BatchLane values, so each
+    instruction advances every instance of the batch at once. There are as
+    many lanes as the platform's native float register holds (4 with SSE or
+    NEON, 8 with AVX).
+*/
+using BatchLane = juce::dsp::SIMDRegister<float>;
+
+/** A per-lane comparison result, with every bit set where the comparison held. */
+using BatchLaneMask = BatchLane::vMaskType;
+
+/** How many instances a batch runs side by side. */
+constexpr size_t numBatchLanes = BatchLane::SIMDNumElements;
+
+//==============================================================================
+/** Takes whenSet where mask is set and whenClear everywhere else. */
+inline BatchLane selectLanes(BatchLaneMask mask, BatchLane whenSet, BatchLane whenClear) noexcept
+{
+    return (whenSet & mask) + (whenClear & ~mask);
+}
+
+/** Rounds every lane down to a whole number, as std::floor does. */
+inline BatchLane floorLanes(BatchLane value) noexcept
+{
+    // Truncation rounds negative fractions up, so those lanes come down by one
+    const auto truncated = BatchLane::truncate(value);
+    return truncated - (BatchLane::expand(1.0f) & BatchLane::greaterThan(truncated, value));
+}
+
+/** Builds a mask with the lane set or cleared. */
+inline void setLaneMask(BatchLaneMask& mask, size_t lane, bool isSet) noexcept
+{
+    mask.set(lane, isSet ? ~static_cast<BatchLaneMask::ElementType>(0) : static_cast<BatchLaneMask::ElementType>(0));
+}
+
+/** Writes one lane of a biquad's coefficients, in BiquadState order, from the
+    six values the IIR::ArrayCoefficients designers return. The design stays in
+    double and is normalised the way IIR::Coefficients does before rounding. */
+inline void setLaneCoefficients(std::array<BatchLane, 5>& coefficients, size_t lane, const std::array<double, 6>& design) noexcept
+{
+    const double a0Inverse = design[3] != 0.0 ? 1.0 / design[3] : 0.0;
+    
+    coefficients[0].set(lane, static_cast<float>(design[0] * a0Inverse));
+    coefficients[1].set(lane, static_cast<float>(design[1] * a0Inverse));
+    coefficients[2].set(lane, static_cast<float>(design[2] * a0Inverse));
+    coefficients[3].set(lane, static_cast<float>(design[4] * a0Inverse));
+    coefficients[4].set(lane, static_cast<float>(design[5] * a0Inverse));
+}
+
+/** Writes one lane of a biquad's coefficients from a set already normalised in double. */
+inline void setLaneCoefficients(std::array<BatchLane, 5>& coefficients, size_t lane, const BiquadCoefficients<double>& design) noexcept
+{
+    for (size_t index = 0; index < coefficients.size(); ++index)
+        coefficients[index].set(lane, static_cast<float>(design.values[index]));
+}
+
+//==============================================================================
+/**
+    A SmoothedParameter per lane, handing out ramps one BatchLane per sample.
+
+    Each lane ramps towards its own target on its own schedule, exactly as a
+    single instance's SmoothedParameter would. advance() returns false while
+    no lane is moving, and getCurrentValue() then holds every lane's value.
+*/
+template<typename SmoothingType = juce::ValueSmoothingTypes::Linear>
+class BatchLaneParameter
+{
+public:
+    //==============================================================================
+    /** The longest sub-block a single call to advance() may cover. */
+    static constexpr int maxRampLength = SmoothedParameter<float>::maxRampLength;
+    
+    //==============================================================================
+    explicit BatchLaneParameter(float initialValue = 0.0f)
+    {
+        for (size_t lane = 0; lane < numBatchLanes; ++lane)
+            smoothers[lane].setCurrentAndTargetValue(initialValue);
+        
+        current = BatchLane::expand(initialValue);
+    }
+    
+    /** Sets every lane's ramp length and snaps each to its target. */
+    void reset(double sampleRate, double rampLengthSeconds) noexcept
+    {
+        for (auto& smoother : smoothers)
+            smoother.reset(sampleRate, rampLengthSeconds);
+        
+        updateCurrent();
+    }
+    
+    /** Starts a ramp towards a new value in one lane. With no ramp length set,
+        the lane jumps straight there. */
+    void setTargetValue(size_t lane, float newValue) noexcept
+    {
+        smoothers[lane].setTargetValue(newValue);
+        
+        if (! smoothers[lane].isSmoothing())
+            current.set(lane, smoothers[lane].getCurrentValue());
+    }
+    
+    /** Jumps straight to a new value in one lane. */
+    void setCurrentAndTargetValue(size_t lane, float newValue) noexcept
+    {
+        smoothers[lane].setCurrentAndTargetValue(newValue);
+        current.set(lane, newValue);
+    }
+    
+    float getTargetValue(size_t lane) const noexcept { return smoothers[lane].getTargetValue(); }
+    
+    /** Every lane's value at the end of the last sub-block. */
+    BatchLane getCurrentValue() const noexcept { return current; }
+    
+    //==============================================================================
+    /** Advances every lane by numSamples (at most maxRampLength). Returns true
+        and fills getRamp() if any lane moved during the sub-block. */
+    bool advance(int numSamples) noexcept
+    {
+        jassert(numSamples <= maxRampLength);
+        
+        bool anySmoothing = false;
+        
+        for (const auto& smoother : smoothers)
+            anySmoothing = anySmoothing || smoother.isSmoothing();
+        
+        if (! anySmoothing)
+            return false;
+        
+        for (size_t lane = 0; lane < numBatchLanes; ++lane)
+            for (int sample = 0; sample < numSamples; ++sample)
+                ramp[static_cast<size_t>(sample)].set(lane, smoothers[lane].getNextValue());
+        
+        updateCurrent();
+        return true;
+    }
+    
+    /** The per-sample values written by the last advance() that returned true. */
+    const BatchLane* getRamp() const noexcept { return ramp.data(); }
+    
+private:
+    //==============================================================================
+    std::array<juce::SmoothedValue<float, SmoothingType>, numBatchLanes> smoothers;
+    std::array<BatchLane, maxRampLength> ramp {};
+    BatchLane current {};
+    
+    void updateCurrent() noexcept
+    {
+        for (size_t lane = 0; lane < numBatchLanes; ++lane)
+            current.set(lane, smoothers[lane].getCurrentValue());
+    }
+};
@@ -0,0 +1,249 @@
+/*
+  ==============================================================================
+
+    BatchParametricEQNode.cpp
+
+  ==============================================================================
+*/
+
+#include "BatchParametricEQNode.h"
+#include <algorithm>
+
+//==============================================================================
+void BatchParametricEQNode::prepare(const juce::dsp::ProcessSpec& spec)
+{
+    currentSampleRate = spec.sampleRate;
+    numChannels = static_cast<size_t>(spec.numChannels);
+    states.resize(numChannels * static_cast<size_t>(maxSections));
+
+    // Start every lane on its current settings with no ramp, designed for the new sample rate
+    for (size_t lane = 0; lane < numBatchLanes; ++lane)
+        for (int band = 0; band < maxBands; ++band)
+            for (int index = 0; index < maxSectionsPerBand; ++index)
+                snapSection(sections[static_cast<size_t>(band * maxSectionsPerBand + index)], lane,
+                            Designs::getSectionDesign(bandSettings[lane][static_cast<size_t>(band)], index, currentSampleRate));
+
+    reset();
+}
+
+void BatchParametricEQNode::reset()
+{
+    for (auto& state : states)
+        state.reset();
+
+    // Flat lanes have nothing left to settle
+    for (auto& section : sections)
+        for (size_t lane = 0; lane < numBatchLanes; ++lane)
+            if (section.lanes[lane].rampRemaining == 0 && Designs::isUnity(section.lanes[lane].current))
+                bypassLane(section, lane);
+
+    updateActiveSections();
+}
+
+//==============================================================================
+void BatchParametricEQNode::setBandType(size_t lane, int band, BandType newType)
+{
+    jassert(juce::isPositiveAndBelow(band, maxBands));
+    bandSettings[lane][static_cast<size_t>(band)].type = newType;
+    updateBand(lane, band);
+}
+
+void BatchParametricEQNode::setBandFrequency(size_t lane, int band, float freqHz)
+{
+    jassert(juce::isPositiveAndBelow(band, maxBands));
+    bandSettings[lane][static_cast<size_t>(band)].frequency = juce::jlimit(20.0f, 20000.0f, freqHz);
+    updateBand(lane, band);
+}
+
+void BatchParametricEQNode::setBandGain(size_t lane, int band, float gainDb)
+{
+    jassert(juce::isPositiveAndBelow(band, maxBands));
+    bandSettings[lane][static_cast<size_t>(band)].gain = juce::jlimit(-24.0f, 24.0f, gainDb);
+    updateBand(lane, band);
+}
+
+void BatchParametricEQNode::setBandQ(size_t lane, int band, float qValue)
+{
+    jassert(juce::isPositiveAndBelow(band, maxBands));
+    bandSettings[lane][static_cast<size_t>(band)].q = juce::jlimit(0.1f, 10.0f, qValue);
+    updateBand(lane, band);
+}
+
+void BatchParametricEQNode::setBandSlope(size_t lane, int band, CutSlope newSlope)
+{
+    jassert(juce::isPositiveAndBelow(band, maxBands));
+    bandSettings[lane][static_cast<size_t>(band)].slope = newSlope;
+    updateBand(lane, band);
+}
+
+void BatchParametricEQNode::setSmoothingTime(double seconds)
+{
+    smoothingTimeSeconds = seconds;
+}
+
+//==============================================================================
+void BatchParametricEQNode::updateBand(size_t lane, int band)
+{
+    const auto& settings = bandSettings[lane][static_cast<size_t>(band)];
+
+    for (int index = 0; index < maxSectionsPerBand; ++index)
+        updateSection(sections[static_cast<size_t>(band * maxSectionsPerBand + index)], lane,
+                      Designs::getSectionDesign(settings, index, currentSampleRate));
+}
+
+void BatchParametricEQNode::updateSection(Section& section, size_t lane, const BiquadDesign& design)
+{
+    auto& laneSection = section.lanes[lane];
+
+    // Lanes already on their way to flat stay as they are, so unused sections cost nothing
+    const bool flat = Designs::isFlat(design);
+
+    if (flat && laneSection.requestedFlat)
+        return;
+
+    laneSection.requestedFlat = flat;
+    startRamp(section, lane, design.makeCoefficients());
+}
+
+void BatchParametricEQNode::snapSection(Section& section, size_t lane, const BiquadDesign& design)
+{
+    auto& laneSection = section.lanes[lane];
+
+    laneSection.requestedFlat = Designs::isFlat(design);
+    laneSection.current = design.makeCoefficients();
+    laneSection.rampRemaining = 0;
+    setLaneCoefficients(section.coefficients, lane, laneSection.current);
+    includeLane(section, lane);
+    beginSettling(laneSection);
+}
+
+void BatchParametricEQNode::startRamp(Section& section, size_t lane, const BiquadCoefficients<double>& target) noexcept
+{
+    auto& laneSection = section.lanes[lane];
+
+    laneSection.rampStart = laneSection.current;
+    laneSection.rampTarget = target;
+    laneSection.rampLength = juce::roundToInt(smoothingTimeSeconds * currentSampleRate);
+    laneSection.rampRemaining = laneSection.rampLength;
+    laneSection.settleRemaining = 0;
+    includeLane(section, lane);
+
+    if (laneSection.rampLength <= 0)
+    {
+        laneSection.current = target;
+        setLaneCoefficients(section.coefficients, lane, laneSection.current);
+        beginSettling(laneSection);
+    }
+}
+
+void BatchParametricEQNode::advanceSection(Section& section, size_t lane, int numSamples) noexcept
+{
+    auto& laneSection = section.lanes[lane];
+
+    if (laneSection.rampRemaining > 0)
+    {
+        laneSection.rampRemaining = juce::jmax(0, laneSection.rampRemaining - numSamples);
+        const double position = 1.0 - static_cast<double>(laneSection.rampRemaining) / static_cast<double>(laneSection.rampLength);
+
+        for (size_t index = 0; index < laneSection.current.values.size(); ++index)
+            laneSection.current.values[index] = laneSection.rampStart.values[index]
+                                                + position * (laneSection.rampTarget.values[index] - laneSection.rampStart.values[index]);
+
+        // Land exactly on the design, so a flat one is recognised as flat
+        if (laneSection.rampRemaining == 0)
+        {
+            laneSection.current = laneSection.rampTarget;
+            beginSettling(laneSection);
+        }
+
+        setLaneCoefficients(section.coefficients, lane, laneSection.current);
+    }
+    else if (laneSection.settleRemaining > 0)
+    {
+        laneSection.settleRemaining -= numSamples;
+
+        if (laneSection.settleRemaining <= 0)
+            bypassLane(section, lane);
+    }
+}
+
+void BatchParametricEQNode::beginSettling(LaneSection& laneSection) noexcept
+{
+    laneSection.settleRemaining = Designs::isUnity(laneSection.current) ? Designs::getSettleSamples(laneSection.current) : 0;
+}
+
+void BatchParametricEQNode::bypassLane(Section& section, size_t lane) noexcept
+{
+    const auto index = static_cast<size_t>(&section - sections.data());
+
+    for (size_t channel = 0; channel < numChannels; ++channel)
+    {
+        auto& state = states[channel * static_cast<size_t>(maxSections) + index];
+        state.s1.set(lane, 0.0f);
+        state.s2.set(lane, 0.0f);
+    }
+
+    auto& laneSection = section.lanes[lane];
+    laneSection.settleRemaining = 0;
+    activeSectionsChanged = activeSectionsChanged || ! laneSection.bypassed;
+    laneSection.bypassed = true;
+}
+
+void BatchParametricEQNode::includeLane(Section& section, size_t lane) noexcept
+{
+    auto& laneSection = section.lanes[lane];
+    activeSectionsChanged = activeSectionsChanged || laneSection.bypassed;
+    laneSection.bypassed = false;
+}
+
+void BatchParametricEQNode::updateActiveSections() noexcept
+{
+    numActiveSections = 0;
+
+    for (size_t index = 0; index < sections.size(); ++index)
+    {
+        const auto& lanes = sections[index].lanes;
+
+        if (std::any_of(lanes.begin(), lanes.end(), [](const LaneSection& laneSection) { return ! laneSection.bypassed; }))
+            activeSections[numActiveSections++] = static_cast<int>(index);
+    }
+
+    activeSectionsChanged = false;
+}
+
+//==============================================================================
+void BatchParametricEQNode::process(const juce::dsp::AudioBlock<BatchLane>& block) noexcept
+{
+    const auto numSamples = block.getNumSamples();
+
+    for (size_t start = 0; start < numSamples; start += coefficientUpdateInterval)
+    {
+        const auto subBlockSize = juce::jmin(numSamples - start, static_cast<size_t>(coefficientUpdateInterval));
+
+        for (auto& section : sections)
+            for (size_t lane = 0; lane < numBatchLanes; ++lane)
+                advanceSection(section, lane, static_cast<int>(subBlockSize));
+
+        if (activeSectionsChanged)
+            updateActiveSections();
+
+        for (size_t channel = 0; channel < block.getNumChannels(); ++channel)
+        {
+            auto* data = block.getChannelPointer(channel) + start;
+            auto* channelStates = states.data() + channel * static_cast<size_t>(maxSections);
+
+            for (size_t sample = 0; sample < subBlockSize; ++sample)
+            {
+                BatchLane value = data[sample];
+
+                for (size_t index = 0; index < numActiveSections; ++index)
+                {
+                    const auto section = static_cast<size_t>(activeSections[index]);
+                    value = channelStates[section].processSample(value, sections[section].coefficients.data());
+                }
+
+                data[sample] = value;
+            }
+        }
+    }
+}
@@ -0,0 +1,144 @@
+/*
+  ==============================================================================
+
+    BatchParametricEQNode.h
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <juce_dsp/juce_dsp.h>
+#include <juce_audio_basics/juce_audio_basics.h>
+#include <juce_core/juce_core.h>
+#include <array>
+#include <vector>
+#include "BatchLanes.h"
+#include "BiquadState.h"
+#include "ParametricEQNode.h"
+
+//==============================================================================
+/**
+    The parametric EQ for a batch of instances, one per SIMD lane.
+    
+    Every lane has its own bands and does what ParametricEQNode<float> with the
+    biquad topology does when it designs on the calling thread: the sections
+    are designed in double by the same helpers, ramped in the coefficient
+    domain over the same sub-blocks, and dropped once they have settled flat.
+    A section runs while any lane needs it; lanes it has dropped out of hold
+    unity coefficients and no state, so they pass through unchanged.
+    
+    The filters run in float, where the engine's ParametricEQNode<double> keeps
+    double state, so very low shelves at high sample rates are slightly noisier.
+    The state-variable and linear-phase topologies are single-instance only.
+*/
+class BatchParametricEQNode
+{
+public:
+    //==============================================================================
+    using BandType = ParametricEQNode<float>::BandType;
+    using CutSlope = ParametricEQNode<float>::CutSlope;
+    
+    static constexpr int maxBands = ParametricEQNode<float>::maxBands;
+    static constexpr int maxSectionsPerBand = ParametricEQNode<float>::maxSectionsPerBand;
+    static constexpr int maxSections = ParametricEQNode<float>::maxSections;
+    
+    //==============================================================================
+    BatchParametricEQNode() = default;
+    ~BatchParametricEQNode() = default;
+    
+    //==============================================================================
+    /** Prepares every lane for playback. spec describes a single instance. */
+    void prepare(const juce::dsp::ProcessSpec& spec);
+    
+    /** Resets every lane's internal state. */
+    void reset();
+    
+    /** Filters every lane of the block in place. */
+    void process(const juce::dsp::AudioBlock<BatchLane>& block) noexcept;
+    
+    //==============================================================================
+    /** Set one lane's band settings, over the same ranges as ParametricEQNode.
+        Bands start out off. */
+    void setBandType(size_t lane, int band, BandType newType);
+    void setBandFrequency(size_t lane, int band, float freqHz);
+    void setBandGain(size_t lane, int band, float gainDb);
+    void setBandQ(size_t lane, int band, float qValue);
+    void setBandSlope(size_t lane, int band, CutSlope newSlope);
+    
+    /** Sets the ramp length used when any lane's band setting changes. Only
+        ramps started from now on take the new length. */
+    void setSmoothingTime(double seconds);
+    
+private:
+    //==============================================================================
+    /** Coefficients are stepped along their ramp this often (in samples), as in ParametricEQNode. */
+    static constexpr int coefficientUpdateInterval = ParametricEQNode<float>::coefficientUpdateInterval;
+    
+    using Designs = ParametricEQNode<float>;
+    using BandSettings = Designs::BandSettings;
+    
+    // One lane of a section: the same ramp and settling as a ParametricEQNode section
+    struct LaneSection
+    {
+        BiquadCoefficients<double> current;
+        BiquadCoefficients<double> rampStart;
+        BiquadCoefficients<double> rampTarget;
+        int rampRemaining = 0;
+        int rampLength = 0;
+        int settleRemaining = 0;
+        bool bypassed = true;
+        bool requestedFlat = true;
+    };
+    
+    // A section of every lane, with each lane's coefficients rounded to float
+    struct Section
+    {
+        std::array<LaneSection, numBatchLanes> lanes;
+        std::array<BatchLane, 5> coefficients { { BatchLane::expand(1.0f), {}, {}, {}, {} } };
+    };
+    
+    std::array<std::array<BandSettings, maxBands>, numBatchLanes> bandSettings;
+    std::array<Section, maxSections> sections;
+    
+    // The sections some lane needs, in cascade order, rebuilt whenever that changes
+    std::array<int, maxSections> activeSections {};
+    size_t numActiveSections = 0;
+    bool activeSectionsChanged = true;
+    
+    // Each channel's section states, channel by channel, maxSections apiece
+    std::vector<BiquadState<BatchLane>> states;
+    size_t numChannels = 0;
+    
+    double currentSampleRate = 44100.0;
+    double smoothingTimeSeconds = 0.02;
+    
+    /** Redesigns every section of one lane's band, ramping to the result. */
+    void updateBand(size_t lane, int band);
+    
+    /** Ramps one lane of a section to new settings, unless it is flat and already heading there. */
+    void updateSection(Section& section, size_t lane, const BiquadDesign& design);
+    
+    /** Jumps one lane of a section straight to new settings. */
+    void snapSection(Section& section, size_t lane, const BiquadDesign& design);
+    
+    /** Starts one lane's ramp to target, or jumps there if there is no ramp time. */
+    void startRamp(Section& section, size_t lane, const BiquadCoefficients<double>& target) noexcept;
+    
+    /** Moves one lane's ramp or settling on by numSamples. */
+    void advanceSection(Section& section, size_t lane, int numSamples) noexcept;
+    
+    /** Starts counting down to dropping the lane if its coefficients are at unity. */
+    static void beginSettling(LaneSection& laneSection) noexcept;
+    
+    /** Clears the lane's state on every channel and drops it from the section. */
+    void bypassLane(Section& section, size_t lane) noexcept;
+    
+    /** Puts the lane back in the section if it had dropped out. */
+    void includeLane(Section& section, size_t lane) noexcept;
+    
+    /** Rebuilds the list of sections some lane needs. */
+    void updateActiveSections() noexcept;
+    
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(BatchParametricEQNode)
+};
@@ -0,0 +1,303 @@
+/*
+  ==============================================================================
+
+    BatchReverbNode.cpp
+
+  ==============================================================================
+*/
+
+#include "BatchReverbNode.h"
+
+//==============================================================================
+BatchReverbNode::BatchReverbNode()
+{
+    // Every lane starts at the same defaults as ReverbNode
+    for (size_t lane = 0; lane < numBatchLanes; ++lane)
+    {
+        auto& params = laneParams[lane];
+        params.roomSize = 0.5f;
+        params.damping = 0.5f;
+        params.wetLevel = 0.33f;
+        params.dryLevel = 0.4f;
+        params.width = 1.0f;
+        params.freezeMode = 0.0f;
+
+        updateInternalReverb(lane);
+    }
+}
+
+//==============================================================================
+void BatchReverbNode::prepare(const juce::dsp::ProcessSpec& spec)
+{
+    using Tunings = ReverbNode<float>;
+
+    currentSampleRate = spec.sampleRate;
+    numChannels = static_cast<size_t>(spec.numChannels);
+
+    const double tuningScale = currentSampleRate / 44100.0;
+    auto scaledLength = [tuningScale](int tuning) { return juce::jmax(1, juce::roundToInt(tuning * tuningScale)); };
+
+    combStarts.resize(numChannels * numCombs);
+    combLengths.resize(numChannels * numCombs);
+    allPassStarts.resize(numChannels * numAllPasses);
+    allPassLengths.resize(numChannels * numAllPasses);
+
+    size_t combTotal = 0;
+    size_t allPassTotal = 0;
+
+    for (size_t channel = 0; channel < numChannels; ++channel)
+    {
+        const int spread = Tunings::channelSpread * static_cast<int>(channel);
+
+        for (size_t comb = 0; comb < numCombs; ++comb)
+        {
+            const auto line = channel * numCombs + comb;
+            combStarts[line] = combTotal;
+            combLengths[line] = scaledLength(Tunings::combTunings[comb] + spread);
+            combTotal += static_cast<size_t>(combLengths[line]);
+        }
+
+        for (size_t allPass = 0; allPass < numAllPasses; ++allPass)
+        {
+            const auto line = channel * numAllPasses + allPass;
+            allPassStarts[line] = allPassTotal;
+            allPassLengths[line] = scaledLength(Tunings::allPassTunings[allPass] + spread);
+            allPassTotal += static_cast<size_t>(allPassLengths[line]);
+        }
+    }
+
+    longestCombSamples = *std::max_element(combLengths.begin(), combLengths.end());
+
+    combBuffer.resize(combTotal);
+    combPositions.resize(numChannels * numCombs);
+    combFilterStates.resize(numChannels * numCombs);
+    allPassBuffer.resize(allPassTotal);
+    allPassPositions.resize(numChannels * numAllPasses);
+    samplesSinceReset.resize(numChannels);
+
+    inputScratch.resize(static_cast<size_t>(maxSubBlockSize));
+    wetScratch.resize(numChannels * static_cast<size_t>(maxSubBlockSize));
+    wetSumScratch.resize(static_cast<size_t>(maxSubBlockSize));
+
+    // Same ramp times as ReverbNode
+    constexpr double smoothTime = 0.01;
+    damping.reset(currentSampleRate, smoothTime);
+    feedback.reset(currentSampleRate, smoothTime);
+    dryGain.reset(currentSampleRate, smoothTime);
+    wetGain1.reset(currentSampleRate, smoothTime);
+    wetGain2.reset(currentSampleRate, smoothTime);
+
+    reset();
+
+    for (size_t lane = 0; lane < numBatchLanes; ++lane)
+        updateInternalReverb(lane);
+}
+
+void BatchReverbNode::reset()
+{
+    // The lines' contents are left alone: processChannel() zeroes them on the first lap
+    std::fill(combPositions.begin(), combPositions.end(), 0);
+    std::fill(combFilterStates.begin(), combFilterStates.end(), BatchLane::expand(0.0f));
+    std::fill(allPassPositions.begin(), allPassPositions.end(), 0);
+    std::fill(samplesSinceReset.begin(), samplesSinceReset.end(), 0);
+}
+
+//==============================================================================
+void BatchReverbNode::setRoomSize(size_t lane, float roomSize)
+{
+    laneParams[lane].roomSize = juce::jlimit(0.0f, 1.0f, roomSize);
+    updateInternalReverb(lane);
+}
+
+void BatchReverbNode::setDamping(size_t lane, float newDamping)
+{
+    laneParams[lane].damping = juce::jlimit(0.0f, 1.0f, newDamping);
+    updateInternalReverb(lane);
+}
+
+void BatchReverbNode::setWidth(size_t lane, float width)
+{
+    laneParams[lane].width = juce::jlimit(0.0f, 1.0f, width);
+    updateInternalReverb(lane);
+}
+
+void BatchReverbNode::setFreezeMode(size_t lane, float freezeMode)
+{
+    laneParams[lane].freezeMode = freezeMode;
+    updateInternalReverb(lane);
+}
+
+void BatchReverbNode::setMix(size_t lane, float mix)
+{
+    mix = juce::jlimit(0.0f, 1.0f, mix);
+    laneParams[lane].wetLevel = mix;
+    laneParams[lane].dryLevel = 1.0f - mix;
+    updateInternalReverb(lane);
+}
+
+//==============================================================================
+void BatchReverbNode::process(const juce::dsp::AudioBlock<BatchLane>& block) noexcept
+{
+    const auto channelsToProcess = juce::jmin(block.getNumChannels(), numChannels);
+    const auto numSamples = block.getNumSamples();
+
+    if (channelsToProcess == 0)
+        return;
+
+    // Every channel is fed the same mono sum, scaled as in ReverbNode
+    const BatchLane inputScale = inputGains * juce::jmin(1.0f, 2.0f / static_cast<float>(channelsToProcess));
+    const auto othersScale = BatchLane::expand(channelsToProcess > 1 ? 1.0f / static_cast<float>(channelsToProcess - 1) : 0.0f);
+
+    for (size_t start = 0; start < numSamples; start += maxSubBlockSize)
+    {
+        const auto subBlockSize = juce::jmin(numSamples - start, static_cast<size_t>(maxSubBlockSize));
+        const int subBlockSamples = static_cast<int>(subBlockSize);
+
+        const bool dampingRamping = damping.advance(subBlockSamples);
+        const bool feedbackRamping = feedback.advance(subBlockSamples);
+        const bool dryRamping = dryGain.advance(subBlockSamples);
+        const bool wet1Ramping = wetGain1.advance(subBlockSamples);
+        const bool wet2Ramping = wetGain2.advance(subBlockSamples);
+
+        // Mix every channel down to the shared input
+        std::fill(inputScratch.begin(), inputScratch.begin() + subBlockSamples, BatchLane::expand(0.0f));
+
+        for (size_t channel = 0; channel < channelsToProcess; ++channel)
+        {
+            const auto* data = block.getChannelPointer(channel) + start;
+
+            for (size_t sample = 0; sample < subBlockSize; ++sample)
+                inputScratch[sample] += data[sample];
+        }
+
+        for (size_t sample = 0; sample < subBlockSize; ++sample)
+            inputScratch[sample] *= inputScale;
+
+        // Run each channel's network, one line at a time over the whole sub-block
+        std::fill(wetSumScratch.begin(), wetSumScratch.begin() + subBlockSamples, BatchLane::expand(0.0f));
+
+        for (size_t channel = 0; channel < channelsToProcess; ++channel)
+        {
+            processChannel(channel, subBlockSamples, dampingRamping, feedbackRamping);
+
+            const auto* wet = wetScratch.data() + channel * maxSubBlockSize;
+
+            for (size_t sample = 0; sample < subBlockSize; ++sample)
+                wetSumScratch[sample] += wet[sample];
+        }
+
+        // Blend each channel's own network with the others and the dry signal
+        for (size_t channel = 0; channel < channelsToProcess; ++channel)
+        {
+            auto* data = block.getChannelPointer(channel) + start;
+            const auto* wet = wetScratch.data() + channel * maxSubBlockSize;
+
+            for (size_t sample = 0; sample < subBlockSize; ++sample)
+            {
+                const BatchLane dry = dryRamping ? dryGain.getRamp()[sample] : dryGain.getCurrentValue();
+                const BatchLane wet1 = wet1Ramping ? wetGain1.getRamp()[sample] : wetGain1.getCurrentValue();
+                const BatchLane wet2 = wet2Ramping ? wetGain2.getRamp()[sample] : wetGain2.getCurrentValue();
+                const BatchLane others = (wetSumScratch[sample] - wet[sample]) * othersScale;
+
+                data[sample] = wet[sample] * wet1 + others * wet2 + data[sample] * dry;
+            }
+        }
+    }
+}
+
+void BatchReverbNode::processChannel(size_t channel, int numSamples, bool dampingRamping, bool feedbackRamping) noexcept
+{
+    const auto one = BatchLane::expand(1.0f);
+    const auto half = BatchLane::expand(0.5f);
+
+    auto* wet = wetScratch.data() + channel * maxSubBlockSize;
+    std::fill(wet, wet + numSamples, BatchLane::expand(0.0f));
+
+    const int lapSamples = samplesSinceReset[channel];
+
+    // Every line reads each position just before overwriting it, so on the first
+    // lap after reset() the positions this sub-block reaches are zeroed up front
+    auto clearFirstLap = [lapSamples, numSamples](BatchLane* buffer, int length)
+    {
+        if (lapSamples < length)
+            std::fill(buffer + lapSamples, buffer + juce::jmin(lapSamples + numSamples, length), BatchLane::expand(0.0f));
+    };
+
+    // Parallel damped combs, summed
+    for (size_t comb = 0; comb < numCombs; ++comb)
+    {
+        const auto line = channel * numCombs + comb;
+        auto* buffer = combBuffer.data() + combStarts[line];
+        const int length = combLengths[line];
+        int position = combPositions[line];
+        BatchLane filterState = combFilterStates[line];
+
+        clearFirstLap(buffer, length);
+
+        for (int sample = 0; sample < numSamples; ++sample)
+        {
+            const BatchLane damp = dampingRamping ? damping.getRamp()[sample] : damping.getCurrentValue();
+            const BatchLane gain = feedbackRamping ? feedback.getRamp()[sample] : feedback.getCurrentValue();
+
+            const BatchLane output = buffer[position];
+            filterState = output * (one - damp) + filterState * damp;
+            buffer[position] = inputScratch[static_cast<size_t>(sample)] + filterState * gain;
+
+            if (++position >= length)
+                position = 0;
+
+            wet[sample] += output;
+        }
+
+        combPositions[line] = position;
+        combFilterStates[line] = filterState;
+    }
+
+    // Series allpasses
+    for (size_t allPass = 0; allPass < numAllPasses; ++allPass)
+    {
+        const auto line = channel * numAllPasses + allPass;
+        auto* buffer = allPassBuffer.data() + allPassStarts[line];
+        const int length = allPassLengths[line];
+        int position = allPassPositions[line];
+
+        clearFirstLap(buffer, length);
+
+        for (int sample = 0; sample < numSamples; ++sample)
+        {
+            const BatchLane bufferedValue = buffer[position];
+            buffer[position] = wet[sample] + bufferedValue * half;
+
+            if (++position >= length)
+                position = 0;
+
+            wet[sample] = bufferedValue - wet[sample];
+        }
+
+        allPassPositions[line] = position;
+    }
+
+    // The combs are the longest lines, so once past them every line has lapped
+    if (lapSamples < longestCombSamples)
+        samplesSinceReset[channel] = lapSamples + numSamples;
+}
+
+//==============================================================================
+void BatchReverbNode::updateInternalReverb(size_t lane)
+{
+    // Same gain structure as ReverbNode
+    constexpr float wetScaleFactor = 3.0f;
+    constexpr float dryScaleFactor = 2.0f;
+    const auto& params = laneParams[lane];
+    const float wet = params.wetLevel * wetScaleFactor;
+
+    dryGain.setTargetValue(lane, params.dryLevel * dryScaleFactor);
+    wetGain1.setTargetValue(lane, 0.5f * wet * (1.0f + params.width));
+    wetGain2.setTargetValue(lane, 0.5f * wet * (1.0f - params.width));
+
+    // Freezing stops new input and lets the combs recirculate undamped
+    const bool frozen = params.freezeMode >= 0.5f;
+    inputGains.set(lane, frozen ? 0.0f : 0.015f);
+    damping.setTargetValue(lane, frozen ? 0.0f : params.damping * 0.4f);
+    feedback.setTargetValue(lane, frozen ? 1.0f : params.roomSize * 0.28f + 0.7f);
+}
@@ -0,0 +1,101 @@
+/*
+  ==============================================================================
+
+    BatchReverbNode.h
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <juce_dsp/juce_dsp.h>
+#include <juce_audio_basics/juce_audio_basics.h>
+#include <juce_core/juce_core.h>
+#include <array>
+#include <vector>
+#include "BatchLanes.h"
+#include "ReverbNode.h"
+
+//==============================================================================
+/**
+    The reverb for a batch of instances, one per SIMD lane.
+    
+    The delay lines are laid out exactly as ReverbNode lays them out - their
+    lengths depend only on the sample rate and the channel - so every lane of
+    a line moves in step and each comb and allpass advances the whole batch at
+    once. Room size, damping, width, freeze and mix are set per lane.
+*/
+class BatchReverbNode
+{
+public:
+    //==============================================================================
+    BatchReverbNode();
+    ~BatchReverbNode() = default;
+    
+    //==============================================================================
+    /** Prepares every lane for playback. spec describes a single instance. */
+    void prepare(const juce::dsp::ProcessSpec& spec);
+    
+    /** Resets every lane's internal state. The lines are cleared during their
+        first lap rather than here, as in ReverbNode. */
+    void reset();
+    
+    /** Reverberates every lane of the block in place. */
+    void process(const juce::dsp::AudioBlock<BatchLane>& block) noexcept;
+    
+    //==============================================================================
+    /** Set one lane's reverb settings, over the same ranges as ReverbNode. */
+    void setRoomSize(size_t lane, float roomSize);
+    void setDamping(size_t lane, float damping);
+    void setWidth(size_t lane, float width);
+    void setFreezeMode(size_t lane, float freezeMode);
+    void setMix(size_t lane, float mix);
+    
+private:
+    //==============================================================================
+    static constexpr int numCombs = ReverbNode<float>::numCombs;
+    static constexpr int numAllPasses = ReverbNode<float>::numAllPasses;
+    
+    /** Parameter ramps are computed this many samples at a time. */
+    static constexpr int maxSubBlockSize = BatchLaneParameter<>::maxRampLength;
+    
+    // The same layout as ReverbNode, with every sample holding all lanes
+    std::vector<BatchLane> combBuffer;
+    std::vector<size_t> combStarts;
+    std::vector<int> combLengths;
+    std::vector<int> combPositions;
+    std::vector<BatchLane> combFilterStates;
+    
+    std::vector<BatchLane> allPassBuffer;
+    std::vector<size_t> allPassStarts;
+    std::vector<int> allPassLengths;
+    std::vector<int> allPassPositions;
+    
+    // Every line starts over from position 0 on reset(), so for the first lap each
+    // of a channel's lines is at samplesSinceReset, and whatever lies ahead is stale
+    std::vector<int> samplesSinceReset;
+    int longestCombSamples = 0;
+    
+    std::vector<BatchLane> inputScratch;
+    std::vector<BatchLane> wetScratch;
+    std::vector<BatchLane> wetSumScratch;
+    
+    size_t numChannels = 0;
+    
+    std::array<juce::Reverb::Parameters, numBatchLanes> laneParams;
+    BatchLaneParameter<> damping;
+    BatchLaneParameter<> feedback;
+    BatchLaneParameter<> dryGain;
+    BatchLaneParameter<> wetGain1;
+    BatchLaneParameter<> wetGain2;
+    BatchLane inputGains = BatchLane::expand(0.015f);
+    double currentSampleRate = 44100.0;
+    
+    /** Runs one channel's network over the sub-block in inputScratch. */
+    void processChannel(size_t channel, int numSamples, bool dampingRamping, bool feedbackRamping) noexcept;
+    
+    /** Updates one lane's gains and filter targets from its parameters. */
+    void updateInternalReverb(size_t lane);
+    
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(BatchReverbNode)
+};
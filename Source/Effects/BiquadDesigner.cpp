@@ -0,0 +1,266 @@
+/*
+  ==============================================================================
+
+    BiquadDesigner.cpp
+
+  ==============================================================================
+*/
+
+#include "BiquadDesigner.h"
+
+//==============================================================================
+BiquadCoefficients<double> BiquadDesign::makeCoefficients() const noexcept
+{
+    using Designs = juce::dsp::IIR::ArrayCoefficients<double>;
+
+    BiquadCoefficients<double> coefficients;
+
+    switch (shape)
+    {
+        case Shape::lowShelf:
+            coefficients = Designs::makeLowShelf(sampleRate, frequency, q, gain);
+            break;
+        case Shape::peak:
+            coefficients = Designs::makePeakFilter(sampleRate, frequency, q, gain);
+            break;
+        case Shape::highShelf:
+            coefficients = Designs::makeHighShelf(sampleRate, frequency, q, gain);
+            break;
+        case Shape::lowPassSection:
+            coefficients = Designs::makeLowPass(sampleRate, frequency, q);
+            break;
+        case Shape::highPassSection:
+            coefficients = Designs::makeHighPass(sampleRate, frequency, q);
+            break;
+        case Shape::lowPass:
+        default:
+            coefficients = Designs::makeLowPass(sampleRate, frequency);
+            break;
+    }
+
+    return coefficients;
+}
+
+SvfCoefficients<double> BiquadDesign::makeSvfCoefficients() const noexcept
+{
+    // Simper's trapezoidal SVF: g prewarps the cutoff, k is the damping, and the
+    // shelves move g by the fourth root of the gain so the corner sits where the
+    // RBJ design puts it
+    const double amplitude = std::sqrt(juce::jmax(0.0, gain));
+    const double nyquistLimit = sampleRate * 0.49;
+
+    double g = std::tan(juce::MathConstants<double>::pi * juce::jmin(frequency, nyquistLimit) / sampleRate);
+    double k = 1.0 / q;
+    double m0 = 1.0;
+    double m1 = 0.0;
+    double m2 = 0.0;
+
+    switch (shape)
+    {
+        case Shape::lowShelf:
+            g /= std::sqrt(amplitude);
+            m1 = k * (amplitude - 1.0);
+            m2 = amplitude * amplitude - 1.0;
+            break;
+        case Shape::peak:
+            k = 1.0 / (q * amplitude);
+            m1 = k * (amplitude * amplitude - 1.0);
+            break;
+        case Shape::highShelf:
+            g *= std::sqrt(amplitude);
+            m0 = amplitude * amplitude;
+            m1 = k * (1.0 - amplitude) * amplitude;
+            m2 = 1.0 - amplitude * amplitude;
+            break;
+        case Shape::lowPassSection:
+            m0 = 0.0;
+            m2 = 1.0;
+            break;
+        case Shape::highPassSection:
+            m1 = -k;
+            m2 = -1.0;
+            break;
+        case Shape::lowPass:
+        default:
+            k = juce::MathConstants<double>::sqrt2;
+            m0 = 0.0;
+            m2 = 1.0;
+            break;
+    }
+
+    SvfCoefficients<double> coefficients;
+    const double a1 = 1.0 / (1.0 + g * (g + k));
+    const double a2 = g * a1;
+    coefficients.values = { { a1, a2, g * a2, m0, m1, m2 } };
+    return coefficients;
+}
+
+//==============================================================================
+BiquadDesignSlot::BiquadDesignSlot()
+    : designer(BiquadDesigner::getInstance())
+{
+}
+
+BiquadDesignSlot::~BiquadDesignSlot()
+{
+    designer->removeSlot(*this);
+}
+
+void BiquadDesignSlot::request(const BiquadDesign& design) noexcept
+{
+    auto& pending = requests.getWriteBuffer();
+    pending.design = design;
+    pending.serial = ++lastSerial;
+    requests.publish();
+
+    designer->post(*this);
+}
+
+BiquadCoefficients<double> BiquadDesignSlot::design(const BiquadDesign& design) noexcept
+{
+    appliedSerial = ++lastSerial;
+    return design.makeCoefficients();
+}
+
+bool BiquadDesignSlot::fetch() noexcept
+{
+    if (! results.fetch())
+        return false;
+
+    // A result overtaken by design() on this thread is dropped
+    if (results.read().serial <= appliedSerial)
+        return false;
+
+    appliedSerial = results.read().serial;
+    return true;
+}
+
+void BiquadDesignSlot::designRequest() noexcept
+{
+    if (! requests.fetch())
+        return;
+
+    const auto& request = requests.read();
+    auto& result = results.getWriteBuffer();
+    result.coefficients = request.design.makeCoefficients();
+    result.serial = request.serial;
+    results.publish();
+}
+
+//==============================================================================
+BiquadDesigner::BiquadDesigner()
+{
+    thread = std::thread([this] { run(); });
+}
+
+BiquadDesigner::~BiquadDesigner()
+{
+    {
+        std::lock_guard<std::mutex> lock(wakeMutex);
+        shouldExit = true;
+    }
+
+    wakeCondition.notify_one();
+    thread.join();
+}
+
+std::shared_ptr<BiquadDesigner> BiquadDesigner::getInstance()
+{
+    // Held only by the slots, so the thread goes away with the last filter using it
+    static std::mutex instanceLock;
+    static std::weak_ptr<BiquadDesigner> instance;
+
+    const std::lock_guard<std::mutex> lock(instanceLock);
+    auto designer = instance.lock();
+
+    if (designer == nullptr)
+    {
+        designer = std::make_shared<BiquadDesigner>();
+        instance = designer;
+    }
+
+    return designer;
+}
+
+void BiquadDesigner::post(BackgroundDesignSlot& slot) noexcept
+{
+    // Already waiting - the thread fetches the newest request whenever it gets there.
+    // The exchange also hands the request published before it to the thread's own.
+    if (slot.queued.exchange(true, std::memory_order_acq_rel))
+        return;
+
+    pushPendingSlot(slot);
+}
+
+void BiquadDesigner::removeSlot(BackgroundDesignSlot& slot)
+{
+    const std::lock_guard<std::mutex> lock(designLock);
+
+    if (! slot.queued.load(std::memory_order_acquire))
+        return;
+
+    // The thread is not designing, so the list can be taken apart and put back without the slot
+    for (auto* pending = pendingSlots.exchange(nullptr, std::memory_order_acquire); pending != nullptr;)
+    {
+        auto* next = pending->nextPending;
+
+        if (pending != &slot)
+            pushPendingSlot(*pending);
+
+        pending = next;
+    }
+
+    slot.queued.store(false, std::memory_order_relaxed);
+}
+
+void BiquadDesigner::pushPendingSlot(BackgroundDesignSlot& slot) noexcept
+{
+    auto* head = pendingSlots.load(std::memory_order_relaxed);
+
+    do
+    {
+        slot.nextPending = head;
+    }
+    while (! pendingSlots.compare_exchange_weak(head, &slot, std::memory_order_seq_cst, std::memory_order_relaxed));
+
+    if (sleeping.load(std::memory_order_seq_cst))
+    {
+        // The thread checks the list under the lock before it waits, so it either sees
+        // the slot or is already waiting when this notifies it
+        std::lock_guard<std::mutex> lock(wakeMutex);
+        wakeCondition.notify_one();
+    }
+}
+
+void BiquadDesigner::run()
+{
+    for (;;)
+    {
+        {
+            std::unique_lock<std::mutex> lock(wakeMutex);
+            sleeping.store(true, std::memory_order_seq_cst);
+
+            wakeCondition.wait(lock, [this]
+            {
+                return shouldExit || pendingSlots.load(std::memory_order_seq_cst) != nullptr;
+            });
+
+            sleeping.store(false, std::memory_order_relaxed);
+
+            if (shouldExit)
+                return;
+        }
+
+        const std::lock_guard<std::mutex> lock(designLock);
+
+        for (auto* slot = pendingSlots.exchange(nullptr, std::memory_order_acquire); slot != nullptr;)
+        {
+            // Once it is off the list a new request queues the slot again, so the link
+            // is read first and nothing asked for during the design is lost
+            auto* next = slot->nextPending;
+            slot->queued.exchange(false, std::memory_order_acq_rel);
+            slot->designRequest();
+            slot = next;
+        }
+    }
+}
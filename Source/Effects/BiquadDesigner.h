@@ -0,0 +1,205 @@
+/*
+  ==============================================================================
+
+    BiquadDesigner.h
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <juce_dsp/juce_dsp.h>
+#include <juce_core/juce_core.h>
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "BiquadState.h"
+#include "SvfState.h"
+#include "../TripleBuffer.h"
+
+class BiquadDesigner;
+
+//==============================================================================
+/**
+    Something the shared designer thread works for. Whenever its owner asks for
+    a design the slot queues itself with BiquadDesigner::post(), and the thread
+    calls designRequest() on it once. A slot must call removeSlot() before any of
+    its members go.
+*/
+class BackgroundDesignSlot
+{
+public:
+    virtual ~BackgroundDesignSlot() = default;
+
+private:
+    friend class BiquadDesigner;
+
+    // Set while the slot is on the designer's pending list, so it is queued at most
+    // once however many requests arrive before the thread gets to it
+    std::atomic<bool> queued { false };
+    BackgroundDesignSlot* nextPending = nullptr;
+
+    /** Designer thread: does whatever the slot's owner has asked for since the last pass. */
+    virtual void designRequest() noexcept = 0;
+};
+
+//==============================================================================
+/**
+    The settings of one biquad, from which its coefficients are designed.
+*/
+struct BiquadDesign
+{
+    enum class Shape
+    {
+        lowPass,            // always Butterworth
+        lowShelf,
+        peak,
+        highShelf,
+        lowPassSection,     // one section of a steeper cut, with the q it is given
+        highPassSection
+    };
+
+    Shape shape = Shape::lowPass;
+    double sampleRate = 44100.0;
+    double frequency = 1000.0;
+    double q = 0.707;       // ignored by the low-pass
+    double gain = 1.0;      // linear, and ignored by the low-pass and the cut sections
+
+    /** Runs the design - the trig lives here. */
+    BiquadCoefficients<double> makeCoefficients() const noexcept;
+
+    /** Designs a state-variable section with the same response. This costs one
+        tan and two square roots, cheap enough to run inline as settings glide. */
+    SvfCoefficients<double> makeSvfCoefficients() const noexcept;
+};
+
+//==============================================================================
+/**
+    One filter's link to the shared background designer.
+
+    The thread that owns the filter calls request() whenever its settings change
+    and fetch() once per sub-block; fetch() returns true once coefficients newer
+    than any it has used are waiting in getCoefficients(). Requests and results
+    each go through a TripleBuffer, so the owner never blocks or allocates, and
+    only the newest of several quick requests gets designed.
+
+    design() does the work on the calling thread instead and supersedes any
+    request still in flight, for preparing and for offline renders, where every
+    change has to land on the same sample each time.
+*/
+class BiquadDesignSlot : public BackgroundDesignSlot
+{
+public:
+    //==============================================================================
+    /** Holds on to the designer, starting it if this is the first slot. */
+    BiquadDesignSlot();
+
+    /** Removes any request still queued. The designer stops with the last slot. */
+    ~BiquadDesignSlot() override;
+
+    //==============================================================================
+    /** Hands a design to the background thread without blocking. */
+    void request(const BiquadDesign& design) noexcept;
+
+    /** Designs on the calling thread, superseding any earlier request. */
+    BiquadCoefficients<double> design(const BiquadDesign& design) noexcept;
+
+    /** Picks up the newest finished request. Returns false if there is none, or
+        if design() has been called since it was requested. */
+    bool fetch() noexcept;
+
+    /** The coefficients picked up by the last fetch() that returned true. */
+    const BiquadCoefficients<double>& getCoefficients() const noexcept { return results.read().coefficients; }
+
+    /** True until the newest request has been picked up, or superseded by design(). */
+    bool isPending() const noexcept { return appliedSerial < lastSerial; }
+
+private:
+    //==============================================================================
+    struct Request
+    {
+        BiquadDesign design;
+        std::uint64_t serial = 0;
+    };
+
+    struct Result
+    {
+        BiquadCoefficients<double> coefficients;
+        std::uint64_t serial = 0;
+    };
+
+    TripleBuffer<Request> requests;
+    TripleBuffer<Result> results;
+    std::shared_ptr<BiquadDesigner> designer;
+
+    // Owner thread only. Every request and design() takes the next serial, and a
+    // result is only used if nothing later has been applied
+    std::uint64_t lastSerial = 0;
+    std::uint64_t appliedSerial = 0;
+
+    /** Designer thread: designs the newest request, if there is one. */
+    void designRequest() noexcept override;
+
+    JUCE_DECLARE_NON_COPYABLE(BiquadDesignSlot)
+};
+
+//==============================================================================
+/**
+    A background thread, shared by every BiquadDesignSlot in the process (and
+    any other BackgroundDesignSlot), that designs whatever the slots have asked for.
+
+    Slots with a new request are pushed onto a lock-free list, and the thread
+    only ever visits the slots on it, so idle filters cost it nothing. With the
+    list empty it sleeps, with no timeout, until the next post() wakes it.
+*/
+class BiquadDesigner
+{
+public:
+    //==============================================================================
+    BiquadDesigner();
+
+    /** Stops and joins the thread. */
+    ~BiquadDesigner();
+
+    /** Returns the running designer, or starts one if no slot holds it. */
+    static std::shared_ptr<BiquadDesigner> getInstance();
+
+    //==============================================================================
+    /** Queues a slot whose owner has a new request, unless it is queued already.
+        Never blocks: the pending list is lock-free, and the wake-up lock is only
+        taken while the thread is asleep, when nothing else holds it. */
+    void post(BackgroundDesignSlot& slot) noexcept;
+
+    /** Waits until the thread is done with the slot and takes it off the pending
+        list, so the thread never touches it again. Call before the slot goes. */
+    void removeSlot(BackgroundDesignSlot& slot);
+
+private:
+    //==============================================================================
+    // The slots waiting for the thread, newest first. post() pushes with a CAS and
+    // the thread takes the whole list at once, so neither ever sees a stale node.
+    std::atomic<BackgroundDesignSlot*> pendingSlots { nullptr };
+
+    // Held by the thread while it designs the slots it took, so removeSlot() can
+    // wait for it to finish with them
+    std::mutex designLock;
+
+    // The thread sets sleeping before its last look at the list, and post() checks
+    // it after pushing, so at least one of them sees the other
+    std::mutex wakeMutex;
+    std::condition_variable wakeCondition;
+    std::atomic<bool> sleeping { false };
+    bool shouldExit = false;
+    std::thread thread;
+
+    /** Pushes a slot onto the pending list and wakes the thread if it is asleep. */
+    void pushPendingSlot(BackgroundDesignSlot& slot) noexcept;
+
+    void run();
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(BiquadDesigner)
+};
@@ -0,0 +1,84 @@
+/*
+  ==============================================================================
+
+    BiquadState.h
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <juce_dsp/juce_dsp.h>
+#include <juce_core/juce_core.h>
+#include <array>
+
+//==============================================================================
+/**
+    The five normalised coefficients of a biquad, b0, b1, b2, a1 and a2, held by
+    value so a node keeps them beside the rest of its working set instead of
+    behind a juce::dsp::IIR::Coefficients object on the heap.
+*/
+template<typename SampleType>
+struct BiquadCoefficients
+{
+    std::array<SampleType, 5> values { { SampleType(1), SampleType(0), SampleType(0), SampleType(0), SampleType(0) } };
+
+    /** Normalises the six values returned by juce::dsp::IIR::ArrayCoefficients:
+        b0, b1, b2, a0, a1, a2. */
+    BiquadCoefficients& operator= (const std::array<SampleType, 6>& design) noexcept
+    {
+        const auto a0Inverse = SampleType(1) / design[3];
+
+        values = { { design[0] * a0Inverse, design[1] * a0Inverse, design[2] * a0Inverse,
+                     design[4] * a0Inverse, design[5] * a0Inverse } };
+        return *this;
+    }
+
+    /** Takes the values of a set designed in another precision. */
+    template<typename OtherType>
+    BiquadCoefficients& operator= (const BiquadCoefficients<OtherType>& other) noexcept
+    {
+        for (size_t index = 0; index < values.size(); ++index)
+            values[index] = static_cast<SampleType>(other.values[index]);
+
+        return *this;
+    }
+
+    const SampleType* getRawCoefficients() const noexcept { return values.data(); }
+};
+
+//==============================================================================
+/**
+    The state of one channel of a second-order IIR section in transposed
+    direct form II, run against a shared juce::dsp::IIR::Coefficients object.
+
+    Does the same arithmetic as juce::dsp::IIR::Filter for a biquad, but as
+    plain data: nodes keep one per channel in a vector and can copy one
+    channel's state over another's. SampleType may also be a SIMDRegister, to
+    filter one instance per lane with per-lane coefficients.
+*/
+template<typename SampleType>
+struct BiquadState
+{
+    /** How many coefficients processSample() reads. */
+    static constexpr size_t numCoefficients = 5;
+
+    SampleType s1 {};
+    SampleType s2 {};
+
+    /** Filters one sample. coefficients are the five normalised values from
+        IIR::Coefficients::getRawCoefficients(): b0, b1, b2, a1, a2. */
+    SampleType processSample(SampleType input, const SampleType* coefficients) noexcept
+    {
+        const SampleType output = coefficients[0] * input + s1;
+        s1 = coefficients[1] * input - coefficients[3] * output + s2;
+        s2 = coefficients[2] * input - coefficients[4] * output;
+        return output;
+    }
+
+    void reset() noexcept
+    {
+        s1 = SampleType();
+        s2 = SampleType();
+    }
+};
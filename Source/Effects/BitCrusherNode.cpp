@@ -9,53 +9,93 @@
 #include "BitCrusherNode.h"
 
 //==============================================================================
-BitCrusherNode::BitCrusherNode()
+template<typename SampleType>
+BitCrusherNode<SampleType>::BitCrusherNode()
 {
     // Initialize with default parameters
     bitDepth = 16.0f;
     sampleRateReduction = 1.0f;
-    mix = 0.5f;
-    
-    // Initialize arrays
-    holdValue.fill(0.0f);
-    sampleCounter.fill(0);
+    mix.setCurrentAndTargetValue(0.5f);
 }
 
 //==============================================================================
-void BitCrusherNode::prepare(const juce::dsp::ProcessSpec& spec)
+template<typename SampleType>
+void BitCrusherNode<SampleType>::prepare(const juce::dsp::ProcessSpec& spec)
 {
-    currentSampleRate = spec.sampleRate;
-    
-    // Reset state
+    configure(spec);
+    ownState.build([this](StateArena::Layout& layout) { layOutState(layout); });
     reset();
 }
 
-void BitCrusherNode::reset()
+template<typename SampleType>
+void BitCrusherNode<SampleType>::configure(const juce::dsp::ProcessSpec& spec)
+{
+    currentSampleRate = spec.sampleRate;
+    channelLayout = getChannelLayout(spec.numChannels);
+    numChannels = static_cast<size_t>(spec.numChannels);
+    mix.reset(currentSampleRate, smoothingTimeSeconds);
+}
+
+template<typename SampleType>
+void BitCrusherNode<SampleType>::layOutState(StateArena::Layout& layout)
+{
+    // One sample and hold per channel
+    channelStates = layout.take<ChannelState>(numChannels);
+}
+
+template<typename SampleType>
+void BitCrusherNode<SampleType>::reset()
 {
     // Clear sample and hold state
-    holdValue.fill(0.0f);
-    sampleCounter.fill(0);
+    std::fill(channelStates, channelStates + numChannels, ChannelState());
+}
+
+template<typename SampleType>
+void BitCrusherNode<SampleType>::copyChannelState(size_t sourceChannel, size_t destChannel) noexcept
+{
+    channelStates[destChannel] = channelStates[sourceChannel];
 }
 
 //==============================================================================
-void BitCrusherNode::setBitDepth(float depth)
+template<typename SampleType>
+void BitCrusherNode<SampleType>::setBitDepth(float depth)
 {
     bitDepth = juce::jlimit(1.0f, 16.0f, depth);
+    quantizationLevels = std::pow(SampleType(2), static_cast<SampleType>(bitDepth));
 }
 
-void BitCrusherNode::setSampleRateReduction(float reduction)
+template<typename SampleType>
+void BitCrusherNode<SampleType>::setSampleRateReduction(float reduction)
 {
     sampleRateReduction = juce::jlimit(1.0f, 50.0f, reduction);
+    reductionFactor = static_cast<int>(sampleRateReduction);
 }
 
-void BitCrusherNode::setMix(float mixValue)
+template<typename SampleType>
+void BitCrusherNode<SampleType>::setMix(float mixValue)
 {
-    mix = juce::jlimit(0.0f, 1.0f, mixValue);
+    mix.setTargetValue(juce::jlimit(0.0f, 1.0f, mixValue));
+}
+
+template<typename SampleType>
+void BitCrusherNode<SampleType>::setSmoothingTime(double seconds)
+{
+    smoothingTimeSeconds = seconds;
+    mix.reset(currentSampleRate, smoothingTimeSeconds);
+}
+
+//==============================================================================
+template<typename SampleType>
+double BitCrusherNode<SampleType>::getTailLengthSeconds(float silenceLevel) const
+{
+    juce::ignoreUnused(silenceLevel);
+    return sampleRateReduction / currentSampleRate;
 }
 
 //==============================================================================
+template<typename SampleType>
 template<typename ProcessContext>
-void BitCrusherNode::process(const ProcessContext& context) noexcept
+void BitCrusherNode<SampleType>::process(const ProcessContext& context) noexcept
 {
     // Handle bypassed state
     if (context.isBypassed)
@@ -65,55 +105,30 @@ void BitCrusherNode::process(const ProcessContext& context) noexcept
         return;
     }
 
-    auto& inputBlock = context.getInputBlock();
-    auto& outputBlock = context.getOutputBlock();
-    auto numChannels = outputBlock.getNumChannels();
-    auto numSamples = outputBlock.getNumSamples();
-
-    // Copy input to output first
-    if (context.usesSeparateInputAndOutputBlocks())
-        outputBlock.copyFrom(inputBlock);
+    auto numSamples = context.getOutputBlock().getNumSamples();
 
-    // Process each channel
-    for (size_t channel = 0; channel < numChannels; ++channel)
+    // Process in sub-blocks so the mix ramp is computed once for all channels
+    for (size_t start = 0; start < numSamples; start += maxSubBlockSize)
     {
-        auto* channelData = outputBlock.getChannelPointer(channel);
-        
-        for (size_t sample = 0; sample < numSamples; ++sample)
-        {
-            // Sample rate reduction (sample and hold)
-            if (sampleRateReduction > 1.0f)
-            {
-                if (sampleCounter[channel] >= static_cast<int>(sampleRateReduction))
-                {
-                    holdValue[channel] = channelData[sample];
-                    sampleCounter[channel] = 0;
-                }
-                else
-                {
-                    channelData[sample] = holdValue[channel];
-                }
-                sampleCounter[channel]++;
-            }
-
-            // Bit depth reduction
-            if (bitDepth < 16.0f)
-            {
-                float levels = std::pow(2.0f, bitDepth);
-                float quantized = std::floor(channelData[sample] * levels + 0.5f) / levels;
-                channelData[sample] = quantized;
-            }
-
-            // Apply mix
-            float drySignal = (context.usesSeparateInputAndOutputBlocks()) 
-                ? inputBlock.getChannelPointer(channel)[sample] 
-                : channelData[sample];
-                
-            channelData[sample] = drySignal * (1.0f - mix) + channelData[sample] * mix;
-        }
+        const auto subBlockSize = juce::jmin(numSamples - start, static_cast<size_t>(maxSubBlockSize));
+        beginSubBlock(static_cast<int>(subBlockSize));
+
+        // Process every channel through the kernel picked in configure()
+        processChannels(*this, channelLayout, context, start, subBlockSize);
     }
 }
 
-// Explicit template instantiations for common ProcessContext types
-template void BitCrusherNode::process<juce::dsp::ProcessContextReplacing<float>>(const juce::dsp::ProcessContextReplacing<float>&) noexcept;
-template void BitCrusherNode::process<juce::dsp::ProcessContextNonReplacing<float>>(const juce::dsp::ProcessContextNonReplacing<float>&) noexcept;
+//==============================================================================
+template class BitCrusherNode<float>;
+template class BitCrusherNode<double>;
+
+// Explicit template instantiations for common ProcessContext types. Either precision
+// of node runs on blocks of either precision, converting sample by sample.
+template void BitCrusherNode<float>::process<juce::dsp::ProcessContextReplacing<float>>(const juce::dsp::ProcessContextReplacing<float>&) noexcept;
+template void BitCrusherNode<float>::process<juce::dsp::ProcessContextReplacing<double>>(const juce::dsp::ProcessContextReplacing<double>&) noexcept;
+template void BitCrusherNode<float>::process<juce::dsp::ProcessContextNonReplacing<float>>(const juce::dsp::ProcessContextNonReplacing<float>&) noexcept;
+template void BitCrusherNode<float>::process<juce::dsp::ProcessContextNonReplacing<double>>(const juce::dsp::ProcessContextNonReplacing<double>&) noexcept;
+template void BitCrusherNode<double>::process<juce::dsp::ProcessContextReplacing<float>>(const juce::dsp::ProcessContextReplacing<float>&) noexcept;
+template void BitCrusherNode<double>::process<juce::dsp::ProcessContextReplacing<double>>(const juce::dsp::ProcessContextReplacing<double>&) noexcept;
+template void BitCrusherNode<double>::process<juce::dsp::ProcessContextNonReplacing<float>>(const juce::dsp::ProcessContextNonReplacing<float>&) noexcept;
+template void BitCrusherNode<double>::process<juce::dsp::ProcessContextNonReplacing<double>>(const juce::dsp::ProcessContextNonReplacing<double>&) noexcept;
@@ -11,6 +11,9 @@
 #include <juce_dsp/juce_dsp.h>
 #include <juce_audio_basics/juce_audio_basics.h>
 #include <juce_core/juce_core.h>
+#include "ChannelKernels.h"
+#include "SmoothedParameter.h"
+#include "StateArena.h"
 
 //==============================================================================
 /**
@@ -19,17 +22,35 @@
     
     This class provides bit depth reduction and sample rate downsampling
     while maintaining compatibility with JUCE's DSP framework.
+    
+    SampleType is the precision of the held samples and the arithmetic; process()
+    accepts blocks of either precision.
 */
+template<typename SampleType>
 class BitCrusherNode
 {
 public:
+    //==============================================================================
+    /** The precision the node holds samples and computes in. */
+    using StateType = SampleType;
+    
     //==============================================================================
     BitCrusherNode();
     ~BitCrusherNode() = default;
 
     //==============================================================================
-    /** Prepares the processor for playback with the given sample rate and buffer size. */
+    /** Prepares the processor for playback with the given sample rate and buffer size,
+        keeping its state in an arena of its own. */
     void prepare(const juce::dsp::ProcessSpec& spec);
+    
+    /** Sets the processor up for the given sample rate and channel count without
+        touching its state. Before processing, the state has to be taken from an
+        arena with layOutState() and cleared with reset(). */
+    void configure(const juce::dsp::ProcessSpec& spec);
+    
+    /** Takes the state for the configured sample rate and channel count from an
+        arena's layout. */
+    void layOutState(StateArena::Layout& layout);
 
     /** Resets the processor's internal state. */
     void reset();
@@ -47,16 +68,90 @@ public:
     
     /** Sets the wet/dry mix (0.0 = dry, 1.0 = wet). */
     void setMix(float mixValue);
+    
+    /** Sets the ramp length used when the mix changes. */
+    void setSmoothingTime(double seconds);
+    
+    /** Overwrites one channel's sample and hold state with another's, so the
+        destination carries on exactly as the source would. */
+    void copyChannelState(size_t sourceChannel, size_t destChannel) noexcept;
+    
+    //==============================================================================
+    /** The longest sub-block a single call to beginSubBlock() may cover. */
+    static constexpr int maxSubBlockSize = SmoothedParameter<float>::maxRampLength;
+    
+    /** Advances the mix ramp over the next numSamples. Call this once per sub-block,
+        then processSample() for every sample of every channel in it. */
+    void beginSubBlock(int numSamples) noexcept
+    {
+        mixRamping = mix.advance(numSamples);
+        currentMix = mix.getCurrentValue();
+    }
+    
+    /** Crushes one sample. sampleIndex counts from the start of the current sub-block.
+        Defined here so chains of nodes can be inlined into a single loop. */
+    SampleType processSample(size_t channel, int sampleIndex, SampleType input) noexcept
+    {
+        SampleType wetSignal = input;
+        auto& state = channelStates[channel];
+        
+        // Sample rate reduction (sample and hold)
+        if (sampleRateReduction > 1.0f)
+        {
+            if (state.sampleCounter >= reductionFactor)
+            {
+                state.holdValue = wetSignal;
+                state.sampleCounter = 0;
+            }
+            else
+            {
+                wetSignal = state.holdValue;
+            }
+            state.sampleCounter++;
+        }
+        
+        // Bit depth reduction
+        if (bitDepth < 16.0f)
+            wetSignal = std::floor(wetSignal * quantizationLevels + SampleType(0.5)) / quantizationLevels;
+        
+        // Apply mix - read the ramp only while the mix is moving
+        const auto mixAmount = static_cast<SampleType>(mixRamping ? mix.getRamp()[sampleIndex] : currentMix);
+        return input * (SampleType(1) - mixAmount) + wetSignal * mixAmount;
+    }
+    
+    //==============================================================================
+    /** Returns how long the output keeps changing after the input goes silent.
+        Only the sample-and-hold stage carries anything over. */
+    double getTailLengthSeconds(float silenceLevel) const;
 
 private:
     //==============================================================================
     float bitDepth = 16.0f;
     float sampleRateReduction = 1.0f;
-    float mix = 0.5f;
+    SampleType quantizationLevels = 65536;
+    int reductionFactor = 1;
+    SmoothedParameter<float> mix { 0.5f };
+    
+    // Mix state for the current sub-block
+    bool mixRamping = false;
+    float currentMix = 0.5f;
+    double smoothingTimeSeconds = 0.02;
+    
+    // Sample and hold state for each channel, side by side in the arena
+    struct ChannelState
+    {
+        SampleType holdValue = 0;
+        int sampleCounter = 0;
+    };
+    
+    ChannelState* channelStates = nullptr;
+    size_t numChannels = 0;
+    
+    // Channel kernel picked in configure()
+    ChannelLayout channelLayout = ChannelLayout::generic;
     
-    // Sample and hold state for each channel
-    std::array<float, 8> holdValue{};  // Support up to 8 channels
-    std::array<int, 8> sampleCounter{};
+    // Holds the state when the node is prepared on its own rather than laid out by its owner
+    StateArena ownState;
     
      double currentSampleRate = 44100.0; // Update this variable to get the sample rate using the juce method
 //    double currentSampleRate = getSampleRate();
@@ -0,0 +1,121 @@
+/*
+  ==============================================================================
+
+    ChannelKernels.h
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <juce_dsp/juce_dsp.h>
+#include <juce_core/juce_core.h>
+#include <array>
+
+//==============================================================================
+/**
+    The channel counts the per-sample nodes have fixed-size kernels for.
+
+    A node picks its layout in prepare() from the channel count it is prepared
+    for. Mono and stereo get kernels with a compile-time channel count, so the
+    channel loop is fully unrolled and every channel's state is advanced side
+    by side; anything else runs the generic kernel.
+*/
+enum class ChannelLayout
+{
+    generic,
+    mono,
+    stereo
+};
+
+/** Returns the layout with a fixed-size kernel for numChannels, or generic. */
+inline ChannelLayout getChannelLayout(size_t numChannels) noexcept
+{
+    switch (numChannels)
+    {
+        case 1:  return ChannelLayout::mono;
+        case 2:  return ChannelLayout::stereo;
+        default: return ChannelLayout::generic;
+    }
+}
+
+//==============================================================================
+/**
+    Runs node.processSample() over numSamples samples of every channel, starting
+    at start. The node's beginSubBlock() must already have been called.
+
+    FixedChannels is the channel count for the mono and stereo kernels, or 0 for
+    the generic one. SeparateBlocks reads from the context's input block rather
+    than in place, so non-replacing contexts need no copy up front.
+*/
+template<size_t FixedChannels, bool SeparateBlocks, typename NodeType, typename ProcessContext>
+void runChannelKernel(NodeType& node, const ProcessContext& context, size_t start, size_t numSamples) noexcept
+{
+    using BlockSampleType = typename ProcessContext::SampleType;
+    using StateType = typename NodeType::StateType;
+
+    auto& inputBlock = context.getInputBlock();
+    auto& outputBlock = context.getOutputBlock();
+
+    auto processChannel = [&node](size_t channel, const BlockSampleType* input, BlockSampleType* output, size_t sample)
+    {
+        output[sample] = static_cast<BlockSampleType>(
+            node.processSample(channel, static_cast<int>(sample), static_cast<StateType>(input[sample])));
+    };
+
+    if constexpr (FixedChannels > 0)
+    {
+        std::array<const BlockSampleType*, FixedChannels> inputs {};
+        std::array<BlockSampleType*, FixedChannels> outputs {};
+
+        for (size_t channel = 0; channel < FixedChannels; ++channel)
+        {
+            outputs[channel] = outputBlock.getChannelPointer(channel) + start;
+            inputs[channel] = SeparateBlocks ? inputBlock.getChannelPointer(channel) + start : outputs[channel];
+        }
+
+        // Every channel's sample goes through before the next sample is read
+        for (size_t sample = 0; sample < numSamples; ++sample)
+            for (size_t channel = 0; channel < FixedChannels; ++channel)
+                processChannel(channel, inputs[channel], outputs[channel], sample);
+    }
+    else
+    {
+        for (size_t channel = 0; channel < outputBlock.getNumChannels(); ++channel)
+        {
+            auto* output = outputBlock.getChannelPointer(channel) + start;
+            const auto* input = SeparateBlocks ? inputBlock.getChannelPointer(channel) + start : output;
+
+            for (size_t sample = 0; sample < numSamples; ++sample)
+                processChannel(channel, input, output, sample);
+        }
+    }
+}
+
+/** Runs the kernel for the node's prepared layout over one sub-block. A block
+    with a different channel count from the layout takes the generic kernel,
+    except a single channel (as the engine passes dual-mono input), which takes
+    the mono one. */
+template<typename NodeType, typename ProcessContext>
+void processChannels(NodeType& node, ChannelLayout layout, const ProcessContext& context, size_t start, size_t numSamples) noexcept
+{
+    constexpr bool separateBlocks = ProcessContext::usesSeparateInputAndOutputBlocks();
+    const auto numChannels = context.getOutputBlock().getNumChannels();
+
+    if (getChannelLayout(numChannels) != layout)
+        layout = numChannels == 1 ? ChannelLayout::mono : ChannelLayout::generic;
+
+    switch (layout)
+    {
+        case ChannelLayout::mono:
+            runChannelKernel<1, separateBlocks>(node, context, start, numSamples);
+            break;
+        case ChannelLayout::stereo:
+            runChannelKernel<2, separateBlocks>(node, context, start, numSamples);
+            break;
+        case ChannelLayout::generic:
+        default:
+            runChannelKernel<0, separateBlocks>(node, context, start, numSamples);
+            break;
+    }
+}
@@ -9,103 +9,234 @@
 #include "DelayNode.h"
 
 //==============================================================================
-DelayNode::DelayNode()
+template<typename SampleType>
+DelayNode<SampleType>::DelayNode()
 {
     // Initialize with default parameters
     delayTimeMs = 250.0f;
-    feedback = 0.3f;
-    mix = 0.3f;
+    feedback.setCurrentAndTargetValue(0.3f);
+    mix.setCurrentAndTargetValue(0.3f);
     lowPassCutoff = 8000.0f;
+    
+    updateDelayTime();
+    updateLowPassFilter(true);
 }
 
 //==============================================================================
-void DelayNode::prepare(const juce::dsp::ProcessSpec& spec)
+template<typename SampleType>
+void DelayNode<SampleType>::prepare(const juce::dsp::ProcessSpec& spec)
+{
+    configure(spec);
+    ownState.build([this](StateArena::Layout& layout) { layOutState(layout); });
+    reset();
+}
+
+template<typename SampleType>
+void DelayNode<SampleType>::configure(const juce::dsp::ProcessSpec& spec)
 {
     currentSampleRate = spec.sampleRate;
+    channelLayout = getChannelLayout(spec.numChannels);
+    numChannels = static_cast<size_t>(spec.numChannels);
     
-    // Prepare delay lines
-    for (auto& delayLine : delayLines)
-    {
-        delayLine.prepare(spec);
-        delayLine.setMaximumDelayInSamples(maxDelayInSamples);
-    }
+    // Room for the longest delay at this sample rate, on every channel in use
+    maxDelayInSamples = static_cast<int>(std::ceil(maxDelaySeconds * currentSampleRate));
+    bufferLength = maxDelayInSamples + 2;
     
-    // Prepare low-pass filters
-    for (auto& filter : lowPassFilters)
-    {
-        filter.prepare(spec);
-    }
+    constexpr auto samplesPerLine = StateArena::alignment / sizeof(SampleType);
+    channelStride = (static_cast<size_t>(bufferLength) + samplesPerLine - 1) / samplesPerLine * samplesPerLine;
     
-    // Update parameters
+    // Update parameters and snap the smoothers to their targets
     updateDelayTime();
-    updateLowPassFilter();
+    updateLowPassFilter(true);
     
-    // Reset state
-    reset();
+    delayTimeInSamples.reset(currentSampleRate, smoothingTimeSeconds);
+    feedback.reset(currentSampleRate, smoothingTimeSeconds);
+    mix.reset(currentSampleRate, smoothingTimeSeconds);
+}
+
+template<typename SampleType>
+void DelayNode<SampleType>::layOutState(StateArena::Layout& layout)
+{
+    // The filter states are touched every sample, so they come first and together
+    lowPassStates = layout.take<BiquadState<double>>(numChannels);
+    delayBuffer = layout.take<SampleType>(channelStride * numChannels);
+}
+
+template<typename SampleType>
+void DelayNode<SampleType>::reset()
+{
+    // Forget the delay line; the part the next reads reach is zeroed as they get there
+    writePosition = 0;
+    lastSubBlockSize = 0;
+    writtenHistory = 0;
+    
+    // Reset filters
+    for (size_t channel = 0; channel < numChannels; ++channel)
+    {
+        lowPassStates[channel].reset();
+    }
 }
 
-void DelayNode::reset()
+template<typename SampleType>
+void DelayNode<SampleType>::clearStaleHistory(int numSamples) noexcept
 {
-    // Clear delay lines
-    for (auto& delayLine : delayLines)
+    // The shortest and longest delay read anywhere in the sub-block
+    float shortest = currentDelay;
+    float longest = currentDelay;
+    
+    if (delayRamping)
     {
-        delayLine.reset();
+        const auto* ramp = delayTimeInSamples.getRamp();
+        const auto range = std::minmax_element(ramp, ramp + numSamples);
+        shortest = *range.first;
+        longest = *range.second;
     }
     
-    // Reset filters
-    for (auto& filter : lowPassFilters)
+    auto clearPositions = [this](int first, int count)
+    {
+        for (size_t channel = 0; channel < numChannels; ++channel)
+        {
+            auto* history = delayBuffer + channel * channelStride;
+            const int firstRun = juce::jmin(count, bufferLength - first);
+            
+            std::fill(history + first, history + first + firstRun, SampleType(0));
+            std::fill(history, history + (count - firstRun), SampleType(0));
+        }
+    };
+    
+    // The first sample reads back as far as the delay's whole part plus one, the
+    // interpolation partner. Everything between the written history and there is stale.
+    const int reach = juce::jmin(static_cast<int>(longest) + 1, bufferLength);
+    
+    if (reach > writtenHistory)
     {
-        filter.reset();
+        const int first = (writePosition - reach + bufferLength) % bufferLength;
+        clearPositions(first, reach - writtenHistory);
+        writtenHistory = reach;
     }
+    
+    // A delay under one sample reads each position just before overwriting it,
+    // so the positions this sub-block writes are read as they were a lap ago
+    if (static_cast<int>(shortest) == 0 && writtenHistory < bufferLength)
+        clearPositions(writePosition, juce::jmin(numSamples, bufferLength - writtenHistory));
+}
+
+template<typename SampleType>
+void DelayNode<SampleType>::copyChannelState(size_t sourceChannel, size_t destChannel) noexcept
+{
+    const auto* source = delayBuffer + sourceChannel * channelStride;
+    auto* dest = delayBuffer + destChannel * channelStride;
+    
+    // Only the history written since reset() is ever read back, as anything older is
+    // zeroed first, so that is all that needs copying: the last sub-block plus the
+    // writtenHistory samples before it, ending where the next sub-block starts
+    const int count = juce::jmin(writtenHistory + lastSubBlockSize, bufferLength);
+    const int end = (writePosition + lastSubBlockSize) % bufferLength;
+    const int first = (end - count + bufferLength) % bufferLength;
+    const int firstRun = juce::jmin(count, bufferLength - first);
+    
+    std::copy(source + first, source + first + firstRun, dest + first);
+    std::copy(source, source + (count - firstRun), dest);
+    
+    lowPassStates[destChannel] = lowPassStates[sourceChannel];
 }
 
 //==============================================================================
-void DelayNode::setDelayTime(float timeMs)
+template<typename SampleType>
+void DelayNode<SampleType>::setDelayTime(float timeMs)
 {
     delayTimeMs = juce::jlimit(0.0f, 2000.0f, timeMs);
     updateDelayTime();
 }
 
-void DelayNode::setFeedback(float feedbackAmount)
+template<typename SampleType>
+void DelayNode<SampleType>::setFeedback(float feedbackAmount)
 {
-    feedback = juce::jlimit(0.0f, 0.95f, feedbackAmount);
+    feedback.setTargetValue(juce::jlimit(0.0f, 0.95f, feedbackAmount));
 }
 
-void DelayNode::setMix(float mixValue)
+template<typename SampleType>
+void DelayNode<SampleType>::setMix(float mixValue)
 {
-    mix = juce::jlimit(0.0f, 1.0f, mixValue);
+    mix.setTargetValue(juce::jlimit(0.0f, 1.0f, mixValue));
 }
 
-void DelayNode::setLowPassCutoff(float cutoffHz)
+template<typename SampleType>
+void DelayNode<SampleType>::setLowPassCutoff(float cutoffHz)
 {
     lowPassCutoff = juce::jlimit(200.0f, 20000.0f, cutoffHz);
-    updateLowPassFilter();
+    updateLowPassFilter(! designInBackground);
+}
+
+template<typename SampleType>
+void DelayNode<SampleType>::setSmoothingTime(double seconds)
+{
+    smoothingTimeSeconds = seconds;
+    delayTimeInSamples.reset(currentSampleRate, smoothingTimeSeconds);
+    feedback.reset(currentSampleRate, smoothingTimeSeconds);
+    mix.reset(currentSampleRate, smoothingTimeSeconds);
+}
+
+template<typename SampleType>
+void DelayNode<SampleType>::setDesignInBackground(bool shouldDesignInBackground)
+{
+    if (shouldDesignInBackground == designInBackground)
+        return;
+    
+    designInBackground = shouldDesignInBackground;
+    
+    // Take over a design still in flight, so it lands now rather than whenever it comes back
+    if (! designInBackground)
+        updateLowPassFilter(true);
 }
 
 //==============================================================================
-void DelayNode::updateDelayTime()
+template<typename SampleType>
+double DelayNode<SampleType>::getTailLengthSeconds(float silenceLevel) const
 {
-    delayTimeInSamples = (delayTimeMs / 1000.0f) * static_cast<float>(currentSampleRate);
-    delayTimeInSamples = juce::jlimit(0.0f, static_cast<float>(maxDelayInSamples), delayTimeInSamples);
+    // Echoes are never heard with a fully dry mix
+    if (mix.getTargetValue() <= 0.0f)
+        return 0.0;
+    
+    const double delaySeconds = delayTimeMs / 1000.0;
+    const double feedbackAmount = feedback.getTargetValue();
+    
+    // Each pass through the loop scales the echo by the feedback amount
+    // (the low-pass only removes energy, so this is an upper bound)
+    double repeats = 0.0;
+    
+    if (feedbackAmount > 0.0)
+        repeats = std::ceil(std::log(static_cast<double>(silenceLevel)) / std::log(feedbackAmount));
+    
+    return delaySeconds * (repeats + 1.0);
 }
 
-void DelayNode::updateLowPassFilter()
+//==============================================================================
+template<typename SampleType>
+void DelayNode<SampleType>::updateDelayTime()
 {
-    if (currentSampleRate > 0.0)
-    {
-        auto coefficients = juce::dsp::IIR::Coefficients<float>::makeLowPass(
-            currentSampleRate, lowPassCutoff);
-        
-        for (auto& filter : lowPassFilters)
-        {
-            filter.coefficients = coefficients;
-        }
-    }
+    auto samples = (delayTimeMs / 1000.0f) * static_cast<float>(currentSampleRate);
+    delayTimeInSamples.setTargetValue(juce::jlimit(0.0f, static_cast<float>(maxDelayInSamples), samples));
+}
+
+template<typename SampleType>
+void DelayNode<SampleType>::updateLowPassFilter(bool designHere)
+{
+    if (currentSampleRate <= 0.0)
+        return;
+    
+    const BiquadDesign design { BiquadDesign::Shape::lowPass, currentSampleRate, static_cast<double>(lowPassCutoff) };
+    
+    if (designHere)
+        lowPassCoefficients = lowPassDesigns.design(design);
+    else
+        lowPassDesigns.request(design);
 }
 
 //==============================================================================
+template<typename SampleType>
 template<typename ProcessContext>
-void DelayNode::process(const ProcessContext& context) noexcept
+void DelayNode<SampleType>::process(const ProcessContext& context) noexcept
 {
     // Handle bypassed state
     if (context.isBypassed)
@@ -115,43 +246,30 @@ void DelayNode::process(const ProcessContext& context) noexcept
         return;
     }
 
-    auto& inputBlock = context.getInputBlock();
-    auto& outputBlock = context.getOutputBlock();
-    auto numChannels = outputBlock.getNumChannels();
-    auto numSamples = outputBlock.getNumSamples();
+    auto numSamples = context.getOutputBlock().getNumSamples();
 
-    // Copy input to output first
-    if (context.usesSeparateInputAndOutputBlocks())
-        outputBlock.copyFrom(inputBlock);
-
-    // Process each channel
-    for (size_t channel = 0; channel < numChannels; ++channel)
+    // Process in sub-blocks so each ramp is computed once for all channels
+    for (size_t start = 0; start < numSamples; start += maxSubBlockSize)
     {
-        auto* channelData = outputBlock.getChannelPointer(channel);
-        const auto* inputData = (context.usesSeparateInputAndOutputBlocks()) 
-            ? inputBlock.getChannelPointer(channel) 
-            : channelData;
+        const auto subBlockSize = juce::jmin(numSamples - start, static_cast<size_t>(maxSubBlockSize));
+        beginSubBlock(static_cast<int>(subBlockSize));
 
-        for (size_t sample = 0; sample < numSamples; ++sample)
-        {
-            // Get delayed sample
-            float delayedSample = delayLines[channel].popSample(0, delayTimeInSamples, true);
-            
-            // Apply low-pass filter to feedback
-            float filteredFeedback = lowPassFilters[channel].processSample(delayedSample);
-            
-            // Calculate input to delay line (input + filtered feedback)
-            float delayInput = inputData[sample] + (filteredFeedback * feedback);
-            
-            // Push new sample to delay line
-            delayLines[channel].pushSample(0, delayInput);
-            
-            // Mix dry and wet signals
-            channelData[sample] = inputData[sample] * (1.0f - mix) + delayedSample * mix;
-        }
+        // Process every channel through the kernel picked in configure()
+        processChannels(*this, channelLayout, context, start, subBlockSize);
     }
 }
 
-// Explicit template instantiations for common ProcessContext types
-template void DelayNode::process<juce::dsp::ProcessContextReplacing<float>>(const juce::dsp::ProcessContextReplacing<float>&) noexcept;
-template void DelayNode::process<juce::dsp::ProcessContextNonReplacing<float>>(const juce::dsp::ProcessContextNonReplacing<float>&) noexcept;
+//==============================================================================
+template class DelayNode<float>;
+template class DelayNode<double>;
+
+// Explicit template instantiations for common ProcessContext types. Either precision
+// of node runs on blocks of either precision, converting sample by sample.
+template void DelayNode<float>::process<juce::dsp::ProcessContextReplacing<float>>(const juce::dsp::ProcessContextReplacing<float>&) noexcept;
+template void DelayNode<float>::process<juce::dsp::ProcessContextReplacing<double>>(const juce::dsp::ProcessContextReplacing<double>&) noexcept;
+template void DelayNode<float>::process<juce::dsp::ProcessContextNonReplacing<float>>(const juce::dsp::ProcessContextNonReplacing<float>&) noexcept;
+template void DelayNode<float>::process<juce::dsp::ProcessContextNonReplacing<double>>(const juce::dsp::ProcessContextNonReplacing<double>&) noexcept;
+template void DelayNode<double>::process<juce::dsp::ProcessContextReplacing<float>>(const juce::dsp::ProcessContextReplacing<float>&) noexcept;
+template void DelayNode<double>::process<juce::dsp::ProcessContextReplacing<double>>(const juce::dsp::ProcessContextReplacing<double>&) noexcept;
+template void DelayNode<double>::process<juce::dsp::ProcessContextNonReplacing<float>>(const juce::dsp::ProcessContextNonReplacing<float>&) noexcept;
+template void DelayNode<double>::process<juce::dsp::ProcessContextNonReplacing<double>>(const juce::dsp::ProcessContextNonReplacing<double>&) noexcept;
@@ -11,6 +11,11 @@
 #include <juce_dsp/juce_dsp.h>
 #include <juce_audio_basics/juce_audio_basics.h>
 #include <juce_core/juce_core.h>
+#include "BiquadDesigner.h"
+#include "BiquadState.h"
+#include "ChannelKernels.h"
+#include "SmoothedParameter.h"
+#include "StateArena.h"
 
 //==============================================================================
 /**
@@ -18,17 +23,38 @@
     
     This class provides variable delay time, feedback control, and low-pass filtering
     while maintaining compatibility with JUCE's DSP framework.
+    
+    SampleType is the precision of the delay line storage; process() accepts
+    blocks of either precision. The feedback low-pass always runs in double,
+    since its state recirculates through every repeat. Cutoff changes are
+    designed on the shared BiquadDesigner thread and picked up by
+    beginSubBlock().
 */
+template<typename SampleType>
 class DelayNode
 {
 public:
+    //==============================================================================
+    /** The precision the node keeps its delay lines in. */
+    using StateType = SampleType;
+    
     //==============================================================================
     DelayNode();
     ~DelayNode() = default;
 
     //==============================================================================
-    /** Prepares the processor for playback with the given sample rate and buffer size. */
+    /** Prepares the processor for playback with the given sample rate and buffer size,
+        keeping its state in an arena of its own. */
     void prepare(const juce::dsp::ProcessSpec& spec);
+    
+    /** Sets the processor up for the given sample rate and channel count without
+        touching its state. Before processing, the state has to be taken from an
+        arena with layOutState() and cleared with reset(). */
+    void configure(const juce::dsp::ProcessSpec& spec);
+    
+    /** Takes the state for the configured sample rate and channel count from an
+        arena's layout. */
+    void layOutState(StateArena::Layout& layout);
 
     /** Resets the processor's internal state. */
     void reset();
@@ -49,28 +75,158 @@ public:
     
     /** Sets the low-pass filter cutoff frequency for feedback (200-20000Hz). */
     void setLowPassCutoff(float cutoffHz);
+    
+    /** Sets the ramp length used when delay time, feedback or mix change. */
+    void setSmoothingTime(double seconds);
+    
+    /** Chooses between designing the low-pass on the background thread (the
+        default) and on the calling thread, so offline renders apply every
+        cutoff change on the same sample each time. */
+    void setDesignInBackground(bool shouldDesignInBackground);
+    
+    /** Overwrites one channel's delay history and filter state with another's,
+        so the destination carries on exactly as the source would. Only the part
+        of the history written since reset() is copied. */
+    void copyChannelState(size_t sourceChannel, size_t destChannel) noexcept;
+    
+    //==============================================================================
+    /** The longest sub-block a single call to beginSubBlock() may cover. */
+    static constexpr int maxSubBlockSize = SmoothedParameter<float>::maxRampLength;
+    
+    /** Advances the delay time, feedback and mix ramps over the next numSamples.
+        Call this once per sub-block, then processSample() for every sample of
+        every channel in it. */
+    void beginSubBlock(int numSamples) noexcept
+    {
+        // A cutoff change takes effect as soon as its coefficients come back
+        if (lowPassDesigns.fetch())
+            lowPassCoefficients = lowPassDesigns.getCoefficients();
+        
+        // Every channel writes in step, so one position serves them all
+        writePosition = (writePosition + lastSubBlockSize) % bufferLength;
+        writtenHistory = juce::jmin(writtenHistory + lastSubBlockSize, bufferLength);
+        lastSubBlockSize = numSamples;
+        
+        delayRamping = delayTimeInSamples.advance(numSamples);
+        feedbackRamping = feedback.advance(numSamples);
+        mixRamping = mix.advance(numSamples);
+        
+        currentDelay = delayTimeInSamples.getCurrentValue();
+        currentFeedback = feedback.getCurrentValue();
+        currentMix = mix.getCurrentValue();
+        
+        // Until a whole buffer has been written since reset(), part of it is stale
+        if (writtenHistory < bufferLength)
+            clearStaleHistory(numSamples);
+    }
+    
+    /** Delays one sample. sampleIndex counts from the start of the current sub-block.
+        Defined here so chains of nodes can be inlined into a single loop. */
+    SampleType processSample(size_t channel, int sampleIndex, SampleType input) noexcept
+    {
+        // Read the ramps only while the corresponding parameter is moving
+        const float delaySamples = delayRamping ? delayTimeInSamples.getRamp()[sampleIndex] : currentDelay;
+        const float feedbackAmount = feedbackRamping ? feedback.getRamp()[sampleIndex] : currentFeedback;
+        const auto mixAmount = static_cast<SampleType>(mixRamping ? mix.getRamp()[sampleIndex] : currentMix);
+        
+        SampleType* history = delayBuffer + channel * channelStride;
+        
+        int position = writePosition + sampleIndex;
+        
+        if (position >= bufferLength)
+            position -= bufferLength;
+        
+        // Get the delayed sample, interpolating linearly between the two nearest
+        const auto delay = static_cast<SampleType>(delaySamples);
+        const int delayInt = static_cast<int>(delay);
+        const SampleType delayFrac = delay - static_cast<SampleType>(delayInt);
+        
+        int index1 = position - delayInt;
+        
+        if (index1 < 0)
+            index1 += bufferLength;
+        
+        const int index2 = index1 > 0 ? index1 - 1 : bufferLength - 1;
+        const SampleType delayedSample = history[index1] + delayFrac * (history[index2] - history[index1]);
+        
+        // Apply low-pass filter to feedback
+        const double filteredFeedback = lowPassStates[channel].processSample(static_cast<double>(delayedSample),
+                                                                             lowPassCoefficients.getRawCoefficients());
+        
+        // Write the input plus filtered feedback into the delay line
+        history[position] = input + static_cast<SampleType>(filteredFeedback * feedbackAmount);
+        
+        // Mix dry and wet signals
+        return input * (SampleType(1) - mixAmount) + delayedSample * mixAmount;
+    }
+    
+    //==============================================================================
+    /** Returns how long the echoes take to fall below silenceLevel (as a gain)
+        once the input stops, based on the delay time and feedback. */
+    double getTailLengthSeconds(float silenceLevel) const;
 
 private:
     //==============================================================================
-    static constexpr int maxDelayInSamples = 96000; // 2 seconds at 48kHz
-    static constexpr int maxChannels = 8;
+    static constexpr double maxDelaySeconds = 2.0;
+    
+    // The longest delay at the prepared sample rate, and the history kept per
+    // channel: two more samples than that, as juce::dsp::DelayLine allocates
+    int maxDelayInSamples = 88200;
+    int bufferLength = 88202;
+    
+    // The feedback filter states of every channel share a cache line or two; the
+    // channels' histories follow back to back, each starting on a new line. Both
+    // live in the arena, sized for the channel count and sample rate by configure().
+    BiquadState<double>* lowPassStates = nullptr;
+    SampleType* delayBuffer = nullptr;
+    size_t channelStride = 0;
+    size_t numChannels = 0;
+    int writePosition = 0;
+    int lastSubBlockSize = 0;
     
-    std::array<juce::dsp::DelayLine<float>, maxChannels> delayLines;
-    std::array<juce::dsp::IIR::Filter<float>, maxChannels> lowPassFilters;
+    // reset() leaves the history as it was and only forgets it: the last this
+    // many samples before writePosition have been written (or zeroed) since, and
+    // anything older is zeroed by clearStaleHistory() just before it is read
+    int writtenHistory = 0;
+    
+    // Shared by every channel's filter and overwritten in place on cutoff changes
+    BiquadCoefficients<double> lowPassCoefficients;
+    BiquadDesignSlot lowPassDesigns;
+    bool designInBackground = true;
     
     float delayTimeMs = 250.0f;
-    float delayTimeInSamples = 0.0f;
-    float feedback = 0.3f;
-    float mix = 0.3f;
+    SmoothedParameter<float> delayTimeInSamples;
+    SmoothedParameter<float> feedback { 0.3f };
+    SmoothedParameter<float> mix { 0.3f };
     float lowPassCutoff = 8000.0f;
     
+    // Ramp state for the current sub-block
+    bool delayRamping = false;
+    bool feedbackRamping = false;
+    bool mixRamping = false;
+    float currentDelay = 0.0f;
+    float currentFeedback = 0.3f;
+    float currentMix = 0.3f;
+    
     double currentSampleRate = 44100.0;
+    double smoothingTimeSeconds = 0.02;
+    
+    // Channel kernel picked in configure()
+    ChannelLayout channelLayout = ChannelLayout::generic;
+    
+    // Holds the state when the node is prepared on its own rather than laid out by its owner
+    StateArena ownState;
+    
+    /** Zeroes, on every channel, the stale history the next numSamples samples
+        can read at the sub-block's delay times. */
+    void clearStaleHistory(int numSamples) noexcept;
     
     /** Updates the delay time in samples based on current sample rate. */
     void updateDelayTime();
     
-    /** Updates the low-pass filter coefficients. */
-    void updateLowPassFilter();
+    /** Updates the low-pass filter coefficients, on the background thread
+        unless designHere is true. */
+    void updateLowPassFilter(bool designHere);
     
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(DelayNode)
 };
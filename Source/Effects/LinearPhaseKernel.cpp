@@ -0,0 +1,144 @@
+/*
+  ==============================================================================
+
+    LinearPhaseKernel.cpp
+
+  ==============================================================================
+*/
+
+#include "LinearPhaseKernel.h"
+#include <algorithm>
+#include <complex>
+
+//==============================================================================
+void LinearPhaseWorkspace::prepare(int firLength, int partitionSize)
+{
+    if (firLength == preparedFirLength && partitionSize == preparedPartitionSize)
+        return;
+
+    // juce::dsp::FFT takes its size as a power of two. The partitions are
+    // transformed at twice their length, and real transforms need twice the room.
+    impulseFFT = std::make_unique<juce::dsp::FFT>(juce::roundToInt(std::log2(firLength)));
+    partitionFFT = std::make_unique<juce::dsp::FFT>(juce::roundToInt(std::log2(partitionSize * 2)));
+    impulse.assign(static_cast<size_t>(firLength) * 2, 0.0f);
+    partition.assign(static_cast<size_t>(partitionSize) * 4, 0.0f);
+
+    preparedFirLength = firLength;
+    preparedPartitionSize = partitionSize;
+}
+
+void LinearPhaseWorkspace::design(const LinearPhaseDesign& design, juce::dsp::Complex<float>* spectra) noexcept
+{
+    jassert(design.firLength == preparedFirLength && design.partitionSize == preparedPartitionSize);
+
+    const int firLength = design.firLength;
+    const int partitionSize = design.partitionSize;
+    constexpr double twoPi = juce::MathConstants<double>::twoPi;
+
+    std::array<BiquadCoefficients<double>, LinearPhaseDesign::maxSections> sections;
+
+    for (size_t section = 0; section < static_cast<size_t>(design.numSections); ++section)
+        sections[section] = design.sections[section].makeCoefficients();
+
+    // The cascade's magnitude at every bin, with the phase of a delay of half the
+    // length, (-1)^bin - so the impulse comes out centred and symmetric
+    for (int bin = 0; bin <= firLength / 2; ++bin)
+    {
+        const auto z1 = std::polar(1.0, -twoPi * static_cast<double>(bin) / static_cast<double>(firLength));
+        const auto z2 = z1 * z1;
+        double magnitude = 1.0;
+
+        for (size_t section = 0; section < static_cast<size_t>(design.numSections); ++section)
+        {
+            const auto& c = sections[section].values;
+            magnitude *= std::abs((c[0] + c[1] * z1 + c[2] * z2) / (1.0 + c[3] * z1 + c[4] * z2));
+        }
+
+        impulse[static_cast<size_t>(bin) * 2] = static_cast<float>((bin & 1) != 0 ? -magnitude : magnitude);
+        impulse[static_cast<size_t>(bin) * 2 + 1] = 0.0f;
+    }
+
+    impulseFFT->performRealOnlyInverseTransform(impulse.data());
+
+    // A Hann window over the whole length tapers the truncated response to zero at both ends
+    for (int tap = 0; tap < firLength; ++tap)
+        impulse[static_cast<size_t>(tap)] *= static_cast<float>(0.5 - 0.5 * std::cos(twoPi * static_cast<double>(tap) / static_cast<double>(firLength)));
+
+    const auto numBins = static_cast<size_t>(design.getNumBins());
+
+    for (int index = 0; index < design.getNumPartitions(); ++index)
+    {
+        const auto* taps = impulse.data() + static_cast<size_t>(index) * static_cast<size_t>(partitionSize);
+
+        std::fill(partition.begin(), partition.end(), 0.0f);
+        std::copy(taps, taps + partitionSize, partition.begin());
+        partitionFFT->performRealOnlyForwardTransform(partition.data(), true);
+
+        const auto* bins = reinterpret_cast<const juce::dsp::Complex<float>*>(partition.data());
+        std::copy(bins, bins + numBins, spectra + static_cast<size_t>(index) * numBins);
+    }
+}
+
+//==============================================================================
+LinearPhaseKernelSlot::LinearPhaseKernelSlot()
+    : designer(BiquadDesigner::getInstance())
+{
+}
+
+LinearPhaseKernelSlot::~LinearPhaseKernelSlot()
+{
+    designer->removeSlot(*this);
+}
+
+void LinearPhaseKernelSlot::prepare(int firLength, int partitionSize)
+{
+    ownerWorkspace.prepare(firLength, partitionSize);
+}
+
+void LinearPhaseKernelSlot::request(const LinearPhaseDesign& design) noexcept
+{
+    auto& pending = requests.getWriteBuffer();
+    pending.design = design;
+    pending.serial = ++lastSerial;
+    requests.publish();
+
+    designer->post(*this);
+}
+
+void LinearPhaseKernelSlot::design(const LinearPhaseDesign& design, juce::dsp::Complex<float>* spectra) noexcept
+{
+    appliedSerial = ++lastSerial;
+    ownerWorkspace.design(design, spectra);
+}
+
+bool LinearPhaseKernelSlot::fetch() noexcept
+{
+    if (! results.fetch())
+        return false;
+
+    // A result overtaken by design() on this thread is dropped
+    if (results.read().serial <= appliedSerial)
+        return false;
+
+    appliedSerial = results.read().serial;
+    return true;
+}
+
+void LinearPhaseKernelSlot::designRequest() noexcept
+{
+    if (! requests.fetch())
+        return;
+
+    // This thread may allocate, so its workspace and results follow whatever size is asked for
+    const auto& request = requests.read();
+    auto& result = results.getWriteBuffer();
+
+    designerWorkspace.prepare(request.design.firLength, request.design.partitionSize);
+    result.spectra.resize(request.design.getSpectraSize());
+
+    designerWorkspace.design(request.design, result.spectra.data());
+    result.firLength = request.design.firLength;
+    result.partitionSize = request.design.partitionSize;
+    result.serial = request.serial;
+    results.publish();
+}
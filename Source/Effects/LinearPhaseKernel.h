@@ -0,0 +1,153 @@
+/*
+  ==============================================================================
+
+    LinearPhaseKernel.h
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <juce_dsp/juce_dsp.h>
+#include <juce_core/juce_core.h>
+#include <array>
+#include <cstdint>
+#include <memory>
+#include <vector>
+#include "BiquadDesigner.h"
+#include "../TripleBuffer.h"
+
+//==============================================================================
+/**
+    The settings a linear-phase kernel is built from: the biquads whose combined
+    magnitude response it reproduces with no phase shift, and its size. With no
+    sections at all the kernel is a plain delay.
+
+    A kernel is firLength taps long with its centre at firLength / 2, and is
+    kept as the spectra of its uniform partitions: partition p covers taps
+    [p * partitionSize, (p + 1) * partitionSize), zero-padded to twice that
+    length, and keeps the partitionSize + 1 bins of non-negative frequency.
+*/
+struct LinearPhaseDesign
+{
+    /** The most sections one kernel can be built from. */
+    static constexpr int maxSections = 32;
+
+    std::array<BiquadDesign, maxSections> sections;
+    int numSections = 0;
+    int firLength = 0;          // a power of two
+    int partitionSize = 0;      // a power of two that divides firLength
+
+    int getNumPartitions() const noexcept { return firLength / partitionSize; }
+    int getNumBins() const noexcept { return partitionSize + 1; }
+
+    /** The number of bins a whole kernel's partitions take together. */
+    size_t getSpectraSize() const noexcept
+    {
+        return static_cast<size_t>(getNumPartitions()) * static_cast<size_t>(getNumBins());
+    }
+};
+
+//==============================================================================
+/**
+    The FFTs and scratch a kernel design needs, sized for one FIR length and
+    partition size. Every thread that designs kernels has a workspace of its own.
+*/
+class LinearPhaseWorkspace
+{
+public:
+    //==============================================================================
+    LinearPhaseWorkspace() = default;
+
+    /** Sizes the workspace. Allocates unless it is already the right size. */
+    void prepare(int firLength, int partitionSize);
+
+    /** Builds the kernel and writes its partitions' spectra, design.getSpectraSize()
+        bins in all. The workspace must have been prepared for the design's size. */
+    void design(const LinearPhaseDesign& design, juce::dsp::Complex<float>* spectra) noexcept;
+
+private:
+    //==============================================================================
+    std::unique_ptr<juce::dsp::FFT> impulseFFT;
+    std::unique_ptr<juce::dsp::FFT> partitionFFT;
+    std::vector<float> impulse;
+    std::vector<float> partition;
+    int preparedFirLength = 0;
+    int preparedPartitionSize = 0;
+
+    JUCE_DECLARE_NON_COPYABLE(LinearPhaseWorkspace)
+};
+
+//==============================================================================
+/**
+    One linear-phase filter's link to the shared background designer, working
+    like BiquadDesignSlot: request() hands a design over without blocking,
+    fetch() picks up the newest finished kernel, and design() builds one on the
+    calling thread instead, superseding anything still in flight.
+
+    Only the designer thread ever allocates for a request; the owner's own
+    workspace is sized up front by prepare().
+*/
+class LinearPhaseKernelSlot : public BackgroundDesignSlot
+{
+public:
+    //==============================================================================
+    /** Holds on to the designer, starting it if this is the first slot. */
+    LinearPhaseKernelSlot();
+
+    /** Removes any request still queued. The designer stops with the last slot. */
+    ~LinearPhaseKernelSlot() override;
+
+    //==============================================================================
+    /** Sizes the workspace design() uses. Call before design(), off the audio thread. */
+    void prepare(int firLength, int partitionSize);
+
+    /** Hands a design to the background thread without blocking. */
+    void request(const LinearPhaseDesign& design) noexcept;
+
+    /** Designs on the calling thread into spectra, superseding any earlier request. */
+    void design(const LinearPhaseDesign& design, juce::dsp::Complex<float>* spectra) noexcept;
+
+    /** Picks up the newest finished request. Returns false if there is none, or
+        if design() has been called since it was requested. */
+    bool fetch() noexcept;
+
+    /** The kernel picked up by the last fetch() that returned true... */
+    const juce::dsp::Complex<float>* getSpectra() const noexcept { return results.read().spectra.data(); }
+
+    /** ...and the sizes it was designed for, which may be out of date. */
+    int getFirLength() const noexcept { return results.read().firLength; }
+    int getPartitionSize() const noexcept { return results.read().partitionSize; }
+
+private:
+    //==============================================================================
+    struct Request
+    {
+        LinearPhaseDesign design;
+        std::uint64_t serial = 0;
+    };
+
+    struct Result
+    {
+        std::vector<juce::dsp::Complex<float>> spectra;
+        int firLength = 0;
+        int partitionSize = 0;
+        std::uint64_t serial = 0;
+    };
+
+    TripleBuffer<Request> requests;
+    TripleBuffer<Result> results;
+    std::shared_ptr<BiquadDesigner> designer;
+
+    LinearPhaseWorkspace ownerWorkspace;
+    LinearPhaseWorkspace designerWorkspace;
+
+    // Owner thread only, as in BiquadDesignSlot
+    std::uint64_t lastSerial = 0;
+    std::uint64_t appliedSerial = 0;
+
+    /** Designer thread: designs the newest request, if there is one. */
+    void designRequest() noexcept override;
+
+    JUCE_DECLARE_NON_COPYABLE(LinearPhaseKernelSlot)
+};
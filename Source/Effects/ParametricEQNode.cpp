@@ -0,0 +1,1054 @@
+/*
+  ==============================================================================
+
+    ParametricEQNode.cpp
+
+  ==============================================================================
+*/
+
+#include "ParametricEQNode.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <type_traits>
+
+//==============================================================================
+template<typename SampleType>
+ParametricEQNode<SampleType>::ParametricEQNode()
+{
+    // Every band starts out off, and its sections flat and bypassed
+}
+
+//==============================================================================
+template<typename SampleType>
+void ParametricEQNode<SampleType>::prepare(const juce::dsp::ProcessSpec& spec)
+{
+    configure(spec);
+    ownState.build([this](StateArena::Layout& layout) { layOutState(layout); });
+    reset();
+}
+
+template<typename SampleType>
+void ParametricEQNode<SampleType>::configure(const juce::dsp::ProcessSpec& spec)
+{
+    currentSampleRate = spec.sampleRate;
+    numChannels = static_cast<size_t>(spec.numChannels);
+    topology = requestedTopology;
+    numBands = requestedNumBands;
+    numSectionSlots = static_cast<size_t>(numBands * maxSectionsPerBand);
+
+    // Channels share the lanes one apiece, even when there are too few to fill
+    // them: a spare lane costs less than running each channel on its own
+    channelGroupSize = numChannels > 1 ? ChannelLanes::SIMDNumElements : 1;
+
+    if (topology == Topology::linearPhase)
+    {
+        // The kernel covers a fixed time, so the partitions grow with the sample rate
+        const int firLength = juce::nextPowerOfTwo(static_cast<int>(std::ceil(currentSampleRate * linearPhaseLengthSeconds)));
+        const int partitionSize = juce::jmax(1, firLength / linearPhasePartitions);
+
+        if (partitionFFT == nullptr || partitionSize != kernelDesign.partitionSize)
+            partitionFFT = std::make_unique<juce::dsp::FFT>(juce::roundToInt(std::log2(partitionSize * 2)));
+
+        kernelDesign.firLength = firLength;
+        kernelDesign.partitionSize = partitionSize;
+        kernelDesigns.prepare(firLength, partitionSize);
+        kernelFadeRemaining = 0;
+        kernelDirty = false;
+    }
+
+    // Start on the current settings with no ramp, designed here for the new sample rate
+    updateAllBands(true);
+}
+
+template<typename SampleType>
+void ParametricEQNode<SampleType>::layOutState(StateArena::Layout& layout)
+{
+    // One filter state per channel and section slot, each run against the section's shared coefficients
+    biquadStates = layout.take<BiquadState<SampleType>>(numChannels * numSectionSlots);
+    svfStates = layout.take<SvfState<SampleType>>(numChannels * numSectionSlots);
+
+    if (topology != Topology::linearPhase)
+    {
+        blockInputs = nullptr;
+        blockOutputs = nullptr;
+        inputSpectra = nullptr;
+        currentKernel = nullptr;
+        nextKernel = nullptr;
+        transformScratch = nullptr;
+        fadeScratch = nullptr;
+        alongsideLines = nullptr;
+        return;
+    }
+
+    // Each channel's two blocks of input, one of output and its ring of block spectra,
+    // then the two kernels shared by every channel and the transforms' scratch
+    const auto partitionSize = static_cast<size_t>(kernelDesign.partitionSize);
+    const auto spectraSize = kernelDesign.getSpectraSize();
+
+    blockInputs = layout.take<float>(numChannels * partitionSize * 2);
+    blockOutputs = layout.take<float>(numChannels * partitionSize);
+    inputSpectra = layout.take<juce::dsp::Complex<float>>(numChannels * spectraSize);
+    currentKernel = layout.take<juce::dsp::Complex<float>>(spectraSize);
+    nextKernel = layout.take<juce::dsp::Complex<float>>(spectraSize);
+    transformScratch = layout.take<float>(partitionSize * 4);
+    fadeScratch = layout.take<float>(partitionSize * 4);
+    alongsideLines = layout.take<SampleType>(numChannels * static_cast<size_t>(getLatencySamples()));
+}
+
+template<typename SampleType>
+void ParametricEQNode<SampleType>::reset()
+{
+    // Reset all filters
+    const auto numStates = numChannels * numSectionSlots;
+    std::fill(biquadStates, biquadStates + numStates, BiquadState<SampleType>());
+    std::fill(svfStates, svfStates + numStates, SvfState<SampleType>());
+
+    // Flat sections have nothing left to settle
+    for (size_t index = 0; index < numSectionSlots; ++index)
+        if (isSectionFlat(sections[index]))
+            bypassSection(sections[index]);
+
+    updateActiveSections();
+
+    if (topology != Topology::linearPhase)
+        return;
+
+    const auto partitionSize = static_cast<size_t>(kernelDesign.partitionSize);
+    const auto spectraSize = kernelDesign.getSpectraSize();
+
+    std::fill(blockInputs, blockInputs + numChannels * partitionSize * 2, 0.0f);
+    std::fill(blockOutputs, blockOutputs + numChannels * partitionSize, 0.0f);
+    std::fill(inputSpectra, inputSpectra + numChannels * spectraSize, juce::dsp::Complex<float>());
+    std::fill(alongsideLines, alongsideLines + numChannels * static_cast<size_t>(getLatencySamples()), SampleType());
+    blockPosition = 0;
+    newestSpectrum = 0;
+    alongsidePosition = 0;
+
+    // Land on a kernel that was fading in, and build one here if the settings were snapped
+    if (kernelFadeRemaining > 0)
+    {
+        std::swap(currentKernel, nextKernel);
+        kernelFadeRemaining = 0;
+    }
+
+    if (kernelSnap)
+    {
+        kernelDesigns.design(makeKernelDesign(), currentKernel);
+        kernelSnap = false;
+        kernelDirty = false;
+    }
+}
+
+template<typename SampleType>
+void ParametricEQNode<SampleType>::copyChannelState(size_t sourceChannel, size_t destChannel) noexcept
+{
+    auto copyRegion = [sourceChannel, destChannel](auto* region, size_t channelSize)
+    {
+        std::copy(region + sourceChannel * channelSize, region + (sourceChannel + 1) * channelSize, region + destChannel * channelSize);
+    };
+
+    copyRegion(biquadStates, numSectionSlots);
+    copyRegion(svfStates, numSectionSlots);
+
+    if (topology != Topology::linearPhase)
+        return;
+
+    const auto partitionSize = static_cast<size_t>(kernelDesign.partitionSize);
+    copyRegion(blockInputs, partitionSize * 2);
+    copyRegion(blockOutputs, partitionSize);
+    copyRegion(inputSpectra, kernelDesign.getSpectraSize());
+    copyRegion(alongsideLines, static_cast<size_t>(getLatencySamples()));
+}
+
+//==============================================================================
+template<typename SampleType>
+void ParametricEQNode<SampleType>::setNumBands(int newNumBands) noexcept
+{
+    requestedNumBands = juce::jlimit(0, maxBands, newNumBands);
+}
+
+template<typename SampleType>
+void ParametricEQNode<SampleType>::setBandType(int band, BandType newType)
+{
+    jassert(juce::isPositiveAndBelow(band, maxBands));
+    bandSettings[static_cast<size_t>(band)].type = newType;
+    updateBand(band);
+}
+
+template<typename SampleType>
+void ParametricEQNode<SampleType>::setBandFrequency(int band, float freqHz)
+{
+    jassert(juce::isPositiveAndBelow(band, maxBands));
+    bandSettings[static_cast<size_t>(band)].frequency = juce::jlimit(20.0f, 20000.0f, freqHz);
+    updateBand(band);
+}
+
+template<typename SampleType>
+void ParametricEQNode<SampleType>::setBandGain(int band, float gainDb)
+{
+    jassert(juce::isPositiveAndBelow(band, maxBands));
+    bandSettings[static_cast<size_t>(band)].gain = juce::jlimit(-24.0f, 24.0f, gainDb);
+    updateBand(band);
+}
+
+template<typename SampleType>
+void ParametricEQNode<SampleType>::setBandQ(int band, float qValue)
+{
+    jassert(juce::isPositiveAndBelow(band, maxBands));
+    bandSettings[static_cast<size_t>(band)].q = juce::jlimit(0.1f, 10.0f, qValue);
+    updateBand(band);
+}
+
+template<typename SampleType>
+void ParametricEQNode<SampleType>::setBandSlope(int band, CutSlope newSlope)
+{
+    jassert(juce::isPositiveAndBelow(band, maxBands));
+    bandSettings[static_cast<size_t>(band)].slope = newSlope;
+    updateBand(band);
+}
+
+template<typename SampleType>
+void ParametricEQNode<SampleType>::setSmoothingTime(double seconds)
+{
+    // Only ramps started from now on take the new length
+    smoothingTimeSeconds = seconds;
+}
+
+template<typename SampleType>
+void ParametricEQNode<SampleType>::setDesignInBackground(bool shouldDesignInBackground)
+{
+    if (shouldDesignInBackground == designInBackground)
+        return;
+
+    designInBackground = shouldDesignInBackground;
+
+    // Take over any designs still in flight, so they land now rather than whenever they come back
+    if (! designInBackground)
+        updateAllBands(false);
+}
+
+template<typename SampleType>
+void ParametricEQNode<SampleType>::setBypassed(bool shouldBeBypassed) noexcept
+{
+    if (shouldBeBypassed == bypassed)
+        return;
+
+    bypassed = shouldBeBypassed;
+
+    if (topology == Topology::linearPhase)
+        kernelDirty = true;
+}
+
+template<typename SampleType>
+int ParametricEQNode<SampleType>::getLatencySamples() const noexcept
+{
+    // Half the kernel, plus the block it waits for before it is convolved
+    if (topology == Topology::linearPhase)
+        return kernelDesign.firLength / 2 + kernelDesign.partitionSize;
+
+    return 0;
+}
+
+template<typename SampleType>
+template<typename BlockSampleType>
+void ParametricEQNode<SampleType>::delayAlongside(const juce::dsp::AudioBlock<BlockSampleType>& block) noexcept
+{
+    if (topology != Topology::linearPhase)
+        return;
+
+    const auto lineLength = static_cast<size_t>(getLatencySamples());
+    const auto numBlockChannels = juce::jmin(block.getNumChannels(), numChannels);
+    const auto numSamples = block.getNumSamples();
+
+    size_t start = 0;
+
+    while (start < numSamples)
+    {
+        // Each sample swaps places with the one written a whole line earlier
+        const auto position = static_cast<size_t>(alongsidePosition);
+        const auto length = juce::jmin(numSamples - start, lineLength - position);
+
+        for (size_t channel = 0; channel < numBlockChannels; ++channel)
+        {
+            auto* data = block.getChannelPointer(channel) + start;
+            auto* line = alongsideLines + channel * lineLength + position;
+
+            for (size_t sample = 0; sample < length; ++sample)
+            {
+                const auto input = data[sample];
+                data[sample] = static_cast<BlockSampleType>(line[sample]);
+                line[sample] = static_cast<SampleType>(input);
+            }
+        }
+
+        start += length;
+        alongsidePosition = static_cast<int>((position + length) % lineLength);
+    }
+
+    // As in processLinearPhase(), channels with no line are silenced
+    for (size_t channel = numBlockChannels; channel < block.getNumChannels(); ++channel)
+        block.getSingleChannelBlock(channel).clear();
+}
+
+template<typename SampleType>
+double ParametricEQNode<SampleType>::getTailLengthSeconds(float silenceLevel) const
+{
+    // The kernel ends a fixed time after its input, once the last block is out
+    if (topology == Topology::linearPhase)
+        return static_cast<double>(kernelDesign.firLength + kernelDesign.partitionSize * 2) / currentSampleRate;
+
+    // A second-order section decays with time constant Q / (pi * f)
+    const double decayTimeConstants = -std::log(static_cast<double>(silenceLevel));
+    double longest = 0.0;
+
+    for (int band = 0; band < numBands; ++band)
+    {
+        for (int index = 0; index < getNumBandSections(bandSettings[static_cast<size_t>(band)]); ++index)
+        {
+            const auto design = getSectionDesign(band, index);
+            longest = juce::jmax(longest, decayTimeConstants * design.q / (juce::MathConstants<double>::pi * design.frequency));
+        }
+    }
+
+    return longest;
+}
+
+template<typename SampleType>
+bool ParametricEQNode<SampleType>::isAnySectionRamping() const noexcept
+{
+    for (size_t index = 0; index < numSectionSlots; ++index)
+        if (sections[index].rampRemaining > 0)
+            return true;
+
+    return false;
+}
+
+//==============================================================================
+template<typename SampleType>
+int ParametricEQNode<SampleType>::getNumBandSections(const BandSettings& settings) noexcept
+{
+    switch (settings.type)
+    {
+        case BandType::off:
+            return 0;
+        case BandType::highPass:
+        case BandType::lowPass:
+            return settings.slope == CutSlope::dB48 ? 4 : (settings.slope == CutSlope::dB24 ? 2 : 1);
+        default:
+            return 1;
+    }
+}
+
+template<typename SampleType>
+BiquadDesign ParametricEQNode<SampleType>::getSectionDesign(const BandSettings& settings, int index, double sampleRate) noexcept
+{
+    using Shape = BiquadDesign::Shape;
+
+    const double frequency = juce::jmin(static_cast<double>(settings.frequency), sampleRate * 0.49);
+    const double gain = juce::Decibels::decibelsToGain(static_cast<double>(settings.gain));
+    const double q = static_cast<double>(settings.q);
+    const int numBandSections = getNumBandSections(settings);
+
+    // Sections the band does not use sit at unity
+    if (index >= numBandSections)
+        return { Shape::peak, sampleRate, frequency, 0.707, 1.0 };
+
+    switch (settings.type)
+    {
+        case BandType::lowShelf:
+            return { Shape::lowShelf, sampleRate, frequency, q, gain };
+        case BandType::highShelf:
+            return { Shape::highShelf, sampleRate, frequency, q, gain };
+        case BandType::highPass:
+        case BandType::lowPass:
+        {
+            // A Butterworth cut of order 2n is n sections with their poles spread
+            // evenly around the circle, the gentlest first
+            const double order = static_cast<double>(numBandSections * 2);
+            const double angle = juce::MathConstants<double>::pi * static_cast<double>(index * 2 + 1) / (order * 2.0);
+            const double sectionQ = 1.0 / (2.0 * std::cos(angle));
+            const auto shape = settings.type == BandType::highPass ? Shape::highPassSection : Shape::lowPassSection;
+            return { shape, sampleRate, frequency, sectionQ, 1.0 };
+        }
+        case BandType::peak:
+        case BandType::off:
+        default:
+            return { Shape::peak, sampleRate, frequency, q, gain };
+    }
+}
+
+template<typename SampleType>
+void ParametricEQNode<SampleType>::updateSection(Section& section, const BiquadDesign& design)
+{
+    if (currentSampleRate <= 0.0)
+        return;
+
+    // Sections already on their way to flat stay as they are, so unused ones cost nothing
+    const bool flat = isFlat(design);
+
+    if (flat && section.requestedFlat)
+        return;
+
+    section.requested = design;
+    section.requestedFlat = flat;
+
+    if (topology == Topology::linearPhase)
+        kernelDirty = true;
+    else if (topology == Topology::stateVariable)
+        startGlide(section, design);
+    else if (designInBackground)
+        section.designs.request(design);
+    else
+        startRamp(section, section.designs.design(design));
+}
+
+template<typename SampleType>
+void ParametricEQNode<SampleType>::snapSection(Section& section, const BiquadDesign& design)
+{
+    if (currentSampleRate <= 0.0)
+        return;
+
+    section.requested = design;
+    section.requestedFlat = isFlat(design);
+
+    // The kernel is built from every section at once, by the next reset()
+    if (topology == Topology::linearPhase)
+    {
+        kernelSnap = true;
+        return;
+    }
+
+    if (topology == Topology::stateVariable)
+    {
+        section.rampRemaining = 0;
+        section.svfTarget = design;
+        section.svfDesign = design;
+        includeSection(section);
+        designSvfSection(section);
+        return;
+    }
+
+    section.current = section.designs.design(design);
+    section.coefficients = section.current;
+    section.rampRemaining = 0;
+    includeSection(section);
+    beginSettling(section);
+}
+
+template<typename SampleType>
+void ParametricEQNode<SampleType>::updateBand(int band)
+{
+    // Bands past the count have no state; they are designed when a prepare takes them in
+    if (band >= numBands)
+        return;
+
+    const auto firstSection = static_cast<size_t>(band * maxSectionsPerBand);
+
+    for (int index = 0; index < maxSectionsPerBand; ++index)
+        updateSection(sections[firstSection + static_cast<size_t>(index)], getSectionDesign(band, index));
+}
+
+template<typename SampleType>
+void ParametricEQNode<SampleType>::updateAllBands(bool snap)
+{
+    for (int band = 0; band < numBands; ++band)
+    {
+        const auto firstSection = static_cast<size_t>(band * maxSectionsPerBand);
+
+        for (int index = 0; index < maxSectionsPerBand; ++index)
+        {
+            auto& section = sections[firstSection + static_cast<size_t>(index)];
+            const auto design = getSectionDesign(band, index);
+
+            if (snap)
+            {
+                snapSection(section, design);
+            }
+            else
+            {
+                // Hand a section with a design still in flight over again, even if
+                // nothing has changed, so the design is superseded
+                if (section.designs.isPending())
+                    section.requestedFlat = false;
+
+                updateSection(section, design);
+            }
+        }
+    }
+}
+
+template<typename SampleType>
+void ParametricEQNode<SampleType>::startGlide(Section& section, const BiquadDesign& target) noexcept
+{
+    // Glide from wherever the section is now, even partway through an earlier glide
+    auto logSettings = [](const BiquadDesign& design) -> std::array<double, 3>
+    {
+        return { { std::log(design.frequency), std::log(design.q), std::log(juce::jmax(1.0e-6, design.gain)) } };
+    };
+
+    section.svfDesign.shape = target.shape;
+    section.svfDesign.sampleRate = target.sampleRate;
+    section.svfTarget = target;
+    section.glideStart = logSettings(section.svfDesign);
+    section.glideTarget = logSettings(target);
+    section.rampLength = juce::roundToInt(smoothingTimeSeconds * currentSampleRate);
+    section.rampRemaining = section.rampLength;
+    section.settleRemaining = 0;
+    includeSection(section);
+
+    if (section.rampLength <= 0)
+    {
+        section.svfDesign = target;
+        designSvfSection(section);
+    }
+}
+
+template<typename SampleType>
+void ParametricEQNode<SampleType>::designSvfSection(Section& section) noexcept
+{
+    section.svfCurrent = section.svfDesign.makeSvfCoefficients();
+    section.svfCoefficients = section.svfCurrent;
+
+    // A flat SVF's output does not depend on its state, so it can drop out at the
+    // next sub-block instead of waiting for the state to die away
+    section.settleRemaining = isSectionFlat(section) ? 1 : 0;
+}
+
+template<typename SampleType>
+void ParametricEQNode<SampleType>::updateActiveSections() noexcept
+{
+    numActiveSections = 0;
+
+    for (size_t index = 0; index < numSectionSlots; ++index)
+        if (! sections[index].bypassed)
+            activeSections[numActiveSections++] = static_cast<int>(index);
+
+    activeSectionsChanged = false;
+}
+
+template<typename SampleType>
+void ParametricEQNode<SampleType>::beginSettling(Section& section) noexcept
+{
+    section.settleRemaining = isUnity(section.current) ? getSettleSamples(section.current) : 0;
+}
+
+template<typename SampleType>
+void ParametricEQNode<SampleType>::bypassSection(Section& section) noexcept
+{
+    const auto index = static_cast<size_t>(&section - sections.data());
+
+    for (size_t channel = 0; channel < numChannels; ++channel)
+    {
+        getChannelStates<BiquadState>(channel)[index].reset();
+        getChannelStates<SvfState>(channel)[index].reset();
+    }
+
+    section.settleRemaining = 0;
+    activeSectionsChanged = activeSectionsChanged || ! section.bypassed;
+    section.bypassed = true;
+}
+
+template<typename SampleType>
+bool ParametricEQNode<SampleType>::isUnity(const BiquadCoefficients<double>& coefficients) noexcept
+{
+    // A shelf or peak at 0 dB has matching numerator and denominator
+    constexpr double tolerance = 1.0e-12;
+    const auto& values = coefficients.values;
+
+    return std::abs(values[0] - 1.0) < tolerance
+        && std::abs(values[1] - values[3]) < tolerance
+        && std::abs(values[2] - values[4]) < tolerance;
+}
+
+template<typename SampleType>
+bool ParametricEQNode<SampleType>::isUnity(const SvfCoefficients<double>& coefficients) noexcept
+{
+    // At 0 dB the band and low outputs are mixed in at zero, leaving the input alone
+    constexpr double tolerance = 1.0e-12;
+    const auto& values = coefficients.values;
+
+    return std::abs(values[3] - 1.0) < tolerance
+        && std::abs(values[4]) < tolerance
+        && std::abs(values[5]) < tolerance;
+}
+
+template<typename SampleType>
+bool ParametricEQNode<SampleType>::isFlat(const BiquadDesign& design) noexcept
+{
+    using Shape = BiquadDesign::Shape;
+
+    const bool hasGain = design.shape == Shape::peak || design.shape == Shape::lowShelf || design.shape == Shape::highShelf;
+    return hasGain && design.gain == 1.0;
+}
+
+template<typename SampleType>
+bool ParametricEQNode<SampleType>::isSectionFlat(const Section& section) const noexcept
+{
+    if (section.rampRemaining > 0)
+        return false;
+
+    return topology == Topology::stateVariable ? isUnity(section.svfCurrent) : isUnity(section.current);
+}
+
+template<typename SampleType>
+int ParametricEQNode<SampleType>::getSettleSamples(const BiquadCoefficients<double>& coefficients) noexcept
+{
+    // The state decays as the larger pole radius to the power of the sample count
+    const double a1 = coefficients.values[3];
+    const double a2 = coefficients.values[4];
+    const double discriminant = a1 * a1 - 4.0 * a2;
+
+    double radius = 0.0;
+
+    if (discriminant < 0.0)
+        radius = std::sqrt(a2);
+    else
+        radius = (std::abs(a1) + std::sqrt(discriminant)) * 0.5;
+
+    // Never bypass a section that would not settle
+    if (radius >= 1.0)
+        return std::numeric_limits<int>::max();
+
+    if (radius <= 0.0)
+        return 1;
+
+    const double samples = std::ceil(std::log(settleLevel) / std::log(radius));
+    return static_cast<int>(juce::jlimit(1.0, static_cast<double>(std::numeric_limits<int>::max()), samples));
+}
+
+//==============================================================================
+template<typename SampleType>
+template<template<typename> class SectionState, typename ProcessContext>
+void ParametricEQNode<SampleType>::processCascade(const ProcessContext& context, size_t start, size_t numSamples) noexcept
+{
+    using BlockSampleType = typename ProcessContext::SampleType;
+    constexpr size_t numLanes = ChannelLanes::SIMDNumElements;
+
+    auto& inputBlock = context.getInputBlock();
+    auto& outputBlock = context.getOutputBlock();
+
+    if (numActiveSections == 0)
+    {
+        if (context.usesSeparateInputAndOutputBlocks())
+            outputBlock.getSubBlock(start, numSamples).copyFrom(inputBlock.getSubBlock(start, numSamples));
+        return;
+    }
+
+    const auto numBlockChannels = outputBlock.getNumChannels();
+
+    // Every pass and section group works on the same stretch in SampleType, so the
+    // whole cascade keeps the node's precision whatever the block's
+    alignas(alignof(ChannelLanes)) SampleType buffer[interleaveLength * numLanes] {};
+
+    for (size_t firstChannel = 0; firstChannel < numBlockChannels; firstChannel += channelGroupSize)
+    {
+        const auto numGroupChannels = juce::jmin(channelGroupSize, numBlockChannels - firstChannel);
+        const auto bufferLanes = numGroupChannels == 1 ? size_t(1) : numLanes;
+
+        for (size_t offset = 0; offset < numSamples; offset += interleaveLength)
+        {
+            const auto length = juce::jmin(interleaveLength, numSamples - offset);
+
+            // The channels are interleaved, so each sample is one aligned load; lanes
+            // past the last channel just filter silence
+            for (size_t lane = 0; lane < numGroupChannels; ++lane)
+            {
+                const auto* input = inputBlock.getChannelPointer(firstChannel + lane) + start + offset;
+
+                for (size_t sample = 0; sample < length; ++sample)
+                    buffer[sample * bufferLanes + lane] = static_cast<SampleType>(input[sample]);
+            }
+
+            if (numGroupChannels > 1)
+                runPasses<SectionState, ChannelLanes>(firstChannel, numGroupChannels, buffer, length);
+            else
+                runPasses<SectionState, SampleType>(firstChannel, numGroupChannels, buffer, length);
+
+            for (size_t lane = 0; lane < numGroupChannels; ++lane)
+            {
+                auto* output = outputBlock.getChannelPointer(firstChannel + lane) + start + offset;
+
+                for (size_t sample = 0; sample < length; ++sample)
+                    output[sample] = static_cast<BlockSampleType>(buffer[sample * bufferLanes + lane]);
+            }
+        }
+    }
+}
+
+template<typename SampleType>
+template<template<typename> class SectionState, typename LaneType>
+void ParametricEQNode<SampleType>::runPasses(size_t firstChannel, size_t numGroupChannels, SampleType* buffer, size_t length) noexcept
+{
+    // Each pass is unrolled for its number of sections
+    for (size_t first = 0; first < numActiveSections; first += maxSectionsPerPass)
+    {
+        const auto* passSections = activeSections.data() + first;
+
+        switch (juce::jmin(maxSectionsPerPass, numActiveSections - first))
+        {
+            case 1:  runPass<SectionState, LaneType, 1>(passSections, firstChannel, numGroupChannels, buffer, length); break;
+            case 2:  runPass<SectionState, LaneType, 2>(passSections, firstChannel, numGroupChannels, buffer, length); break;
+            case 3:  runPass<SectionState, LaneType, 3>(passSections, firstChannel, numGroupChannels, buffer, length); break;
+            default: runPass<SectionState, LaneType, 4>(passSections, firstChannel, numGroupChannels, buffer, length); break;
+        }
+    }
+}
+
+template<typename SampleType>
+template<template<typename> class SectionState, typename LaneType, size_t NumActive>
+void ParametricEQNode<SampleType>::runPass(const int* passSections, size_t firstChannel, size_t numGroupChannels,
+                                           SampleType* buffer, size_t length) noexcept
+{
+    constexpr bool singleChannel = std::is_same<LaneType, SampleType>::value;
+    constexpr size_t numLanes = sizeof(LaneType) / sizeof(SampleType);
+    constexpr size_t numCoefficients = SectionState<SampleType>::numCoefficients;
+
+    // Copy the coefficients and state into locals, so nothing written to the
+    // buffer can alias them and they stay in registers for the whole pass
+    std::array<std::array<LaneType, numCoefficients>, NumActive> coefficients;
+    std::array<SectionState<LaneType>, NumActive> states;
+
+    for (size_t index = 0; index < NumActive; ++index)
+    {
+        const auto section = static_cast<size_t>(passSections[index]);
+        const auto& sectionCoefficients = getSectionCoefficients<SectionState>(sections[section]);
+
+        for (size_t coefficient = 0; coefficient < numCoefficients; ++coefficient)
+        {
+            if constexpr (singleChannel)
+                coefficients[index][coefficient] = sectionCoefficients[coefficient];
+            else
+                coefficients[index][coefficient] = LaneType::expand(sectionCoefficients[coefficient]);
+        }
+
+        if constexpr (singleChannel)
+        {
+            states[index] = getChannelStates<SectionState>(firstChannel)[section];
+        }
+        else
+        {
+            alignas(alignof(LaneType)) SampleType s1[numLanes] {};
+            alignas(alignof(LaneType)) SampleType s2[numLanes] {};
+
+            for (size_t lane = 0; lane < numGroupChannels; ++lane)
+            {
+                const auto& state = getChannelStates<SectionState>(firstChannel + lane)[section];
+                s1[lane] = state.s1;
+                s2[lane] = state.s2;
+            }
+
+            states[index].s1 = LaneType::fromRawArray(s1);
+            states[index].s2 = LaneType::fromRawArray(s2);
+        }
+    }
+
+    for (size_t sample = 0; sample < length; ++sample)
+    {
+        if constexpr (singleChannel)
+        {
+            auto value = buffer[sample];
+
+            for (size_t index = 0; index < NumActive; ++index)
+                value = states[index].processSample(value, coefficients[index].data());
+
+            buffer[sample] = value;
+        }
+        else
+        {
+            auto value = LaneType::fromRawArray(buffer + sample * numLanes);
+
+            for (size_t index = 0; index < NumActive; ++index)
+                value = states[index].processSample(value, coefficients[index].data());
+
+            value.copyToRawArray(buffer + sample * numLanes);
+        }
+    }
+
+    for (size_t index = 0; index < NumActive; ++index)
+    {
+        const auto section = static_cast<size_t>(passSections[index]);
+
+        if constexpr (singleChannel)
+        {
+            getChannelStates<SectionState>(firstChannel)[section] = states[index];
+        }
+        else
+        {
+            alignas(alignof(LaneType)) SampleType s1[numLanes];
+            alignas(alignof(LaneType)) SampleType s2[numLanes];
+            states[index].s1.copyToRawArray(s1);
+            states[index].s2.copyToRawArray(s2);
+
+            for (size_t lane = 0; lane < numGroupChannels; ++lane)
+            {
+                auto& state = getChannelStates<SectionState>(firstChannel + lane)[section];
+                state.s1 = s1[lane];
+                state.s2 = s2[lane];
+            }
+        }
+    }
+}
+
+//==============================================================================
+template<typename SampleType>
+LinearPhaseDesign ParametricEQNode<SampleType>::makeKernelDesign() const noexcept
+{
+    auto design = kernelDesign;
+    design.numSections = 0;
+
+    // With no sections there is only a lone tap at the centre: the same delay, unfiltered
+    if (bypassed)
+        return design;
+
+    for (size_t index = 0; index < numSectionSlots; ++index)
+        if (! sections[index].requestedFlat)
+            design.sections[static_cast<size_t>(design.numSections++)] = sections[index].requested;
+
+    return design;
+}
+
+template<typename SampleType>
+void ParametricEQNode<SampleType>::startKernelFade() noexcept
+{
+    const double fadeBlocks = smoothingTimeSeconds * currentSampleRate / static_cast<double>(kernelDesign.partitionSize);
+    kernelFadeBlocks = juce::jmax(1, juce::roundToInt(fadeBlocks));
+    kernelFadeRemaining = kernelFadeBlocks;
+}
+
+template<typename SampleType>
+void ParametricEQNode<SampleType>::updateKernel() noexcept
+{
+    // One fade at a time: anything newer waits until the current one has finished
+    if (kernelFadeRemaining > 0)
+    {
+        if (kernelDirty && designInBackground)
+        {
+            kernelDesigns.request(makeKernelDesign());
+            kernelDirty = false;
+        }
+
+        return;
+    }
+
+    if (kernelDirty)
+    {
+        kernelDirty = false;
+
+        if (! designInBackground)
+        {
+            kernelDesigns.design(makeKernelDesign(), nextKernel);
+            startKernelFade();
+            return;
+        }
+
+        kernelDesigns.request(makeKernelDesign());
+    }
+
+    // A kernel designed for the sizes before the last configure() is dropped
+    if (designInBackground && kernelDesigns.fetch()
+        && kernelDesigns.getFirLength() == kernelDesign.firLength
+        && kernelDesigns.getPartitionSize() == kernelDesign.partitionSize)
+    {
+        const auto* spectra = kernelDesigns.getSpectra();
+        std::copy(spectra, spectra + kernelDesign.getSpectraSize(), nextKernel);
+        startKernelFade();
+    }
+}
+
+template<typename SampleType>
+void ParametricEQNode<SampleType>::convolveSpectra(const juce::dsp::Complex<float>* spectra, const juce::dsp::Complex<float>* kernel,
+                                                   float* result) noexcept
+{
+    const auto numBins = static_cast<size_t>(kernelDesign.getNumBins());
+    const int numPartitions = kernelDesign.getNumPartitions();
+
+    std::fill(result, result + numBins * 2, 0.0f);
+
+    // Written out on the floats rather than with std::complex, whose multiply
+    // checks for infinities and will not vectorise
+    for (int partition = 0; partition < numPartitions; ++partition)
+    {
+        const auto age = static_cast<size_t>((newestSpectrum + numPartitions - partition) % numPartitions);
+        const auto* input = reinterpret_cast<const float*>(spectra + age * numBins);
+        const auto* taps = reinterpret_cast<const float*>(kernel + static_cast<size_t>(partition) * numBins);
+
+        for (size_t bin = 0; bin < numBins * 2; bin += 2)
+        {
+            result[bin] += input[bin] * taps[bin] - input[bin + 1] * taps[bin + 1];
+            result[bin + 1] += input[bin] * taps[bin + 1] + input[bin + 1] * taps[bin];
+        }
+    }
+
+    partitionFFT->performRealOnlyInverseTransform(result);
+}
+
+template<typename SampleType>
+void ParametricEQNode<SampleType>::convolveBlock(size_t numBlockChannels) noexcept
+{
+    const auto partitionSize = static_cast<size_t>(kernelDesign.partitionSize);
+    const auto numBins = static_cast<size_t>(kernelDesign.getNumBins());
+    const auto spectraSize = kernelDesign.getSpectraSize();
+    const bool fading = kernelFadeRemaining > 0;
+
+    newestSpectrum = (newestSpectrum + 1) % kernelDesign.getNumPartitions();
+
+    for (size_t channel = 0; channel < numBlockChannels; ++channel)
+    {
+        auto* history = blockInputs + channel * partitionSize * 2;
+        auto* output = blockOutputs + channel * partitionSize;
+        auto* spectra = inputSpectra + channel * spectraSize;
+
+        // The last two blocks go in, so the second half of the result is clear of wrap-around
+        std::copy(history, history + partitionSize * 2, transformScratch);
+        partitionFFT->performRealOnlyForwardTransform(transformScratch, true);
+
+        const auto* bins = reinterpret_cast<const juce::dsp::Complex<float>*>(transformScratch);
+        std::copy(bins, bins + numBins, spectra + static_cast<size_t>(newestSpectrum) * numBins);
+        std::copy(history + partitionSize, history + partitionSize * 2, history);
+
+        convolveSpectra(spectra, currentKernel, transformScratch);
+
+        if (! fading)
+        {
+            std::copy(transformScratch + partitionSize, transformScratch + partitionSize * 2, output);
+            continue;
+        }
+
+        // Both kernels run while the new one fades in, sample by sample across the blocks
+        convolveSpectra(spectra, nextKernel, fadeScratch);
+
+        const auto fadeLength = static_cast<float>(static_cast<size_t>(kernelFadeBlocks) * partitionSize);
+        const auto fadeStart = static_cast<float>(static_cast<size_t>(kernelFadeBlocks - kernelFadeRemaining) * partitionSize);
+
+        for (size_t sample = 0; sample < partitionSize; ++sample)
+        {
+            const float position = (fadeStart + static_cast<float>(sample + 1)) / fadeLength;
+            const float from = transformScratch[partitionSize + sample];
+            const float to = fadeScratch[partitionSize + sample];
+            output[sample] = from + position * (to - from);
+        }
+    }
+
+    if (fading && --kernelFadeRemaining == 0)
+        std::swap(currentKernel, nextKernel);
+}
+
+template<typename SampleType>
+template<typename ProcessContext>
+void ParametricEQNode<SampleType>::processLinearPhase(const ProcessContext& context) noexcept
+{
+    using BlockSampleType = typename ProcessContext::SampleType;
+
+    updateKernel();
+
+    auto& inputBlock = context.getInputBlock();
+    auto& outputBlock = context.getOutputBlock();
+    const auto numBlockChannels = juce::jmin(outputBlock.getNumChannels(), numChannels);
+    const auto numSamples = outputBlock.getNumSamples();
+    const auto partitionSize = static_cast<size_t>(kernelDesign.partitionSize);
+
+    size_t start = 0;
+
+    while (start < numSamples)
+    {
+        // Each sample swaps places with one of the block convolved last time
+        const auto position = static_cast<size_t>(blockPosition);
+        const auto length = juce::jmin(numSamples - start, partitionSize - position);
+
+        for (size_t channel = 0; channel < numBlockChannels; ++channel)
+        {
+            const auto* input = inputBlock.getChannelPointer(channel) + start;
+            auto* output = outputBlock.getChannelPointer(channel) + start;
+            auto* history = blockInputs + channel * partitionSize * 2 + partitionSize + position;
+            const auto* filtered = blockOutputs + channel * partitionSize + position;
+
+            for (size_t sample = 0; sample < length; ++sample)
+            {
+                history[sample] = static_cast<float>(input[sample]);
+                output[sample] = static_cast<BlockSampleType>(filtered[sample]);
+            }
+        }
+
+        start += length;
+        blockPosition += static_cast<int>(length);
+
+        if (static_cast<size_t>(blockPosition) == partitionSize)
+        {
+            convolveBlock(numBlockChannels);
+            blockPosition = 0;
+        }
+    }
+
+    // Channels past the prepared ones have no history to be delayed through, so they
+    // are silenced rather than passed through ahead of the rest
+    for (size_t channel = numBlockChannels; channel < outputBlock.getNumChannels(); ++channel)
+        outputBlock.getSingleChannelBlock(channel).clear();
+}
+
+//==============================================================================
+template<typename SampleType>
+template<typename ProcessContext>
+void ParametricEQNode<SampleType>::process(const ProcessContext& context) noexcept
+{
+    // Handle bypassed state
+    if (context.isBypassed)
+    {
+        if (context.usesSeparateInputAndOutputBlocks())
+            context.getOutputBlock().copyFrom(context.getInputBlock());
+        return;
+    }
+
+    if (topology == Topology::linearPhase)
+    {
+        processLinearPhase(context);
+        return;
+    }
+
+    auto numSamples = context.getOutputBlock().getNumSamples();
+
+    size_t start = 0;
+
+    while (start < numSamples)
+    {
+        // Stable sections run the whole remaining block; moving ones step along their ramps every few samples
+        if (topology == Topology::biquad)
+            for (size_t index = 0; index < numSectionSlots; ++index)
+                pickUpDesign(sections[index]);
+
+        auto subBlockSize = numSamples - start;
+
+        if (isAnySectionRamping())
+            subBlockSize = juce::jmin(subBlockSize, static_cast<size_t>(maxSubBlockSize));
+
+        beginSubBlock(static_cast<int>(subBlockSize));
+
+        // Run the sections still in the cascade over every channel
+        if (topology == Topology::stateVariable)
+            processCascade<SvfState>(context, start, subBlockSize);
+        else
+            processCascade<BiquadState>(context, start, subBlockSize);
+
+        start += subBlockSize;
+    }
+}
+
+//==============================================================================
+template class ParametricEQNode<float>;
+template class ParametricEQNode<double>;
+
+// Explicit template instantiations for common ProcessContext types. Either precision
+// of node runs on blocks of either precision, converting sample by sample.
+template void ParametricEQNode<float>::process<juce::dsp::ProcessContextReplacing<float>>(const juce::dsp::ProcessContextReplacing<float>&) noexcept;
+template void ParametricEQNode<float>::process<juce::dsp::ProcessContextReplacing<double>>(const juce::dsp::ProcessContextReplacing<double>&) noexcept;
+template void ParametricEQNode<float>::process<juce::dsp::ProcessContextNonReplacing<float>>(const juce::dsp::ProcessContextNonReplacing<float>&) noexcept;
+template void ParametricEQNode<float>::process<juce::dsp::ProcessContextNonReplacing<double>>(const juce::dsp::ProcessContextNonReplacing<double>&) noexcept;
+template void ParametricEQNode<double>::process<juce::dsp::ProcessContextReplacing<float>>(const juce::dsp::ProcessContextReplacing<float>&) noexcept;
+template void ParametricEQNode<double>::process<juce::dsp::ProcessContextReplacing<double>>(const juce::dsp::ProcessContextReplacing<double>&) noexcept;
+template void ParametricEQNode<double>::process<juce::dsp::ProcessContextNonReplacing<float>>(const juce::dsp::ProcessContextNonReplacing<float>&) noexcept;
+template void ParametricEQNode<double>::process<juce::dsp::ProcessContextNonReplacing<double>>(const juce::dsp::ProcessContextNonReplacing<double>&) noexcept;
+
+template void ParametricEQNode<float>::delayAlongside<float>(const juce::dsp::AudioBlock<float>&) noexcept;
+template void ParametricEQNode<float>::delayAlongside<double>(const juce::dsp::AudioBlock<double>&) noexcept;
+template void ParametricEQNode<double>::delayAlongside<float>(const juce::dsp::AudioBlock<float>&) noexcept;
+template void ParametricEQNode<double>::delayAlongside<double>(const juce::dsp::AudioBlock<double>&) noexcept;
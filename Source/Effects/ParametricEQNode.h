@@ -0,0 +1,589 @@
+/*
+  ==============================================================================
+
+    ParametricEQNode.h
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <juce_dsp/juce_dsp.h>
+#include <juce_audio_basics/juce_audio_basics.h>
+#include <juce_core/juce_core.h>
+#include <array>
+#include <memory>
+#include <type_traits>
+#include "BiquadDesigner.h"
+#include "BiquadState.h"
+#include "LinearPhaseKernel.h"
+#include "SvfState.h"
+#include "StateArena.h"
+
+//==============================================================================
+/**
+    A DSP processor node that implements a parametric equalizer of up to
+    maxBands bands, each a peak, a shelf, or a Butterworth high- or low-pass
+    cut of 12, 24 or 48 dB per octave.
+
+    Every band is built from second-order sections - one, or one per 12 dB/oct
+    of a cut - and the sections of all the bands run as a single cascade. The
+    band count is fixed from prepare(), and only bands within it hold any state.
+    A band that is off or flat drops out of the cascade once its state has died
+    away, after which it costs nothing.
+
+    SampleType is the precision of the filter state and coefficients; process()
+    accepts blocks of either precision. Low shelves near 20 Hz at high sample
+    rates put the poles very close to 1, where float state gets noisy.
+
+    The setters never design coefficients on the calling thread: each section
+    hands its new settings to the shared BiquadDesigner and ramps to the result
+    once it comes back. The ramp runs in the coefficient domain, which is safe for
+    biquads - every point between two stable sets of poles is stable too.
+
+    process() runs its own kernel rather than the generic channel kernels. The
+    active sections' coefficients and state are held in locals a few sections
+    and a stretch of samples at a time. Channels are filtered side by side, one
+    per SIMD lane, with any lanes past the last channel filtering silence; a
+    mono node runs its channel through the same passes on plain values.
+
+    With Topology::stateVariable the sections run as zero-delay-feedback
+    state-variable filters instead. Their settings glide in octaves, Q and dB
+    and are redesigned inline every sub-block while they move, which needs no
+    background thread and stays stable however fast the settings change.
+
+    Topology::linearPhase replaces the sections with one FIR that has their
+    combined magnitude response and no phase shift, built on the designer thread
+    and run by uniformly partitioned FFT convolution. Each new kernel is
+    crossfaded in. The output is delayed by getLatencySamples(); setBypassed()
+    glides to a pure delay rather than dropping it, so the latency never changes
+    while running. juce::dsp::FFT only works in float, so the history, spectra
+    and kernels are float whatever SampleType is: a double node in this topology
+    filters to float precision, about -140 dB below the signal. Output channels
+    past the prepared count are cleared.
+*/
+template<typename SampleType>
+class ParametricEQNode
+{
+public:
+    //==============================================================================
+    /** The precision the node keeps its filter state and coefficients in. */
+    using StateType = SampleType;
+
+    /** The filter structure the sections run on. */
+    enum class Topology
+    {
+        biquad,         // RBJ biquads, designed in the background and ramped in the coefficient domain
+        stateVariable,  // trapezoidal SVFs, glided in the parameter domain and redesigned inline
+        linearPhase     // one linear-phase FIR with the sections' magnitude response, convolved in blocks, in float
+    };
+
+    /** What a band does. */
+    enum class BandType
+    {
+        off,
+        peak,
+        lowShelf,
+        highShelf,
+        highPass,       // Butterworth, as steep as the band's slope
+        lowPass
+    };
+
+    /** How steeply a high- or low-pass band cuts. */
+    enum class CutSlope
+    {
+        dB12,
+        dB24,
+        dB48
+    };
+
+    /** The most bands a node can have. */
+    static constexpr int maxBands = 8;
+
+    /** Each band has room for the four sections of a 48 dB/oct cut. */
+    static constexpr int maxSectionsPerBand = 4;
+    static constexpr int maxSections = maxBands * maxSectionsPerBand;
+
+    //==============================================================================
+    ParametricEQNode();
+    ~ParametricEQNode() = default;
+
+    //==============================================================================
+    /** Prepares the processor for playback with the given sample rate and buffer size,
+        keeping its state in an arena of its own. */
+    void prepare(const juce::dsp::ProcessSpec& spec);
+
+    /** Sets the processor up for the given sample rate and channel count without
+        touching its state. Before processing, the state has to be taken from an
+        arena with layOutState() and cleared with reset(). */
+    void configure(const juce::dsp::ProcessSpec& spec);
+
+    /** Takes the state for the configured sample rate, channel count and band
+        count from an arena's layout. */
+    void layOutState(StateArena::Layout& layout);
+
+    /** Resets the processor's internal state. */
+    void reset();
+
+    /** Processes audio data using the ProcessContext interface. */
+    template<typename ProcessContext>
+    void process(const ProcessContext& context) noexcept;
+
+    //==============================================================================
+    /** Sets how many bands there are (0 to maxBands, all of them by default).
+        Takes effect from the next prepare() or configure(). */
+    void setNumBands(int newNumBands) noexcept;
+
+    /** Sets what a band does. Bands start out off. */
+    void setBandType(int band, BandType newType);
+
+    /** Sets a band's frequency in Hz (20-20000): the centre of a peak, or the
+        corner of a shelf or cut. */
+    void setBandFrequency(int band, float freqHz);
+
+    /** Sets a peak or shelf band's gain in dB (-24 to +24). */
+    void setBandGain(int band, float gainDb);
+
+    /** Sets a peak or shelf band's Q (0.1-10). */
+    void setBandQ(int band, float qValue);
+
+    /** Sets a high- or low-pass band's slope. */
+    void setBandSlope(int band, CutSlope newSlope);
+
+    /** Sets the ramp length used when any band setting changes. */
+    void setSmoothingTime(double seconds);
+
+    /** Chooses between designing on the background thread (the default) and on
+        the calling thread, so offline renders apply every change on the same
+        sample each time. */
+    void setDesignInBackground(bool shouldDesignInBackground);
+
+    /** Chooses the filter structure. Takes effect from the next prepare() or
+        configure(), which jump straight to the current settings. */
+    void setTopology(Topology newTopology) noexcept { requestedTopology = newTopology; }
+
+    /** With Topology::linearPhase, glides to a kernel that only delays the signal,
+        keeping the latency of the filtered path. Process with isBypassed set
+        instead to pass the input straight through. Ignored by the other topologies. */
+    void setBypassed(bool shouldBeBypassed) noexcept;
+
+    /** How many samples the configured topology delays the output by. */
+    int getLatencySamples() const noexcept;
+
+    /** With Topology::linearPhase, delays a block by getLatencySamples() through a
+        line of the node's own, so audio running in parallel with the node can be
+        summed with its output in step. Call it once per block processed, with the
+        same channels. Ignored by the other topologies, which add no delay. */
+    template<typename BlockSampleType>
+    void delayAlongside(const juce::dsp::AudioBlock<BlockSampleType>& block) noexcept;
+
+    /** Overwrites one channel's filter state with another's, so the destination
+        carries on exactly as the source would. */
+    void copyChannelState(size_t sourceChannel, size_t destChannel) noexcept;
+
+    //==============================================================================
+    /** Coefficients are stepped along their ramp this often (in samples) while a section is moving. */
+    static constexpr int coefficientUpdateInterval = 32;
+
+    /** The longest sub-block a single call to beginSubBlock() may cover. */
+    static constexpr int maxSubBlockSize = coefficientUpdateInterval;
+
+    /** Picks up any finished designs and moves every ramping section on by
+        numSamples. Call this once per sub-block, then processSample() for every
+        sample of every channel in it. */
+    void beginSubBlock(int numSamples) noexcept
+    {
+        for (size_t index = 0; index < numSectionSlots; ++index)
+            advanceSection(sections[index], numSamples);
+
+        if (activeSectionsChanged)
+            updateActiveSections();
+    }
+
+    /** Filters one sample through the active sections. Defined here so chains of
+        nodes can be inlined into a single loop. */
+    SampleType processSample(size_t channel, int sampleIndex, SampleType input) noexcept
+    {
+        juce::ignoreUnused(sampleIndex);
+
+        // Linear-phase kernels run in whole blocks and are never fused into a chain
+        jassert(topology != Topology::linearPhase);
+
+        if (topology == Topology::stateVariable)
+            return processSections<SvfState>(channel, input);
+
+        return processSections<BiquadState>(channel, input);
+    }
+
+    //==============================================================================
+    /** Returns how long the filters ring before falling below silenceLevel
+        (as a gain) once the input stops. */
+    double getTailLengthSeconds(float silenceLevel) const;
+
+    //==============================================================================
+    /** What a band was last asked for. */
+    struct BandSettings
+    {
+        BandType type = BandType::off;
+        float frequency = 1000.0f;
+        float gain = 0.0f;
+        float q = 0.707f;
+        CutSlope slope = CutSlope::dB12;
+    };
+
+    /** How many sections a band's settings take: none while it is off. */
+    static int getNumBandSections(const BandSettings& settings) noexcept;
+
+    /** The settings of one of a band's sections, flat for the ones it does not use.
+        Public, with the helpers below, so BatchParametricEQNode designs its lanes
+        exactly as this node does. */
+    static BiquadDesign getSectionDesign(const BandSettings& settings, int index, double sampleRate) noexcept;
+
+    /** True if the coefficients pass everything through unchanged. */
+    static bool isUnity(const BiquadCoefficients<double>& coefficients) noexcept;
+    static bool isUnity(const SvfCoefficients<double>& coefficients) noexcept;
+
+    /** True if the settings leave the signal as it is: a peak or shelf at 0 dB. */
+    static bool isFlat(const BiquadDesign& design) noexcept;
+
+    /** How many samples a section's state takes to fall to settleLevel. */
+    static int getSettleSamples(const BiquadCoefficients<double>& coefficients) noexcept;
+
+    /** The level, relative to where it started, at which a flat section's state is dropped. */
+    static constexpr double settleLevel = 1.0e-6;
+
+private:
+    //==============================================================================
+    // One section's coefficients, shared by all channels, and the ramp towards its
+    // newest design. The ramp is worked out in double whatever SampleType is.
+    // A section at unity is bypassed once its state has settled, which it then
+    // leaves at zero - where a flat section's state ends up anyway. As an SVF the
+    // section glides its settings instead, using the same ramp counters. Sections
+    // a band does not use are held flat, so they start out bypassed.
+    struct Section
+    {
+        BiquadDesignSlot designs;
+        BiquadCoefficients<SampleType> coefficients;
+        BiquadCoefficients<double> current;
+        BiquadCoefficients<double> rampStart;
+        BiquadCoefficients<double> rampTarget;
+        int rampRemaining = 0;
+        int rampLength = 0;
+        int settleRemaining = 0;
+        bool bypassed = true;
+
+        BiquadDesign requested { BiquadDesign::Shape::peak };   // the settings last asked for
+        bool requestedFlat = true;
+
+        SvfCoefficients<SampleType> svfCoefficients;
+        SvfCoefficients<double> svfCurrent;
+        BiquadDesign svfDesign { BiquadDesign::Shape::peak };   // the settings svfCurrent was designed for
+        BiquadDesign svfTarget { BiquadDesign::Shape::peak };
+        std::array<double, 3> glideStart {};    // log frequency, Q and gain
+        std::array<double, 3> glideTarget {};
+    };
+
+    std::array<BandSettings, maxBands> bandSettings;
+    std::array<Section, maxSections> sections;
+
+    // The bands in use, and the count configure() switches to. Band b owns
+    // sections [b * maxSectionsPerBand, (b + 1) * maxSectionsPerBand).
+    int numBands = maxBands;
+    int requestedNumBands = maxBands;
+    size_t numSectionSlots = static_cast<size_t>(maxSections);
+
+    // The sections not bypassed, in cascade order, rebuilt whenever one drops
+    // out or comes back
+    std::array<int, maxSections> activeSections {};
+    size_t numActiveSections = 0;
+    bool activeSectionsChanged = true;
+
+    // Each channel's section states, channel by channel, numSectionSlots apiece
+    BiquadState<SampleType>* biquadStates = nullptr;
+    SvfState<SampleType>* svfStates = nullptr;
+    size_t numChannels = 0;
+
+    // Channels are filtered this many at a time, one per lane, or a lone channel
+    // on plain values
+    size_t channelGroupSize = 1;
+
+    double currentSampleRate = 44100.0;
+    double smoothingTimeSeconds = 0.02;
+    bool designInBackground = true;
+
+    // The structure in use, and the one configure() switches to
+    Topology topology = Topology::biquad;
+    Topology requestedTopology = Topology::biquad;
+
+    // Linear-phase mode. Each channel keeps the spectra of its last numPartitions
+    // input blocks, and every block the newest is multiplied by the kernel's first
+    // partition, the one before by the second and so on, all summed - uniformly
+    // partitioned overlap-save. The FIR's own delay of half its length comes on
+    // top of the one block it takes to fill. A new kernel fades in over whole
+    // blocks, with the old one running alongside until it has.
+    LinearPhaseKernelSlot kernelDesigns;
+    LinearPhaseDesign kernelDesign;                 // the sizes in use, and the sections when designing
+    std::unique_ptr<juce::dsp::FFT> partitionFFT;
+
+    float* blockInputs = nullptr;                   // per channel: the last block, then the one filling up
+    float* blockOutputs = nullptr;                  // per channel: the block being played out
+    juce::dsp::Complex<float>* inputSpectra = nullptr;   // per channel: a ring of block spectra
+    juce::dsp::Complex<float>* currentKernel = nullptr;
+    juce::dsp::Complex<float>* nextKernel = nullptr;
+    float* transformScratch = nullptr;
+    float* fadeScratch = nullptr;
+
+    // Per channel: a ring of getLatencySamples() for delayAlongside()
+    SampleType* alongsideLines = nullptr;
+    int alongsidePosition = 0;
+
+    int blockPosition = 0;
+    int newestSpectrum = 0;
+    int kernelFadeBlocks = 0;
+    int kernelFadeRemaining = 0;
+    bool kernelDirty = false;       // the settings have changed since the last kernel was asked for
+    bool kernelSnap = false;        // reset() designs the kernel in place, with no fade
+    bool bypassed = false;
+
+    /** Linear-phase kernels span at least this long, rounded up to a power of two of taps... */
+    static constexpr double linearPhaseLengthSeconds = 0.15;
+
+    /** ...cut into this many partitions, so the block size follows the sample rate. */
+    static constexpr int linearPhasePartitions = 64;
+
+    static_assert(maxSections <= LinearPhaseDesign::maxSections, "A linear-phase kernel has to hold every section");
+
+    // Holds the state when the node is prepared on its own rather than laid out by its owner
+    StateArena ownState;
+
+    /** Starts a ramp from the section's current coefficients to target, or jumps
+        straight there if there is no ramp time. */
+    void startRamp(Section& section, const BiquadCoefficients<double>& target) noexcept
+    {
+        section.rampStart = section.current;
+        section.rampTarget = target;
+        section.rampLength = juce::roundToInt(smoothingTimeSeconds * currentSampleRate);
+        section.rampRemaining = section.rampLength;
+        section.settleRemaining = 0;
+        includeSection(section);
+
+        if (section.rampLength <= 0)
+        {
+            section.current = target;
+            section.coefficients = target;
+            beginSettling(section);
+        }
+    }
+
+    /** Starts a ramp to the section's newest design, if one has come back. */
+    void pickUpDesign(Section& section) noexcept
+    {
+        if (section.designs.isPending() && section.designs.fetch())
+            startRamp(section, section.designs.getCoefficients());
+    }
+
+    /** Picks up the section's newest design and moves its ramp on by numSamples. */
+    void advanceSection(Section& section, int numSamples) noexcept
+    {
+        if (topology == Topology::stateVariable)
+        {
+            advanceGlide(section, numSamples);
+            return;
+        }
+
+        pickUpDesign(section);
+
+        if (section.rampRemaining > 0)
+        {
+            section.rampRemaining = juce::jmax(0, section.rampRemaining - numSamples);
+            const double position = 1.0 - static_cast<double>(section.rampRemaining) / static_cast<double>(section.rampLength);
+
+            for (size_t index = 0; index < section.current.values.size(); ++index)
+                section.current.values[index] = section.rampStart.values[index]
+                                                + position * (section.rampTarget.values[index] - section.rampStart.values[index]);
+
+            // Land exactly on the design, so a flat one is recognised as flat
+            if (section.rampRemaining == 0)
+            {
+                section.current = section.rampTarget;
+                beginSettling(section);
+            }
+
+            section.coefficients = section.current;
+        }
+        else if (section.settleRemaining > 0)
+        {
+            section.settleRemaining -= numSamples;
+
+            if (section.settleRemaining <= 0)
+                bypassSection(section);
+        }
+    }
+
+    /** Moves an SVF section's settings on by numSamples and redesigns it, if it is
+        gliding, or takes it out of the cascade once it has come to rest flat. */
+    void advanceGlide(Section& section, int numSamples) noexcept
+    {
+        if (section.rampRemaining <= 0)
+        {
+            if (section.settleRemaining > 0)
+                bypassSection(section);
+
+            return;
+        }
+
+        section.rampRemaining = juce::jmax(0, section.rampRemaining - numSamples);
+
+        if (section.rampRemaining == 0)
+        {
+            section.svfDesign = section.svfTarget;
+        }
+        else
+        {
+            const double position = 1.0 - static_cast<double>(section.rampRemaining) / static_cast<double>(section.rampLength);
+
+            auto glide = [&section, position](size_t index)
+            {
+                return std::exp(section.glideStart[index] + position * (section.glideTarget[index] - section.glideStart[index]));
+            };
+
+            section.svfDesign.frequency = glide(0);
+            section.svfDesign.q = glide(1);
+            section.svfDesign.gain = glide(2);
+        }
+
+        designSvfSection(section);
+    }
+
+    /** Starts an SVF section gliding towards new settings, or jumps there if there is no ramp time. */
+    void startGlide(Section& section, const BiquadDesign& target) noexcept;
+
+    /** Designs an SVF section's coefficients for its current settings, and bypasses
+        it if they have come to rest at unity. */
+    void designSvfSection(Section& section) noexcept;
+
+    /** Filters one sample of one channel through the active sections. */
+    template<template<typename> class SectionState>
+    SampleType processSections(size_t channel, SampleType value) noexcept
+    {
+        auto* states = getChannelStates<SectionState>(channel);
+
+        for (size_t index = 0; index < numActiveSections; ++index)
+        {
+            const auto section = static_cast<size_t>(activeSections[index]);
+            value = states[section].processSample(value, getSectionCoefficients<SectionState>(sections[section]).data());
+        }
+
+        return value;
+    }
+
+    /** One channel's section states in the given structure. */
+    template<template<typename> class SectionState>
+    SectionState<SampleType>* getChannelStates(size_t channel) const noexcept
+    {
+        if constexpr (std::is_same<SectionState<SampleType>, SvfState<SampleType>>::value)
+            return svfStates + channel * numSectionSlots;
+        else
+            return biquadStates + channel * numSectionSlots;
+    }
+
+    /** The section's coefficients in the given structure. */
+    template<template<typename> class SectionState>
+    static const std::array<SampleType, SectionState<SampleType>::numCoefficients>& getSectionCoefficients(const Section& section) noexcept
+    {
+        if constexpr (std::is_same<SectionState<SampleType>, SvfState<SampleType>>::value)
+            return section.svfCoefficients.values;
+        else
+            return section.coefficients.values;
+    }
+
+    /** Puts the section back in the cascade if it had dropped out. */
+    void includeSection(Section& section) noexcept
+    {
+        activeSectionsChanged = activeSectionsChanged || section.bypassed;
+        section.bypassed = false;
+    }
+
+    /** Rebuilds the list of sections that are not bypassed. */
+    void updateActiveSections() noexcept;
+
+    /** Starts counting down to bypassing the section if its coefficients are at unity. */
+    void beginSettling(Section& section) noexcept;
+
+    /** Clears the section's state on every channel and takes it out of the cascade. */
+    void bypassSection(Section& section) noexcept;
+
+    /** True if the section has come to rest at unity in the structure in use. */
+    bool isSectionFlat(const Section& section) const noexcept;
+
+    /** Channels are filtered in groups this wide, one per lane. */
+    using ChannelLanes = juce::dsp::SIMDRegister<SampleType>;
+
+    /** Samples are gathered into the lanes this many at a time. */
+    static constexpr size_t interleaveLength = 64;
+
+    /** Sections go through the lanes in passes of at most this many, each pass
+        keeping its coefficients and state in locals. */
+    static constexpr size_t maxSectionsPerPass = 4;
+
+    /** Runs the active sections over one sub-block of every channel, as SectionState
+        - BiquadState or SvfState. */
+    template<template<typename> class SectionState, typename ProcessContext>
+    void processCascade(const ProcessContext& context, size_t start, size_t numSamples) noexcept;
+
+    /** Runs NumActive sections over length samples of a group of channels held in
+        buffer, one channel per lane of LaneType - ChannelLanes, or SampleType for a
+        lone channel. */
+    template<template<typename> class SectionState, typename LaneType, size_t NumActive>
+    void runPass(const int* passSections, size_t firstChannel, size_t numGroupChannels,
+                 SampleType* buffer, size_t length) noexcept;
+
+    /** Runs the active sections over a buffer of one channel group, in passes. */
+    template<template<typename> class SectionState, typename LaneType>
+    void runPasses(size_t firstChannel, size_t numGroupChannels, SampleType* buffer, size_t length) noexcept;
+
+    /** Filters a block through the linear-phase kernel. */
+    template<typename ProcessContext>
+    void processLinearPhase(const ProcessContext& context) noexcept;
+
+    /** Asks for a kernel with the current settings if they have changed, and
+        starts fading in any that has come back. */
+    void updateKernel() noexcept;
+
+    /** The current settings as a linear-phase design, flat if bypassed. */
+    LinearPhaseDesign makeKernelDesign() const noexcept;
+
+    /** Starts fading from the current kernel to nextKernel. */
+    void startKernelFade() noexcept;
+
+    /** Runs the convolution for a full block on the first numBlockChannels channels. */
+    void convolveBlock(size_t numBlockChannels) noexcept;
+
+    /** Multiplies a channel's block spectra by a kernel's partitions, sums them and
+        transforms the result back into result, which holds four blocks of floats. */
+    void convolveSpectra(const juce::dsp::Complex<float>* spectra, const juce::dsp::Complex<float>* kernel, float* result) noexcept;
+
+    /** True while any section is still ramping. */
+    bool isAnySectionRamping() const noexcept;
+
+    /** The settings of one of this node's band's sections at its sample rate. */
+    BiquadDesign getSectionDesign(int band, int index) const noexcept
+    {
+        return getSectionDesign(bandSettings[static_cast<size_t>(band)], index, currentSampleRate);
+    }
+
+    /** Sends the section's settings off to be designed, or designs them here and
+        starts the ramp. */
+    void updateSection(Section& section, const BiquadDesign& design);
+
+    /** Designs the section here and jumps straight to it, with no ramp. */
+    void snapSection(Section& section, const BiquadDesign& design);
+
+    /** Redesigns every section of a band. */
+    void updateBand(int band);
+
+    /** Redesigns every band, without ramping if snap is true. */
+    void updateAllBands(bool snap);
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(ParametricEQNode)
+};
@@ -10,7 +10,8 @@
 
 
 //==============================================================================
-ReverbNode::ReverbNode()
+template<typename SampleType>
+ReverbNode<SampleType>::ReverbNode()
 {
     // Initialize with default reverb parameters
     currentParams.roomSize = 0.5f;
@@ -25,69 +26,153 @@ ReverbNode::ReverbNode()
 }
 
 //==============================================================================
-void ReverbNode::prepare(const juce::dsp::ProcessSpec& spec)
+template<typename SampleType>
+void ReverbNode<SampleType>::prepare(const juce::dsp::ProcessSpec& spec)
+{
+    configure(spec);
+    ownState.build([this](StateArena::Layout& layout) { layOutState(layout); });
+    reset();
+}
+
+template<typename SampleType>
+void ReverbNode<SampleType>::configure(const juce::dsp::ProcessSpec& spec)
 {
     currentSampleRate = spec.sampleRate;
+    numChannels = static_cast<size_t>(spec.numChannels);
     
-    // Initialize the reverb with the sample rate
-    reverb.setSampleRate(currentSampleRate);
+    // Every channel's lines are a little longer than the last channel's
+    combBufferSize = 0;
+    allPassBufferSize = 0;
+    longestCombSamples = 0;
     
-    // Reset the reverb state
-    reverb.reset();
+    for (size_t channel = 0; channel < numChannels; ++channel)
+    {
+        for (auto tuning : combTunings)
+        {
+            const int length = getLineLength(tuning, channel);
+            combBufferSize += static_cast<size_t>(length);
+            longestCombSamples = juce::jmax(longestCombSamples, length);
+        }
+        
+        for (auto tuning : allPassTunings)
+            allPassBufferSize += static_cast<size_t>(getLineLength(tuning, channel));
+    }
+    
+    // Same ramp times as juce::Reverb
+    constexpr double smoothTime = 0.01;
+    damping.reset(currentSampleRate, smoothTime);
+    feedback.reset(currentSampleRate, smoothTime);
+    dryGain.reset(currentSampleRate, smoothTime);
+    wetGain1.reset(currentSampleRate, smoothTime);
+    wetGain2.reset(currentSampleRate, smoothTime);
     
     // Apply current parameters
     updateInternalReverb();
 }
 
-void ReverbNode::reset()
+template<typename SampleType>
+void ReverbNode<SampleType>::layOutState(StateArena::Layout& layout)
+{
+    networks = layout.take<ChannelNetwork>(numChannels);
+    inputScratch = layout.take<SampleType>(static_cast<size_t>(maxSubBlockSize));
+    wetScratch = layout.take<SampleType>(numChannels * static_cast<size_t>(maxSubBlockSize));
+    wetSumScratch = layout.take<SampleType>(static_cast<size_t>(maxSubBlockSize));
+    combBuffer = layout.take<SampleType>(combBufferSize);
+    allPassBuffer = layout.take<SampleType>(allPassBufferSize);
+}
+
+template<typename SampleType>
+void ReverbNode<SampleType>::reset()
+{
+    // Lay the lines out again from the start, each channel's straight after the last.
+    // Their contents are left alone: processChannel() zeroes them on the first lap.
+    size_t combStart = 0;
+    size_t allPassStart = 0;
+    
+    for (size_t channel = 0; channel < numChannels; ++channel)
+    {
+        auto& network = networks[channel];
+        network.samplesSinceReset = 0;
+        
+        for (size_t comb = 0; comb < numCombs; ++comb)
+        {
+            auto& line = network.combs[comb];
+            line = CombLine();
+            line.start = combStart;
+            line.length = getLineLength(combTunings[comb], channel);
+            combStart += static_cast<size_t>(line.length);
+        }
+        
+        for (size_t allPass = 0; allPass < numAllPasses; ++allPass)
+        {
+            auto& line = network.allPasses[allPass];
+            line = AllPassLine();
+            line.start = allPassStart;
+            line.length = getLineLength(allPassTunings[allPass], channel);
+            allPassStart += static_cast<size_t>(line.length);
+        }
+    }
+}
+
+template<typename SampleType>
+int ReverbNode<SampleType>::getLineLength(int tuning, size_t channel) const noexcept
 {
-    reverb.reset();
+    const double tuningScale = currentSampleRate / 44100.0;
+    return juce::jmax(1, juce::roundToInt((tuning + channelSpread * static_cast<int>(channel)) * tuningScale));
 }
 
 //==============================================================================
-void ReverbNode::setParameters(const juce::Reverb::Parameters& newParams)
+template<typename SampleType>
+void ReverbNode<SampleType>::setParameters(const juce::Reverb::Parameters& newParams)
 {
     currentParams = newParams;
     updateInternalReverb();
 }
 
-void ReverbNode::setRoomSize(float roomSize)
+template<typename SampleType>
+void ReverbNode<SampleType>::setRoomSize(float roomSize)
 {
     currentParams.roomSize = juce::jlimit(0.0f, 1.0f, roomSize);
     updateInternalReverb();
 }
 
-void ReverbNode::setDamping(float damping)
+template<typename SampleType>
+void ReverbNode<SampleType>::setDamping(float newDamping)
 {
-    currentParams.damping = juce::jlimit(0.0f, 1.0f, damping);
+    currentParams.damping = juce::jlimit(0.0f, 1.0f, newDamping);
     updateInternalReverb();
 }
 
-void ReverbNode::setWetLevel(float wetLevel)
+template<typename SampleType>
+void ReverbNode<SampleType>::setWetLevel(float wetLevel)
 {
     currentParams.wetLevel = juce::jlimit(0.0f, 1.0f, wetLevel);
     updateInternalReverb();
 }
 
-void ReverbNode::setDryLevel(float dryLevel)
+template<typename SampleType>
+void ReverbNode<SampleType>::setDryLevel(float dryLevel)
 {
     currentParams.dryLevel = juce::jlimit(0.0f, 1.0f, dryLevel);
     updateInternalReverb();
 }
 
-void ReverbNode::setWidth(float width)
+template<typename SampleType>
+void ReverbNode<SampleType>::setWidth(float width)
 {
     currentParams.width = juce::jlimit(0.0f, 1.0f, width);
     updateInternalReverb();
 }
 
-void ReverbNode::setFreezeMode(float freezeMode)
+template<typename SampleType>
+void ReverbNode<SampleType>::setFreezeMode(float freezeMode)
 {
     currentParams.freezeMode = freezeMode;
     updateInternalReverb();
 }
 
-void ReverbNode::setMix(float mix)
+template<typename SampleType>
+void ReverbNode<SampleType>::setMix(float mix)
 {
     mix = juce::jlimit(0.0f, 1.0f, mix);
     currentParams.wetLevel = mix;
@@ -96,7 +181,221 @@ void ReverbNode::setMix(float mix)
 }
 
 //==============================================================================
-void ReverbNode::updateInternalReverb()
+template<typename SampleType>
+double ReverbNode<SampleType>::getTailLengthSeconds(float silenceLevel) const
+{
+    if (currentParams.wetLevel <= 0.0f)
+        return 0.0;
+    
+    // A frozen reverb recirculates forever
+    if (currentParams.freezeMode >= 0.5f)
+        return std::numeric_limits<double>::infinity();
+    
+    // Room size maps to comb feedback as roomSize * 0.28 + 0.7. Damping only
+    // filters the loop, so the DC decay of the longest comb bounds the network.
+    const double combFeedback = currentParams.roomSize * 0.28 + 0.7;
+    const double longestCombSeconds = longestCombSamples / currentSampleRate;
+    const double passes = std::log(static_cast<double>(silenceLevel)) / std::log(combFeedback);
+    
+    return longestCombSeconds * passes;
+}
+
+//==============================================================================
+template<typename SampleType>
+template<typename ProcessContext>
+void ReverbNode<SampleType>::process(const ProcessContext& context) noexcept
+{
+    // Handle bypassed state
+    if (context.isBypassed)
+    {
+        if (context.usesSeparateInputAndOutputBlocks())
+            context.getOutputBlock().copyFrom(context.getInputBlock());
+        return;
+    }
+    
+    if (context.usesSeparateInputAndOutputBlocks())
+        context.getOutputBlock().copyFrom(context.getInputBlock());
+    
+    using BlockSampleType = typename ProcessContext::SampleType;
+    
+    auto& audioBlock = context.getOutputBlock();
+    const auto channelsToProcess = juce::jmin(audioBlock.getNumChannels(), numChannels);
+    const auto numSamples = audioBlock.getNumSamples();
+    
+    if (channelsToProcess == 0)
+        return;
+    
+    // Every channel is fed the same mono sum. Scaling it by 2 / channels keeps the
+    // stereo level of the original; a single channel is fed as it is.
+    const auto inputScale = static_cast<SampleType>(inputGain * juce::jmin(1.0f, 2.0f / static_cast<float>(channelsToProcess)));
+    
+    // Each channel hears its own network at wetGain1 and the average of all the
+    // others at wetGain2, which for two channels is the usual stereo width control
+    const auto othersScale = channelsToProcess > 1 ? SampleType(1) / static_cast<SampleType>(channelsToProcess - 1) : SampleType(0);
+    
+    for (size_t start = 0; start < numSamples; start += maxSubBlockSize)
+    {
+        const auto subBlockSize = juce::jmin(numSamples - start, static_cast<size_t>(maxSubBlockSize));
+        const int subBlockSamples = static_cast<int>(subBlockSize);
+        
+        const bool dampingRamping = damping.advance(subBlockSamples);
+        const bool feedbackRamping = feedback.advance(subBlockSamples);
+        const bool dryRamping = dryGain.advance(subBlockSamples);
+        const bool wet1Ramping = wetGain1.advance(subBlockSamples);
+        const bool wet2Ramping = wetGain2.advance(subBlockSamples);
+        
+        // Mix every channel down to the shared input
+        std::fill(inputScratch, inputScratch + subBlockSamples, SampleType(0));
+        
+        for (size_t channel = 0; channel < channelsToProcess; ++channel)
+        {
+            const auto* data = audioBlock.getChannelPointer(channel) + start;
+            
+            for (size_t sample = 0; sample < subBlockSize; ++sample)
+                inputScratch[sample] += static_cast<SampleType>(data[sample]);
+        }
+        
+        for (size_t sample = 0; sample < subBlockSize; ++sample)
+            inputScratch[sample] *= inputScale;
+        
+        // Run each channel's network, one line at a time over the whole sub-block
+        std::fill(wetSumScratch, wetSumScratch + subBlockSamples, SampleType(0));
+        
+        for (size_t channel = 0; channel < channelsToProcess; ++channel)
+        {
+            processChannel(channel, subBlockSamples, dampingRamping, feedbackRamping);
+            
+            const auto* wet = wetScratch + channel * maxSubBlockSize;
+            
+            for (size_t sample = 0; sample < subBlockSize; ++sample)
+                wetSumScratch[sample] += wet[sample];
+        }
+        
+        // Blend each channel's own network with the others and the dry signal
+        for (size_t channel = 0; channel < channelsToProcess; ++channel)
+        {
+            auto* data = audioBlock.getChannelPointer(channel) + start;
+            const auto* wet = wetScratch + channel * maxSubBlockSize;
+            
+            for (size_t sample = 0; sample < subBlockSize; ++sample)
+            {
+                const auto dry = static_cast<SampleType>(dryRamping ? dryGain.getRamp()[sample] : dryGain.getCurrentValue());
+                const auto wet1 = static_cast<SampleType>(wet1Ramping ? wetGain1.getRamp()[sample] : wetGain1.getCurrentValue());
+                const auto wet2 = static_cast<SampleType>(wet2Ramping ? wetGain2.getRamp()[sample] : wetGain2.getCurrentValue());
+                const SampleType others = (wetSumScratch[sample] - wet[sample]) * othersScale;
+                
+                data[sample] = static_cast<BlockSampleType>(wet[sample] * wet1 + others * wet2
+                                                            + static_cast<SampleType>(data[sample]) * dry);
+            }
+        }
+    }
+}
+
+template<typename SampleType>
+void ReverbNode<SampleType>::processChannel(size_t channel, int numSamples, bool dampingRamping, bool feedbackRamping) noexcept
+{
+    auto* wet = wetScratch + channel * maxSubBlockSize;
+    std::fill(wet, wet + numSamples, SampleType(0));
+    
+    auto& network = networks[channel];
+    const int lapSamples = network.samplesSinceReset;
+    
+    // Every line reads each position just before overwriting it, so on the first
+    // lap after reset() the positions this sub-block reaches are zeroed up front
+    auto clearFirstLap = [lapSamples, numSamples](SampleType* buffer, int length)
+    {
+        if (lapSamples < length)
+            std::fill(buffer + lapSamples, buffer + juce::jmin(lapSamples + numSamples, length), SampleType(0));
+    };
+    
+    // Parallel damped combs, summed
+    for (auto& line : network.combs)
+    {
+        auto* buffer = combBuffer + line.start;
+        const int length = line.length;
+        int position = line.position;
+        SampleType filterState = line.filterState;
+        
+        clearFirstLap(buffer, length);
+        
+        for (int sample = 0; sample < numSamples; ++sample)
+        {
+            const auto damp = static_cast<SampleType>(dampingRamping ? damping.getRamp()[sample] : damping.getCurrentValue());
+            const auto gain = static_cast<SampleType>(feedbackRamping ? feedback.getRamp()[sample] : feedback.getCurrentValue());
+            
+            const SampleType output = buffer[position];
+            filterState = output * (SampleType(1) - damp) + filterState * damp;
+            buffer[position] = inputScratch[static_cast<size_t>(sample)] + filterState * gain;
+            
+            if (++position >= length)
+                position = 0;
+            
+            wet[sample] += output;
+        }
+        
+        line.position = position;
+        line.filterState = filterState;
+    }
+    
+    // Series allpasses
+    for (auto& line : network.allPasses)
+    {
+        auto* buffer = allPassBuffer + line.start;
+        const int length = line.length;
+        int position = line.position;
+        
+        clearFirstLap(buffer, length);
+        
+        for (int sample = 0; sample < numSamples; ++sample)
+        {
+            const SampleType bufferedValue = buffer[position];
+            buffer[position] = wet[sample] + bufferedValue * SampleType(0.5);
+            
+            if (++position >= length)
+                position = 0;
+            
+            wet[sample] = bufferedValue - wet[sample];
+        }
+        
+        line.position = position;
+    }
+    
+    // The combs are the longest lines, so once past them every line has lapped
+    if (lapSamples < longestCombSamples)
+        network.samplesSinceReset = lapSamples + numSamples;
+}
+
+//==============================================================================
+template<typename SampleType>
+void ReverbNode<SampleType>::updateInternalReverb()
 {
-    reverb.setParameters(currentParams);
+    // Same gain structure as juce::Reverb
+    constexpr float wetScaleFactor = 3.0f;
+    constexpr float dryScaleFactor = 2.0f;
+    const float wet = currentParams.wetLevel * wetScaleFactor;
+    
+    dryGain.setTargetValue(currentParams.dryLevel * dryScaleFactor);
+    wetGain1.setTargetValue(0.5f * wet * (1.0f + currentParams.width));
+    wetGain2.setTargetValue(0.5f * wet * (1.0f - currentParams.width));
+    
+    // Freezing stops new input and lets the combs recirculate undamped
+    const bool frozen = currentParams.freezeMode >= 0.5f;
+    inputGain = frozen ? 0.0f : 0.015f;
+    damping.setTargetValue(frozen ? 0.0f : currentParams.damping * 0.4f);
+    feedback.setTargetValue(frozen ? 1.0f : currentParams.roomSize * 0.28f + 0.7f);
 }
+
+//==============================================================================
+template class ReverbNode<float>;
+template class ReverbNode<double>;
+
+// Explicit template instantiations for common ProcessContext types. Either precision
+// of node runs on blocks of either precision, converting sample by sample.
+template void ReverbNode<float>::process<juce::dsp::ProcessContextReplacing<float>>(const juce::dsp::ProcessContextReplacing<float>&) noexcept;
+template void ReverbNode<float>::process<juce::dsp::ProcessContextReplacing<double>>(const juce::dsp::ProcessContextReplacing<double>&) noexcept;
+template void ReverbNode<float>::process<juce::dsp::ProcessContextNonReplacing<float>>(const juce::dsp::ProcessContextNonReplacing<float>&) noexcept;
+template void ReverbNode<float>::process<juce::dsp::ProcessContextNonReplacing<double>>(const juce::dsp::ProcessContextNonReplacing<double>&) noexcept;
+template void ReverbNode<double>::process<juce::dsp::ProcessContextReplacing<float>>(const juce::dsp::ProcessContextReplacing<float>&) noexcept;
+template void ReverbNode<double>::process<juce::dsp::ProcessContextReplacing<double>>(const juce::dsp::ProcessContextReplacing<double>&) noexcept;
+template void ReverbNode<double>::process<juce::dsp::ProcessContextNonReplacing<float>>(const juce::dsp::ProcessContextNonReplacing<float>&) noexcept;
+template void ReverbNode<double>::process<juce::dsp::ProcessContextNonReplacing<double>>(const juce::dsp::ProcessContextNonReplacing<double>&) noexcept;
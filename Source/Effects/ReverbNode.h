@@ -11,71 +11,57 @@
 #include <juce_dsp/juce_dsp.h>
 #include <juce_audio_basics/juce_audio_basics.h>
 #include <juce_core/juce_core.h>
+#include <array>
+#include "SmoothedParameter.h"
+#include "StateArena.h"
 
 
 //==============================================================================
 /**
-    A DSP processor node that wraps JUCE's Reverb class for use in ProcessorChain.
+    A DSP processor node implementing a Freeverb-style reverb for any number
+    of channels.
     
-    This class provides the necessary interface methods required by JUCE's DSP
-    framework while maintaining compatibility with the existing reverb parameters.
+    Each channel runs its own network of eight damped combs and four allpasses,
+    tuned a few samples apart from its neighbours' so every channel's output is
+    decorrelated from the others. All channels are fed the same mono sum, as
+    juce::Reverb does for stereo, and with two channels it behaves like juce::Reverb.
+    
+    SampleType is the precision of the delay lines and the arithmetic; process()
+    accepts blocks of either precision.
 */
+template<typename SampleType>
 class ReverbNode
 {
 public:
+    //==============================================================================
+    /** The precision the node keeps its delay lines in. */
+    using StateType = SampleType;
+    
     //==============================================================================
     ReverbNode();
     ~ReverbNode() = default;
-
+    
     //==============================================================================
-    /** Prepares the processor for playback with the given sample rate and buffer size. */
+    /** Prepares the processor for playback with the given sample rate and buffer size.
+        Allocates the delay lines for spec.numChannels channels in an arena of its own. */
     void prepare(const juce::dsp::ProcessSpec& spec);
-
+    
+    /** Sets the processor up for the given sample rate and channel count without
+        touching its state. Before processing, the state has to be taken from an
+        arena with layOutState() and cleared with reset(). */
+    void configure(const juce::dsp::ProcessSpec& spec);
+    
+    /** Takes the state for the configured sample rate and channel count from an
+        arena's layout. */
+    void layOutState(StateArena::Layout& layout);
+    
     /** Resets the processor's internal state. */
     void reset();
-
+    
     /** Processes audio data using the ProcessContext interface. */
     template<typename ProcessContext>
-    void process(const ProcessContext& context) noexcept
-    {
-        // Handle bypassed state
-        if (context.isBypassed)
-        {
-            if (context.usesSeparateInputAndOutputBlocks())
-                context.getOutputBlock().copyFrom(context.getInputBlock());
-            return;
-        }
-
-        // Get audio block from context
-        auto& audioBlock = context.getOutputBlock();
-        auto numChannels = audioBlock.getNumChannels();
-        auto numSamples = audioBlock.getNumSamples();
-
-        // Process based on channel configuration
-        if (numChannels == 1)
-        {
-            // Mono processing
-            auto* monoData = audioBlock.getChannelPointer(0);
-            reverb.processMono(monoData, static_cast<int>(numSamples));
-        }
-        else if (numChannels >= 2)
-        {
-            // Stereo processing
-            auto* leftData = audioBlock.getChannelPointer(0);
-            auto* rightData = audioBlock.getChannelPointer(1);
-            reverb.processStereo(leftData, rightData, static_cast<int>(numSamples));
-            
-            // Handle any additional output channels (copy from stereo if needed)
-            for (int channel = 2; channel < numChannels; ++channel)
-            {
-                auto* destChannel = audioBlock.getChannelPointer(channel);
-                const auto* srcChannel = audioBlock.getChannelPointer(channel % 2);
-                juce::FloatVectorOperations::copy(destChannel, srcChannel, static_cast<int>(numSamples));
-
-            }
-        }
-    }
-
+    void process(const ProcessContext& context) noexcept;
+    
     //==============================================================================
     /** Updates the reverb parameters. */
     void setParameters(const juce::Reverb::Parameters& newParams);
@@ -93,14 +79,92 @@ public:
     
     /** Convenience method to set wet/dry mix (0.0 = dry, 1.0 = wet). */
     void setMix(float mix);
-
+    
+    //==============================================================================
+    /** Returns how long the reverb rings before falling below silenceLevel
+        (as a gain), or infinity while frozen. */
+    double getTailLengthSeconds(float silenceLevel) const;
+    
+    //==============================================================================
+    static constexpr int numCombs = 8;
+    static constexpr int numAllPasses = 4;
+    
+    // Freeverb's tunings in samples at 44.1kHz, scaled with the sample rate.
+    // BatchReverbNode lays its lines out from these too.
+    static constexpr std::array<int, numCombs> combTunings { { 1116, 1188, 1277, 1356, 1422, 1491, 1557, 1617 } };
+    static constexpr std::array<int, numAllPasses> allPassTunings { { 556, 441, 341, 225 } };
+    
+    /** How much longer (in samples at 44.1kHz) each channel's lines are than the
+        previous channel's. No two lines of the same kind end up the same length
+        for up to 16 channels, which would make those channels correlate. */
+    static constexpr int channelSpread = 19;
+    
 private:
     //==============================================================================
-    juce::Reverb reverb;
+    /** Parameter ramps are computed this many samples at a time. */
+    static constexpr int maxSubBlockSize = SmoothedParameter<float>::maxRampLength;
+    
+    // Where each line sits in its buffer and how far through it the network is
+    struct CombLine
+    {
+        size_t start = 0;
+        int length = 0;
+        int position = 0;
+        SampleType filterState = 0;
+    };
+    
+    struct AllPassLine
+    {
+        size_t start = 0;
+        int length = 0;
+        int position = 0;
+    };
+    
+    // One channel's bookkeeping for all twelve lines, a few cache lines in all.
+    // Every line starts over from position 0 on reset(), so for the first lap each
+    // one's position is samplesSinceReset, and whatever lies ahead of it is stale.
+    struct ChannelNetwork
+    {
+        std::array<CombLine, numCombs> combs;
+        std::array<AllPassLine, numAllPasses> allPasses;
+        int samplesSinceReset = 0;
+    };
+    
+    // All of it lives in the arena: the networks first, then the per sub-block
+    // scratch (the mono input, every channel's wet output and their sum), then
+    // every delay line of every channel back to back in one buffer per filter
+    // kind, so a channel's lines are contiguous
+    ChannelNetwork* networks = nullptr;
+    SampleType* inputScratch = nullptr;
+    SampleType* wetScratch = nullptr;
+    SampleType* wetSumScratch = nullptr;
+    SampleType* combBuffer = nullptr;
+    SampleType* allPassBuffer = nullptr;
+    size_t combBufferSize = 0;
+    size_t allPassBufferSize = 0;
+    
+    size_t numChannels = 0;
+    int longestCombSamples = combTunings.back();
+    
     juce::Reverb::Parameters currentParams;
+    SmoothedParameter<float> damping;
+    SmoothedParameter<float> feedback;
+    SmoothedParameter<float> dryGain;
+    SmoothedParameter<float> wetGain1;
+    SmoothedParameter<float> wetGain2;
+    float inputGain = 0.015f;
     double currentSampleRate = 44100.0;
     
-    /** Updates the internal reverb with current parameters. */
+    // Holds the state when the node is prepared on its own rather than laid out by its owner
+    StateArena ownState;
+    
+    /** The length of one of a channel's lines at the current sample rate. */
+    int getLineLength(int tuning, size_t channel) const noexcept;
+    
+    /** Runs one channel's network over the sub-block in inputScratch. */
+    void processChannel(size_t channel, int numSamples, bool dampingRamping, bool feedbackRamping) noexcept;
+    
+    /** Updates the internal gains and filter targets from currentParams. */
     void updateInternalReverb();
     
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(ReverbNode)
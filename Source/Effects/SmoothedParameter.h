@@ -0,0 +1,80 @@
+/*
+  ==============================================================================
+
+    SmoothedParameter.h
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <juce_audio_basics/juce_audio_basics.h>
+#include <juce_core/juce_core.h>
+#include <array>
+
+//==============================================================================
+/**
+    A smoothed node parameter that hands out per-sample ramps in sub-blocks.
+
+    Nodes call advance() once per sub-block of at most maxRampLength samples.
+    While the value is moving it fills a ramp with one value per sample and
+    returns true; once the value has settled it returns false without touching
+    the ramp, so stable parameters cost a single branch per sub-block.
+*/
+template<typename SampleType, typename SmoothingType = juce::ValueSmoothingTypes::Linear>
+class SmoothedParameter
+{
+public:
+    //==============================================================================
+    /** The longest sub-block a single call to advance() may cover. */
+    static constexpr int maxRampLength = 256;
+
+    //==============================================================================
+    SmoothedParameter() = default;
+    explicit SmoothedParameter(SampleType initialValue) : smoother(initialValue) {}
+
+    /** Sets the ramp length and snaps the current value to the target. */
+    void reset(double sampleRate, double rampLengthSeconds) noexcept
+    {
+        smoother.reset(sampleRate, rampLengthSeconds);
+    }
+
+    /** Starts a ramp towards a new value. */
+    void setTargetValue(SampleType newValue) noexcept { smoother.setTargetValue(newValue); }
+
+    /** Jumps straight to a new value without ramping. */
+    void setCurrentAndTargetValue(SampleType newValue) noexcept { smoother.setCurrentAndTargetValue(newValue); }
+
+    SampleType getTargetValue() const noexcept { return smoother.getTargetValue(); }
+    SampleType getCurrentValue() const noexcept { return smoother.getCurrentValue(); }
+    bool isSmoothing() const noexcept { return smoother.isSmoothing(); }
+
+    //==============================================================================
+    /** Advances the smoother by numSamples (at most maxRampLength).
+        Returns true and fills getRamp() if the value moved during the sub-block,
+        otherwise returns false and getCurrentValue() holds the steady value. */
+    bool advance(int numSamples) noexcept
+    {
+        jassert(numSamples <= maxRampLength);
+
+        if (! smoother.isSmoothing())
+            return false;
+
+        for (int sample = 0; sample < numSamples; ++sample)
+            ramp[static_cast<size_t>(sample)] = smoother.getNextValue();
+
+        return true;
+    }
+
+    /** Advances the smoother by numSamples without filling the ramp.
+        Used by nodes that only need the value at sub-block boundaries. */
+    SampleType skip(int numSamples) noexcept { return smoother.skip(numSamples); }
+
+    /** The per-sample values written by the last advance() that returned true. */
+    const SampleType* getRamp() const noexcept { return ramp.data(); }
+
+private:
+    //==============================================================================
+    juce::SmoothedValue<SampleType, SmoothingType> smoother;
+    std::array<SampleType, maxRampLength> ramp {};
+};
@@ -0,0 +1,287 @@
+/*
+  ==============================================================================
+
+    StateArena.cpp
+
+  ==============================================================================
+*/
+
+#include "StateArena.h"
+#include <array>
+#include <cstdint>
+#include <cstring>
+#include <mutex>
+#include <new>
+
+#if JUCE_WINDOWS
+ #include <windows.h>
+#else
+ #include <sys/mman.h>
+ #if JUCE_MAC
+  #include <mach/vm_statistics.h>
+ #endif
+#endif
+
+//==============================================================================
+/**
+    Hands out blocks of power-of-two multiples of the cache line, up to
+    maxSlabBlockSize, carved from huge-page slabs. Freed blocks go on a free list
+    per size and are handed out again before a slab is cut into further; the slabs
+    themselves are kept for the life of the process.
+
+    Arenas are only built and released off the audio thread, but by any number of
+    engines at once, so a mutex guards the lot.
+*/
+class StateArena::Slab
+{
+public:
+    /** The slab every arena in the process shares. It is never destroyed, so arenas
+        in objects that outlive static destruction can still give their blocks back. */
+    static Slab& getInstance()
+    {
+        static auto* instance = new Slab();
+        return *instance;
+    }
+
+    /** The size class whose blocks hold numBytes. */
+    static int getSizeClass(size_t numBytes) noexcept
+    {
+        int sizeClass = 0;
+
+        while (getBlockSize(sizeClass) < numBytes)
+            ++sizeClass;
+
+        return sizeClass;
+    }
+
+    static size_t getBlockSize(int sizeClass) noexcept { return alignment << sizeClass; }
+
+    /** Returns a zeroed block of the given size class, or nullptr if no slab can be mapped. */
+    char* allocate(int sizeClass) noexcept
+    {
+        const auto blockSize = getBlockSize(sizeClass);
+        char* block = nullptr;
+
+        {
+            const std::lock_guard<std::mutex> lock(mutex);
+            auto& freeBlock = freeBlocks[static_cast<size_t>(sizeClass)];
+
+            if (freeBlock != nullptr)
+            {
+                // A free block holds the next one's address in its first bytes
+                block = freeBlock;
+                std::memcpy(&freeBlock, block, sizeof(char*));
+            }
+            else
+            {
+                if (slabUsed + blockSize > slabSize && ! startNewSlab())
+                    return nullptr;
+
+                // Every block size is a multiple of the last, so blocks cut one after
+                // another stay aligned; fresh slab memory is already zeroed
+                block = slab + slabUsed;
+                slabUsed += blockSize;
+                return block;
+            }
+        }
+
+        std::memset(block, 0, blockSize);
+        return block;
+    }
+
+    /** Puts a block back on its size's free list. */
+    void free(char* block, int sizeClass) noexcept
+    {
+        const std::lock_guard<std::mutex> lock(mutex);
+        pushFreeBlock(block, sizeClass);
+    }
+
+private:
+    static constexpr int numSizeClasses = 11;
+    static_assert((alignment << (numSizeClasses - 1)) == maxSlabBlockSize, "The largest size class holds the largest slab arena");
+
+    std::mutex mutex;
+    std::array<char*, numSizeClasses> freeBlocks {};
+    char* slab = nullptr;
+    size_t slabSize = 0;
+    size_t slabUsed = 0;
+
+    void pushFreeBlock(char* block, int sizeClass) noexcept
+    {
+        auto& freeBlock = freeBlocks[static_cast<size_t>(sizeClass)];
+        std::memcpy(block, &freeBlock, sizeof(char*));
+        freeBlock = block;
+    }
+
+    /** Maps a fresh slab, first handing what is left of the current one out to the
+        free lists in the largest blocks that fit. */
+    bool startNewSlab() noexcept
+    {
+        size_t newSlabSize = 0;
+        bool hugePages = false;
+        auto* newSlab = mapMemory(hugePageSize, newSlabSize, hugePages);
+
+        if (newSlab == nullptr)
+            return false;
+
+        for (int sizeClass = numSizeClasses; --sizeClass >= 0;)
+        {
+            while (slabUsed + getBlockSize(sizeClass) <= slabSize)
+            {
+                pushFreeBlock(slab + slabUsed, sizeClass);
+                slabUsed += getBlockSize(sizeClass);
+            }
+        }
+
+        slab = newSlab;
+        slabSize = newSlabSize;
+        slabUsed = 0;
+        return true;
+    }
+};
+
+//==============================================================================
+StateArena::~StateArena()
+{
+    release();
+}
+
+void StateArena::allocate(size_t numBytes)
+{
+    release();
+
+    if (numBytes == 0)
+        return;
+
+    if (numBytes <= maxSlabBlockSize)
+    {
+        const int sizeClass = Slab::getSizeClass(numBytes);
+        data = Slab::getInstance().allocate(sizeClass);
+
+        if (data == nullptr)
+            throw std::bad_alloc();
+
+        slabSizeClass = sizeClass;
+    }
+    else
+    {
+        data = mapMemory(numBytes, mappedSize, hugePages);
+
+        if (data == nullptr)
+            throw std::bad_alloc();
+    }
+
+    size = numBytes;
+}
+
+void StateArena::release() noexcept
+{
+    if (data != nullptr)
+    {
+        if (slabSizeClass >= 0)
+            Slab::getInstance().free(data, slabSizeClass);
+        else
+            unmapMemory(data, mappedSize);
+    }
+
+    data = nullptr;
+    size = 0;
+    mappedSize = 0;
+    slabSizeClass = -1;
+    hugePages = false;
+}
+
+//==============================================================================
+char* StateArena::mapMemory(size_t numBytes, size_t& mappedSize, bool& hugePages) noexcept
+{
+    mappedSize = numBytes;
+    hugePages = false;
+    void* memory = nullptr;
+
+   #if JUCE_WINDOWS
+    // Large pages need the lock-pages privilege, which most users do not have
+    const auto largePageSize = static_cast<size_t>(GetLargePageMinimum());
+
+    if (largePageSize > 0 && numBytes >= largePageSize)
+    {
+        const auto roundedSize = (numBytes + largePageSize - 1) / largePageSize * largePageSize;
+        memory = VirtualAlloc(nullptr, roundedSize, MEM_RESERVE | MEM_COMMIT | MEM_LARGE_PAGES, PAGE_READWRITE);
+
+        if (memory != nullptr)
+        {
+            mappedSize = roundedSize;
+            hugePages = true;
+        }
+    }
+
+    if (memory == nullptr)
+        memory = VirtualAlloc(nullptr, numBytes, MEM_RESERVE | MEM_COMMIT, PAGE_READWRITE);
+   #else
+    if (numBytes >= hugePageSize)
+    {
+        const auto roundedSize = (numBytes + hugePageSize - 1) / hugePageSize * hugePageSize;
+
+       #if JUCE_MAC && defined (VM_FLAGS_SUPERPAGE_SIZE_2MB)
+        // Superpages are only offered on Intel Macs; elsewhere this fails and falls through
+        memory = mmap(nullptr, roundedSize, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANON, VM_FLAGS_SUPERPAGE_SIZE_2MB, 0);
+
+        if (memory == MAP_FAILED)
+            memory = nullptr;
+        else
+            hugePages = true;
+       #else
+        // A huge page can only back a whole aligned 2 MB region, so map one huge page
+        // more than needed and trim the ends back to the aligned span inside
+        const auto paddedSize = roundedSize + hugePageSize;
+        auto* padded = mmap(nullptr, paddedSize, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+
+        if (padded != MAP_FAILED)
+        {
+            const auto address = reinterpret_cast<std::uintptr_t>(padded);
+            const auto alignedAddress = (address + hugePageSize - 1) & ~static_cast<std::uintptr_t>(hugePageSize - 1);
+            const auto headSize = static_cast<size_t>(alignedAddress - address);
+            const auto tailSize = paddedSize - headSize - roundedSize;
+
+            memory = reinterpret_cast<void*>(alignedAddress);
+
+            if (headSize > 0)
+                munmap(padded, headSize);
+
+            if (tailSize > 0)
+                munmap(static_cast<char*>(memory) + roundedSize, tailSize);
+
+           #if defined (MADV_HUGEPAGE)
+            // Transparent huge pages back the mapping if the kernel has any to spare
+            hugePages = madvise(memory, roundedSize, MADV_HUGEPAGE) == 0;
+           #endif
+        }
+       #endif
+
+        if (memory != nullptr)
+            mappedSize = roundedSize;
+    }
+
+    if (memory == nullptr)
+    {
+        memory = mmap(nullptr, numBytes, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANON, -1, 0);
+
+        if (memory == MAP_FAILED)
+            memory = nullptr;
+    }
+   #endif
+
+    if (memory == nullptr)
+        mappedSize = 0;
+
+    return static_cast<char*>(memory);
+}
+
+void StateArena::unmapMemory(char* memory, size_t mappedSize) noexcept
+{
+   #if JUCE_WINDOWS
+    juce::ignoreUnused(mappedSize);
+    VirtualFree(memory, 0, MEM_RELEASE);
+   #else
+    munmap(memory, mappedSize);
+   #endif
+}
@@ -0,0 +1,137 @@
+/*
+  ==============================================================================
+
+    StateArena.h
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <juce_core/juce_core.h>
+#include <cstddef>
+#include <memory>
+#include <type_traits>
+
+//==============================================================================
+/**
+    One allocation holding the DSP state of a set of nodes, carved into regions
+    that each start on a cache line.
+
+    build() runs a layout function twice: once over a measuring Layout to find
+    the total size, and once more over the allocated memory, where every take()
+    hands back the region the first pass counted. A node's layout function only
+    takes its regions; the state in them is initialised afterwards, by reset().
+
+    Large arenas are mapped straight from the OS, aligned to and backed by huge
+    pages where the system allows it, so a whole chain's delay lines cost a
+    handful of TLB entries. Arenas of up to maxSlabBlockSize bytes would waste
+    most of a page each, so they are carved out of slabs shared by every arena
+    in the process instead. Either way the memory is handed back by release(),
+    the destructor or the next build().
+*/
+class StateArena
+{
+public:
+    //==============================================================================
+    /** Every region starts on a boundary of this many bytes. */
+    static constexpr size_t alignment = 64;
+
+    /** Arenas up to this size share slabs rather than being mapped on their own. */
+    static constexpr size_t maxSlabBlockSize = 64 * 1024;
+
+    //==============================================================================
+    /** Hands out consecutive aligned regions of the arena, or only counts them. */
+    class Layout
+    {
+    public:
+        /** Takes room for count values of Type. Returns nullptr while measuring;
+            otherwise the values are value-initialised. */
+        template<typename Type>
+        Type* take(size_t count) noexcept
+        {
+            static_assert(alignof(Type) <= alignment, "StateArena regions are only cache-line aligned");
+            static_assert(std::is_trivially_destructible<Type>::value, "StateArena never runs destructors");
+
+            const auto offset = size;
+            size += (count * sizeof(Type) + alignment - 1) / alignment * alignment;
+
+            if (base == nullptr)
+                return nullptr;
+
+            auto* region = reinterpret_cast<Type*>(base + offset);
+            std::uninitialized_value_construct_n(region, count);
+            return region;
+        }
+
+        /** True on the pass that hands out real memory. */
+        bool isAllocated() const noexcept { return base != nullptr; }
+
+        /** The bytes taken so far. */
+        size_t getSize() const noexcept { return size; }
+
+    private:
+        friend class StateArena;
+        explicit Layout(char* baseToUse) noexcept : base(baseToUse) {}
+
+        char* base = nullptr;
+        size_t size = 0;
+    };
+
+    //==============================================================================
+    StateArena() = default;
+    ~StateArena();
+
+    /** Sizes the arena for whatever layOut(Layout&) takes, then runs it again to
+        hand the regions out. Any earlier allocation is released first, so every
+        pointer the previous build handed out becomes invalid. */
+    template<typename Function>
+    void build(Function&& layOut)
+    {
+        Layout sizing(nullptr);
+        layOut(sizing);
+
+        allocate(sizing.getSize());
+
+        Layout layout(data);
+        layOut(layout);
+
+        jassert(layout.getSize() == sizing.getSize());
+    }
+
+    /** The bytes in use by the last build. */
+    size_t getSize() const noexcept { return size; }
+
+    /** True if the last build was mapped on its own and the system granted it huge pages. */
+    bool usesHugePages() const noexcept { return hugePages; }
+
+    /** Gives the memory back to the OS. Every pointer handed out becomes invalid. */
+    void release() noexcept;
+
+private:
+    //==============================================================================
+    /** Arenas at least this large ask for huge pages, and so do the shared slabs. */
+    static constexpr size_t hugePageSize = 2 * 1024 * 1024;
+
+    /** The slabs small arenas are carved from, shared by the whole process. */
+    class Slab;
+
+    char* data = nullptr;
+    size_t size = 0;
+    size_t mappedSize = 0;      // zero for a block taken from a slab
+    int slabSizeClass = -1;     // the slab block size the arena took, or -1 if it was mapped
+    bool hugePages = false;
+
+    /** Releases the current memory and takes numBytes of zeroed, cache-line aligned
+        memory, from a slab if it is small enough or else mapped on its own. */
+    void allocate(size_t numBytes);
+
+    /** Maps numBytes of zeroed memory, rounded up to and aligned on whole huge pages
+        if numBytes is at least hugePageSize and the system grants them. Returns
+        nullptr on failure. */
+    static char* mapMemory(size_t numBytes, size_t& mappedSize, bool& hugePages) noexcept;
+
+    static void unmapMemory(char* memory, size_t mappedSize) noexcept;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(StateArena)
+};
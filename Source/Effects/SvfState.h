@@ -0,0 +1,75 @@
+/*
+  ==============================================================================
+
+    SvfState.h
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <juce_dsp/juce_dsp.h>
+#include <juce_core/juce_core.h>
+#include <array>
+
+//==============================================================================
+/**
+    The six coefficients of a zero-delay-feedback state-variable filter section:
+    a1, a2 and a3 run the two integrators, and m0, m1 and m2 mix the input, band
+    and low outputs into the response. Held by value, like BiquadCoefficients.
+*/
+template<typename SampleType>
+struct SvfCoefficients
+{
+    std::array<SampleType, 6> values { { SampleType(0), SampleType(0), SampleType(0), SampleType(1), SampleType(0), SampleType(0) } };
+
+    /** Takes the values of a set designed in another precision. */
+    template<typename OtherType>
+    SvfCoefficients& operator= (const SvfCoefficients<OtherType>& other) noexcept
+    {
+        for (size_t index = 0; index < values.size(); ++index)
+            values[index] = static_cast<SampleType>(other.values[index]);
+
+        return *this;
+    }
+
+    const SampleType* getRawCoefficients() const noexcept { return values.data(); }
+};
+
+//==============================================================================
+/**
+    The state of one channel of a trapezoidal-integrated state-variable filter
+    section: the two integrators' equivalent currents.
+
+    Unlike a biquad's, this state means the same thing whatever the cutoff, so
+    the coefficients can jump or glide every few samples without the output
+    blowing up - any positive cutoff and damping is stable. SampleType may also
+    be a SIMDRegister, to filter one channel per lane.
+*/
+template<typename SampleType>
+struct SvfState
+{
+    /** How many coefficients processSample() reads. */
+    static constexpr size_t numCoefficients = 6;
+
+    SampleType s1 {};
+    SampleType s2 {};
+
+    /** Filters one sample. coefficients are the six values from
+        SvfCoefficients::getRawCoefficients(): a1, a2, a3, m0, m1, m2. */
+    SampleType processSample(SampleType input, const SampleType* coefficients) noexcept
+    {
+        const SampleType v3 = input - s2;
+        const SampleType v1 = coefficients[0] * s1 + coefficients[1] * v3;
+        const SampleType v2 = s2 + coefficients[1] * s1 + coefficients[2] * v3;
+        s1 = v1 + v1 - s1;
+        s2 = v2 + v2 - s2;
+        return coefficients[3] * input + coefficients[4] * v1 + coefficients[5] * v2;
+    }
+
+    void reset() noexcept
+    {
+        s1 = SampleType();
+        s2 = SampleType();
+    }
+};
@@ -9,200 +9,68 @@
 #include "ThreeBandEQNode.h"
 
 //==============================================================================
-ThreeBandEQNode::ThreeBandEQNode()
+template<typename SampleType>
+ThreeBandEQNode<SampleType>::ThreeBandEQNode()
 {
     // Initialize with default parameters
-    lowGain = 0.0f;
-    lowFreq = 200.0f;
-    midGain = 0.0f;
-    midFreq = 1000.0f;
-    midQ = 1.0f;
-    highGain = 0.0f;
-    highFreq = 8000.0f;
-}
-
-//==============================================================================
-void ThreeBandEQNode::prepare(const juce::dsp::ProcessSpec& spec)
-{
-    currentSampleRate = spec.sampleRate;
-    
-    // Prepare all filters
-    for (auto& filter : lowShelfFilters)
-    {
-        filter.prepare(spec);
-    }
-    
-    for (auto& filter : midFilters)
-    {
-        filter.prepare(spec);
-    }
-    
-    for (auto& filter : highShelfFilters)
-    {
-        filter.prepare(spec);
-    }
-    
-    // Update filter coefficients
-    updateLowShelfFilter();
-    updateMidFilter();
-    updateHighShelfFilter();
-    
-    // Reset state
-    reset();
-}
+    this->setNumBands(3);
 
-void ThreeBandEQNode::reset()
-{
-    // Reset all filters
-    for (auto& filter : lowShelfFilters)
-    {
-        filter.reset();
-    }
-    
-    for (auto& filter : midFilters)
-    {
-        filter.reset();
-    }
-    
-    for (auto& filter : highShelfFilters)
-    {
-        filter.reset();
-    }
-}
-
-//==============================================================================
-void ThreeBandEQNode::setLowGain(float gainDb)
-{
-    lowGain = juce::jlimit(-12.0f, 12.0f, gainDb);
-    updateLowShelfFilter();
-}
+    this->setBandType(lowBand, BandType::lowShelf);
+    this->setBandFrequency(lowBand, 200.0f);
+    this->setBandQ(lowBand, 0.707f);
 
-void ThreeBandEQNode::setLowFreq(float freqHz)
-{
-    lowFreq = juce::jlimit(20.0f, 500.0f, freqHz);
-    updateLowShelfFilter();
-}
+    this->setBandType(midBand, BandType::peak);
+    this->setBandFrequency(midBand, 1000.0f);
+    this->setBandQ(midBand, 1.0f);
 
-void ThreeBandEQNode::setMidGain(float gainDb)
-{
-    midGain = juce::jlimit(-12.0f, 12.0f, gainDb);
-    updateMidFilter();
+    this->setBandType(highBand, BandType::highShelf);
+    this->setBandFrequency(highBand, 8000.0f);
+    this->setBandQ(highBand, 0.707f);
 }
 
-void ThreeBandEQNode::setMidFreq(float freqHz)
+//==============================================================================
+template<typename SampleType>
+void ThreeBandEQNode<SampleType>::setLowGain(float gainDb)
 {
-    midFreq = juce::jlimit(200.0f, 5000.0f, freqHz);
-    updateMidFilter();
+    this->setBandGain(lowBand, juce::jlimit(-12.0f, 12.0f, gainDb));
 }
 
-void ThreeBandEQNode::setMidQ(float qValue)
+template<typename SampleType>
+void ThreeBandEQNode<SampleType>::setLowFreq(float freqHz)
 {
-    midQ = juce::jlimit(0.1f, 10.0f, qValue);
-    updateMidFilter();
+    this->setBandFrequency(lowBand, juce::jlimit(20.0f, 500.0f, freqHz));
 }
 
-void ThreeBandEQNode::setHighGain(float gainDb)
+template<typename SampleType>
+void ThreeBandEQNode<SampleType>::setMidGain(float gainDb)
 {
-    highGain = juce::jlimit(-12.0f, 12.0f, gainDb);
-    updateHighShelfFilter();
+    this->setBandGain(midBand, juce::jlimit(-12.0f, 12.0f, gainDb));
 }
 
-void ThreeBandEQNode::setHighFreq(float freqHz)
+template<typename SampleType>
+void ThreeBandEQNode<SampleType>::setMidFreq(float freqHz)
 {
-    highFreq = juce::jlimit(2000.0f, 20000.0f, freqHz);
-    updateHighShelfFilter();
+    this->setBandFrequency(midBand, juce::jlimit(200.0f, 5000.0f, freqHz));
 }
 
-//==============================================================================
-void ThreeBandEQNode::updateLowShelfFilter()
+template<typename SampleType>
+void ThreeBandEQNode<SampleType>::setMidQ(float qValue)
 {
-    if (currentSampleRate > 0.0)
-    {
-        auto coefficients = juce::dsp::IIR::Coefficients<float>::makeLowShelf(
-            currentSampleRate, lowFreq, 0.707f, juce::Decibels::decibelsToGain(lowGain));
-        
-        for (auto& filter : lowShelfFilters)
-        {
-            filter.coefficients = coefficients;
-        }
-    }
+    this->setBandQ(midBand, juce::jlimit(0.1f, 10.0f, qValue));
 }
 
-void ThreeBandEQNode::updateMidFilter()
+template<typename SampleType>
+void ThreeBandEQNode<SampleType>::setHighGain(float gainDb)
 {
-    if (currentSampleRate > 0.0)
-    {
-        auto coefficients = juce::dsp::IIR::Coefficients<float>::makePeakFilter(
-            currentSampleRate, midFreq, midQ, juce::Decibels::decibelsToGain(midGain));
-        
-        for (auto& filter : midFilters)
-        {
-            filter.coefficients = coefficients;
-        }
-    }
+    this->setBandGain(highBand, juce::jlimit(-12.0f, 12.0f, gainDb));
 }
 
-void ThreeBandEQNode::updateHighShelfFilter()
+template<typename SampleType>
+void ThreeBandEQNode<SampleType>::setHighFreq(float freqHz)
 {
-    if (currentSampleRate > 0.0)
-    {
-        auto coefficients = juce::dsp::IIR::Coefficients<float>::makeHighShelf(
-            currentSampleRate, highFreq, 0.707f, juce::Decibels::decibelsToGain(highGain));
-        
-        for (auto& filter : highShelfFilters)
-        {
-            filter.coefficients = coefficients;
-        }
-    }
+    this->setBandFrequency(highBand, juce::jlimit(2000.0f, 20000.0f, freqHz));
 }
 
 //==============================================================================
-template<typename ProcessContext>
-void ThreeBandEQNode::process(const ProcessContext& context) noexcept
-{
-    // Handle bypassed state
-    if (context.isBypassed)
-    {
-        if (context.usesSeparateInputAndOutputBlocks())
-            context.getOutputBlock().copyFrom(context.getInputBlock());
-        return;
-    }
-
-    auto& inputBlock = context.getInputBlock();
-    auto& outputBlock = context.getOutputBlock();
-    auto numChannels = outputBlock.getNumChannels();
-    auto numSamples = outputBlock.getNumSamples();
-
-    // Copy input to output first
-    if (context.usesSeparateInputAndOutputBlocks())
-        outputBlock.copyFrom(inputBlock);
-
-    // Process each channel
-    for (size_t channel = 0; channel < numChannels; ++channel)
-    {
-        auto* channelData = outputBlock.getChannelPointer(channel);
-        
-        for (size_t sample = 0; sample < numSamples; ++sample)
-        {
-            float inputSample = channelData[sample];
-            
-            // Process through each filter stage
-            float processedSample = inputSample;
-            
-            // Low shelf filter
-            processedSample = lowShelfFilters[channel].processSample(processedSample);
-            
-            // Mid parametric filter
-            processedSample = midFilters[channel].processSample(processedSample);
-            
-            // High shelf filter
-            processedSample = highShelfFilters[channel].processSample(processedSample);
-            
-            channelData[sample] = processedSample;
-        }
-    }
-}
-
-// Explicit template instantiations for common ProcessContext types
-template void ThreeBandEQNode::process<juce::dsp::ProcessContextReplacing<float>>(const juce::dsp::ProcessContextReplacing<float>&) noexcept;
-template void ThreeBandEQNode::process<juce::dsp::ProcessContextNonReplacing<float>>(const juce::dsp::ProcessContextNonReplacing<float>&) noexcept;
+template class ThreeBandEQNode<float>;
+template class ThreeBandEQNode<double>;
@@ -0,0 +1,336 @@
+/*
+  ==============================================================================
+
+    OutsetVerbAPVTSAdapter.cpp
+
+  ==============================================================================
+*/
+
+#include "OutsetVerbAPVTSAdapter.h"
+
+//==============================================================================
+const std::array<const char*, OutsetVerbParameters::numParameters> OutsetVerbAPVTSAdapter::parameterIDs =
+{
+    "bitDepth", "sampleRateReduction", "bitCrusherMix",
+    "delayTime", "delayFeedback", "delayMix", "delayLowPassCutoff",
+    "eqBands",
+    "roomSize", "damping", "width", "freezeMode", "reverbMix",
+    "bitCrusherBypass", "delayBypass", "eqBypass", "reverbBypass",
+    "chainSlot1", "chainSlot2", "chainSlot3", "chainSlot4",
+    "chainSlot5", "chainSlot6", "chainSlot7", "chainSlot8",
+    "chainSlot2Parallel", "chainSlot3Parallel", "chainSlot4Parallel",
+    "chainSlot5Parallel", "chainSlot6Parallel", "chainSlot7Parallel", "chainSlot8Parallel",
+    "chainSlot1Level", "chainSlot2Level", "chainSlot3Level", "chainSlot4Level",
+    "chainSlot5Level", "chainSlot6Level", "chainSlot7Level", "chainSlot8Level",
+    "eqBand1Type", "eqBand2Type", "eqBand3Type", "eqBand4Type",
+    "eqBand5Type", "eqBand6Type", "eqBand7Type", "eqBand8Type",
+    // Bands 1 to 3 took over from the original three-band EQ, so sessions and
+    // automation made with it still reach them through its IDs
+    "lowFreq", "midFreq", "highFreq", "eqBand4Freq",
+    "eqBand5Freq", "eqBand6Freq", "eqBand7Freq", "eqBand8Freq",
+    "lowGain", "midGain", "highGain", "eqBand4Gain",
+    "eqBand5Gain", "eqBand6Gain", "eqBand7Gain", "eqBand8Gain",
+    "eqBand1Q", "midQ", "eqBand3Q", "eqBand4Q",
+    "eqBand5Q", "eqBand6Q", "eqBand7Q", "eqBand8Q",
+    "eqBand1Slope", "eqBand2Slope", "eqBand3Slope", "eqBand4Slope",
+    "eqBand5Slope", "eqBand6Slope", "eqBand7Slope", "eqBand8Slope"
+};
+
+//==============================================================================
+OutsetVerbAPVTSAdapter::OutsetVerbAPVTSAdapter(juce::AudioProcessorValueTreeState& apvtsRef)
+    : apvts(apvtsRef)
+{
+    const auto defaults = OutsetVerbParameters::getDefaults();
+
+    // Resolve the string-keyed lookups once so the audio thread only reads atomics
+    for (size_t index = 0; index < parameterHandles.size(); ++index)
+    {
+        parameterHandles[index] = apvts.getRawParameterValue(parameterIDs[index]);
+        jassert(parameterHandles[index] != nullptr);
+
+        // Headless hosts start from getDefaults(), so it has to agree with the layout
+        auto* parameter = apvts.getParameter(parameterIDs[index]);
+        jassert(std::abs(parameter->convertFrom0to1(parameter->getDefaultValue()) - defaults.values[index])
+                <= 1.0e-3f * juce::jmax(1.0f, std::abs(defaults.values[index])));
+        juce::ignoreUnused(parameter, defaults);
+    }
+
+    eqTopologyHandle = apvts.getRawParameterValue("eqTopology");
+    jassert(eqTopologyHandle != nullptr);
+
+    lastPushedParameters = readParameters();
+}
+
+//==============================================================================
+OutsetVerbParameters OutsetVerbAPVTSAdapter::readParameters() const
+{
+    OutsetVerbParameters parameters;
+
+    for (size_t index = 0; index < parameterHandles.size(); ++index)
+        parameters.values[index] = parameterHandles[index]->load(std::memory_order_relaxed);
+
+    return parameters;
+}
+
+template<typename SampleType>
+void OutsetVerbAPVTSAdapter::pushParameters(OutsetVerbEngine<SampleType>& engine, bool force)
+{
+    const auto parameters = readParameters();
+
+    // Nothing automated this block - the engine is already up to date
+    if (! force && parameters == lastPushedParameters)
+        return;
+
+    lastPushedParameters = parameters;
+    engine.setParameters(parameters);
+}
+
+template void OutsetVerbAPVTSAdapter::pushParameters<float>(OutsetVerbEngine<float>&, bool);
+template void OutsetVerbAPVTSAdapter::pushParameters<double>(OutsetVerbEngine<double>&, bool);
+
+template<typename SampleType>
+typename OutsetVerbEngine<SampleType>::EQTopology OutsetVerbAPVTSAdapter::getEQTopology() const
+{
+    using EQTopology = typename OutsetVerbEngine<SampleType>::EQTopology;
+
+    // The choices are listed in the order of the enum
+    const int index = juce::roundToInt(eqTopologyHandle->load(std::memory_order_relaxed));
+    return static_cast<EQTopology>(juce::jlimit(0, static_cast<int>(EQTopology::linearPhase), index));
+}
+
+template OutsetVerbEngine<float>::EQTopology OutsetVerbAPVTSAdapter::getEQTopology<float>() const;
+template OutsetVerbEngine<double>::EQTopology OutsetVerbAPVTSAdapter::getEQTopology<double>() const;
+
+juce::String OutsetVerbAPVTSAdapter::getParameterID(int index)
+{
+    return parameterIDs[static_cast<size_t>(index)];
+}
+
+//==============================================================================
+juce::AudioProcessorValueTreeState::ParameterLayout OutsetVerbAPVTSAdapter::createParameterLayout()
+{
+    juce::AudioProcessorValueTreeState::ParameterLayout layout;
+
+    // BitCrusher parameters
+    layout.add(std::make_unique<juce::AudioParameterFloat>(
+        juce::ParameterID("bitDepth", 1),
+        "Bit Depth",
+        juce::NormalisableRange<float>(1.0f, 16.0f, 1.0f),
+        16.0f)
+    );
+
+    layout.add(std::make_unique<juce::AudioParameterFloat>(
+        juce::ParameterID("sampleRateReduction", 1),
+        "Sample Rate Reduction",
+        juce::NormalisableRange<float>(1.0f, 50.0f, 1.0f),
+        1.0f)
+    );
+
+    layout.add(std::make_unique<juce::AudioParameterFloat>(
+        juce::ParameterID("bitCrusherMix", 1),
+        "BitCrusher Mix",
+        juce::NormalisableRange<float>(0.0f, 1.0f, 0.01f),
+        0.0f)
+    );
+
+    // Delay parameters
+    layout.add(std::make_unique<juce::AudioParameterFloat>(
+        juce::ParameterID("delayTime", 1),
+        "Delay Time",
+        juce::NormalisableRange<float>(0.0f, 2000.0f, 1.0f),
+        250.0f)
+    );
+
+    layout.add(std::make_unique<juce::AudioParameterFloat>(
+        juce::ParameterID("delayFeedback", 1),
+        "Delay Feedback",
+        juce::NormalisableRange<float>(0.0f, 0.95f, 0.01f),
+        0.3f)
+    );
+
+    layout.add(std::make_unique<juce::AudioParameterFloat>(
+        juce::ParameterID("delayMix", 1),
+        "Delay Mix",
+        juce::NormalisableRange<float>(0.0f, 1.0f, 0.01f),
+        0.0f)
+    );
+
+    layout.add(std::make_unique<juce::AudioParameterFloat>(
+        juce::ParameterID("delayLowPassCutoff", 1),
+        "Delay Low Pass",
+        juce::NormalisableRange<float>(200.0f, 20000.0f, 1.0f),
+        8000.0f)
+    );
+
+    // EQ parameters - bands past the count are off
+    layout.add(std::make_unique<juce::AudioParameterInt>(
+        juce::ParameterID("eqBands", 1),
+        "EQ Bands",
+        0, OutsetVerbParameters::maxEQBands,
+        3)
+    );
+
+    const auto defaults = OutsetVerbParameters::getDefaults();
+
+    // The original low, mid and high controls keep their ranges as well as their IDs,
+    // as hosts record automation as normalised values
+    const std::array<juce::NormalisableRange<float>, 3> legacyFreqRanges { { { 20.0f, 500.0f, 1.0f },
+                                                                            { 200.0f, 5000.0f, 1.0f },
+                                                                            { 2000.0f, 20000.0f, 1.0f } } };
+    const juce::NormalisableRange<float> legacyGainRange(-12.0f, 12.0f, 0.1f);
+    const juce::NormalisableRange<float> legacyQRange(0.1f, 10.0f, 0.1f);
+
+    for (int band = 1; band <= OutsetVerbParameters::maxEQBands; ++band)
+    {
+        const auto prefix = "eqBand" + juce::String(band);
+        const auto name = "EQ Band " + juce::String(band);
+        const int index = band - 1;
+        const bool isLegacyBand = band <= static_cast<int>(legacyFreqRanges.size());
+        const bool hasLegacyQ = band == 2;  // Only the mid band had a Q control
+
+        const auto freqID = getParameterID(OutsetVerbParameters::eqBand1FreqParam + index);
+        const auto gainID = getParameterID(OutsetVerbParameters::eqBand1GainParam + index);
+        const auto qID = getParameterID(OutsetVerbParameters::eqBand1QParam + index);
+
+        layout.add(std::make_unique<juce::AudioParameterChoice>(
+            juce::ParameterID(prefix + "Type", 1),
+            name + " Type",
+            juce::StringArray{"Off", "Peak", "Low Shelf", "High Shelf", "High Pass", "Low Pass"},
+            static_cast<int>(defaults[OutsetVerbParameters::eqBand1TypeParam + index]))
+        );
+
+        layout.add(std::make_unique<juce::AudioParameterFloat>(
+            juce::ParameterID(freqID, 1),
+            name + " Freq",
+            isLegacyBand ? legacyFreqRanges[static_cast<size_t>(index)]
+                         : juce::NormalisableRange<float>(20.0f, 20000.0f, 1.0f, 0.25f),
+            defaults[OutsetVerbParameters::eqBand1FreqParam + index])
+        );
+
+        layout.add(std::make_unique<juce::AudioParameterFloat>(
+            juce::ParameterID(gainID, 1),
+            name + " Gain",
+            isLegacyBand ? legacyGainRange : juce::NormalisableRange<float>(-24.0f, 24.0f, 0.1f),
+            0.0f)
+        );
+
+        layout.add(std::make_unique<juce::AudioParameterFloat>(
+            juce::ParameterID(qID, 1),
+            name + " Q",
+            hasLegacyQ ? legacyQRange : juce::NormalisableRange<float>(0.1f, 10.0f, 0.001f, 0.5f),
+            defaults[OutsetVerbParameters::eqBand1QParam + index])
+        );
+
+        layout.add(std::make_unique<juce::AudioParameterChoice>(
+            juce::ParameterID(prefix + "Slope", 1),
+            name + " Slope",
+            juce::StringArray{"12 dB/oct", "24 dB/oct", "48 dB/oct"},
+            0)  // Default: 12 dB/oct
+        );
+    }
+
+    // Reverb parameters
+    layout.add(std::make_unique<juce::AudioParameterFloat>(
+        juce::ParameterID("roomSize", 1),
+        "Room Size",
+        juce::NormalisableRange<float>(0.0f, 1.0f, 0.01f),
+        0.5f)
+    );
+
+    layout.add(std::make_unique<juce::AudioParameterFloat>(
+        juce::ParameterID("damping", 1),
+        "Dampening",
+        juce::NormalisableRange<float>(0.0f, 1.0f, 0.01f),
+        0.5f)
+    );
+
+    layout.add(std::make_unique<juce::AudioParameterFloat>(
+        juce::ParameterID("reverbMix", 1),
+        "Reverb Mix",
+        juce::NormalisableRange<float>(0.0f, 1.0f, 0.01f),
+        0.0f)
+    );
+
+    layout.add(std::make_unique<juce::AudioParameterFloat>(
+        juce::ParameterID("width", 1),
+        "Width",
+        juce::NormalisableRange<float>(0.0f, 1.0f, 0.01f),
+        0.5f)
+    );
+
+    layout.add(std::make_unique<juce::AudioParameterBool>(
+        juce::ParameterID("freezeMode", 1),
+        "Freeze",
+        false)
+    );
+
+    // Bypass parameters - a bypassed effect passes its input through and lets its tail ring out
+    layout.add(std::make_unique<juce::AudioParameterBool>(
+        juce::ParameterID("bitCrusherBypass", 1),
+        "BitCrusher Bypass",
+        false)
+    );
+
+    layout.add(std::make_unique<juce::AudioParameterBool>(
+        juce::ParameterID("delayBypass", 1),
+        "Delay Bypass",
+        false)
+    );
+
+    layout.add(std::make_unique<juce::AudioParameterBool>(
+        juce::ParameterID("eqBypass", 1),
+        "EQ Bypass",
+        false)
+    );
+
+    layout.add(std::make_unique<juce::AudioParameterBool>(
+        juce::ParameterID("reverbBypass", 1),
+        "Reverb Bypass",
+        false)
+    );
+
+    // Chain configuration parameters - any effect may appear in any number of slots
+    for (int slot = 1; slot <= OutsetVerbParameters::maxSlots; ++slot)
+    {
+        layout.add(std::make_unique<juce::AudioParameterChoice>(
+            juce::ParameterID("chainSlot" + juce::String(slot), 1),
+            "Chain Slot " + juce::String(slot),
+            juce::StringArray{"None", "Bit Crusher", "Delay", "EQ", "Reverb"},
+            0)  // Default: None
+        );
+    }
+
+    // Routing parameters - a parallel slot shares its input with the slot before it
+    // and their outputs are summed, each scaled by its slot level
+    for (int slot = 2; slot <= OutsetVerbParameters::maxSlots; ++slot)
+    {
+        layout.add(std::make_unique<juce::AudioParameterBool>(
+            juce::ParameterID("chainSlot" + juce::String(slot) + "Parallel", 1),
+            "Chain Slot " + juce::String(slot) + " Parallel",
+            false)
+        );
+    }
+
+    for (int slot = 1; slot <= OutsetVerbParameters::maxSlots; ++slot)
+    {
+        layout.add(std::make_unique<juce::AudioParameterFloat>(
+            juce::ParameterID("chainSlot" + juce::String(slot) + "Level", 1),
+            "Chain Slot " + juce::String(slot) + " Level",
+            juce::NormalisableRange<float>(0.0f, 1.0f, 0.01f),
+            1.0f)
+        );
+    }
+
+    // EQ structure - it changes the latency, which hosts only pick up between
+    // blocks, so it switches on the message thread and cannot be automated.
+    // Linear Phase convolves in float even when the host runs in double.
+    layout.add(std::make_unique<juce::AudioParameterChoice>(
+        juce::ParameterID("eqTopology", 1),
+        "EQ Topology",
+        juce::StringArray{"Biquad", "State Variable", "Linear Phase"},
+        0,  // Default: Biquad
+        juce::AudioParameterChoiceAttributes().withAutomatable(false))
+    );
+
+    return layout;
+}
@@ -0,0 +1,79 @@
+/*
+  ==============================================================================
+
+    OutsetVerbAPVTSAdapter.h
+    
+    Connects an AudioProcessorValueTreeState to the Outset-Verb engine.
+    The engine itself only knows about plain OutsetVerbParameters snapshots.
+    
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <juce_audio_processors/juce_audio_processors.h>
+#include <array>
+#include <atomic>
+#include "OutsetVerbEngine.h"
+#include "OutsetVerbParameters.h"
+
+//==============================================================================
+/**
+    Owns the plugin's parameter layout and turns the APVTS values into
+    OutsetVerbParameters snapshots for the engine.
+*/
+class OutsetVerbAPVTSAdapter
+{
+public:
+    //==============================================================================
+    /** Resolves the raw value of every parameter in the given APVTS, which must
+        have been created from createParameterLayout(). */
+    explicit OutsetVerbAPVTSAdapter(juce::AudioProcessorValueTreeState& apvtsRef);
+    
+    ~OutsetVerbAPVTSAdapter() = default;
+    
+    //==============================================================================
+    /** Reads every parameter into a snapshot. */
+    OutsetVerbParameters readParameters() const;
+    
+    /** Hands the current values to the engine if anything changed since the last
+        call, or unconditionally when force is true. Called from the audio thread
+        before each block, so automation keeps the same timing it has always had.
+        Chain orders are compiled separately, by OutsetVerbEngine::updateChainOrder(). */
+    template<typename SampleType>
+    void pushParameters(OutsetVerbEngine<SampleType>& engine, bool force = false);
+    
+    /** The EQ structure the settings ask for. It changes the plugin's latency, so
+        it is not part of the snapshots; the processor re-prepares the engine for it.
+        Linear Phase runs its convolution in float, also when the host processes
+        in double. */
+    template<typename SampleType>
+    typename OutsetVerbEngine<SampleType>::EQTopology getEQTopology() const;
+    
+    //==============================================================================
+    /** Creates the parameter layout for all Outset-Verb parameters.
+        This static method can be called to get the parameter layout for
+        incorporating into an APVTS. */
+    static juce::AudioProcessorValueTreeState::ParameterLayout createParameterLayout();
+    
+    /** The APVTS ID of the parameter at the given OutsetVerbParameters::ParameterIndex.
+        Bands 1 to 3 answer to the IDs of the original low, mid and high EQ controls. */
+    static juce::String getParameterID(int index);
+    
+private:
+    //==============================================================================
+    /** APVTS IDs, in OutsetVerbParameters::ParameterIndex order. */
+    static const std::array<const char*, OutsetVerbParameters::numParameters> parameterIDs;
+    
+    // Reference to external APVTS (not owned by this class)
+    juce::AudioProcessorValueTreeState& apvts;
+    
+    // Raw parameter handles, resolved once in the constructor
+    std::array<std::atomic<float>*, OutsetVerbParameters::numParameters> parameterHandles {};
+    std::atomic<float>* eqTopologyHandle = nullptr;
+    
+    // The snapshot last handed to the engine
+    OutsetVerbParameters lastPushedParameters;
+    
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(OutsetVerbAPVTSAdapter)
+};
@@ -0,0 +1,451 @@
+/*
+  ==============================================================================
+
+    OutsetVerbBatchEngine.cpp
+
+    Batched multi-instance engine implementation for Outset-Verb.
+
+  ==============================================================================
+*/
+
+#include "OutsetVerbBatchEngine.h"
+
+//==============================================================================
+OutsetVerbBatchEngine::OutsetVerbBatchEngine(const OutsetVerbParameters& initialParameters)
+{
+    buildChain(initialParameters);
+
+    for (size_t lane = 0; lane < numLanes; ++lane)
+        updateLaneParameters(lane, initialParameters, true);
+}
+
+void OutsetVerbBatchEngine::setParameters(size_t lane, const OutsetVerbParameters& newParameters)
+{
+    jassert(lane < numLanes);
+    updateLaneParameters(lane, newParameters);
+}
+
+//==============================================================================
+void OutsetVerbBatchEngine::prepare(const juce::dsp::ProcessSpec& spec)
+{
+    // The tiles are sized by the channel count alone, so they are kept while it stays put
+    const bool keepTiles = numChannels == static_cast<size_t>(spec.numChannels);
+
+    currentSampleRate = spec.sampleRate;
+    numChannels = static_cast<size_t>(spec.numChannels);
+
+    // The nodes only ever see one tile at a time, whatever the host block size
+    auto tileSpec = spec;
+    tileSpec.maximumBlockSize = static_cast<juce::uint32>(tileSize);
+
+    forEachNode(bitCrushers, [&tileSpec](auto& node) { node.prepare(tileSpec); });
+    forEachNode(delays, [&tileSpec](auto& node) { node.prepare(tileSpec); });
+    forEachNode(eqs, [&tileSpec](auto& node) { node.prepare(tileSpec); });
+    forEachNode(reverbs, [&tileSpec](auto& node) { node.prepare(tileSpec); });
+
+    // Re-push every lane's values to the freshly prepared nodes
+    for (size_t lane = 0; lane < numLanes; ++lane)
+        updateLaneParameters(lane, lastParameterValues[lane], true);
+
+    if (! keepTiles)
+    {
+        tileBlock = juce::dsp::AudioBlock<BatchLane>(tileMemory, numChannels, tileSize);
+        stageInputBlock = juce::dsp::AudioBlock<BatchLane>(stageInputMemory, numChannels, tileSize);
+        branchBlock = juce::dsp::AudioBlock<BatchLane>(branchMemory, numChannels, tileSize);
+        dryBlock = juce::dsp::AudioBlock<BatchLane>(dryMemory, numChannels, tileSize);
+    }
+
+    // Start every lane at its targets - no ramps on load
+    for (auto& levels : slotLevels)
+        for (auto& level : levels)
+            level.reset(currentSampleRate, smoothingTimeSeconds);
+
+    for (int index = 0; index < numSteps; ++index)
+        for (auto& engage : steps[static_cast<size_t>(index)].engage)
+            engage.reset(currentSampleRate, engageRampSeconds);
+
+    reset();
+}
+
+void OutsetVerbBatchEngine::processBlock(const std::array<juce::AudioBuffer<float>*, numLanes>& buffers)
+{
+    int numSamples = -1;
+
+    for (const auto* buffer : buffers)
+    {
+        if (buffer == nullptr)
+            continue;
+
+        jassert(numSamples < 0 || buffer->getNumSamples() == numSamples);
+        numSamples = numSamples < 0 ? buffer->getNumSamples() : juce::jmin(numSamples, buffer->getNumSamples());
+    }
+
+    // Nothing to do if there are no samples or the batch is not prepared
+    if (numSamples <= 0 || numChannels == 0)
+        return;
+
+    for (int start = 0; start < numSamples; start += tileSize)
+    {
+        const int tileSamples = juce::jmin(tileSize, numSamples - start);
+        auto tile = tileBlock.getSubBlock(0, static_cast<size_t>(tileSamples));
+
+        // Interleave every lane's audio into the tile. Missing lanes and channels run on silence.
+        tile.clear();
+
+        for (size_t lane = 0; lane < numLanes; ++lane)
+        {
+            const auto* buffer = buffers[lane];
+
+            if (buffer == nullptr)
+                continue;
+
+            const auto channelsToRead = juce::jmin(numChannels, static_cast<size_t>(buffer->getNumChannels()));
+
+            for (size_t channel = 0; channel < channelsToRead; ++channel)
+            {
+                const auto* source = buffer->getReadPointer(static_cast<int>(channel), start);
+                auto* destination = tile.getChannelPointer(channel);
+
+                for (int sample = 0; sample < tileSamples; ++sample)
+                    destination[sample].set(lane, source[sample]);
+            }
+        }
+
+        processTile(tile);
+
+        // ...and hand each lane's result back to its own buffer
+        for (size_t lane = 0; lane < numLanes; ++lane)
+        {
+            auto* buffer = buffers[lane];
+
+            if (buffer == nullptr)
+                continue;
+
+            const auto channelsToWrite = juce::jmin(numChannels, static_cast<size_t>(buffer->getNumChannels()));
+
+            for (size_t channel = 0; channel < channelsToWrite; ++channel)
+            {
+                const auto* source = tile.getChannelPointer(channel);
+                auto* destination = buffer->getWritePointer(static_cast<int>(channel), start);
+
+                for (int sample = 0; sample < tileSamples; ++sample)
+                    destination[sample] = source[sample].get(lane);
+            }
+        }
+    }
+}
+
+void OutsetVerbBatchEngine::reset()
+{
+    for (int index = 0; index < numSteps; ++index)
+    {
+        const auto& step = steps[static_cast<size_t>(index)];
+
+        if (step.reset != nullptr)
+            step.reset(step.node);
+    }
+}
+
+void OutsetVerbBatchEngine::setSmoothingTime(double seconds)
+{
+    smoothingTimeSeconds = seconds;
+
+    for (auto& levels : slotLevels)
+        for (auto& level : levels)
+            level.reset(currentSampleRate, smoothingTimeSeconds);
+
+    forEachNode(bitCrushers, [seconds](auto& node) { node.setSmoothingTime(seconds); });
+    forEachNode(delays, [seconds](auto& node) { node.setSmoothingTime(seconds); });
+    forEachNode(eqs, [seconds](auto& node) { node.setSmoothingTime(seconds); });
+}
+
+//==============================================================================
+void OutsetVerbBatchEngine::buildChain(const Parameters& parameters)
+{
+    numSteps = 0;
+
+    for (int slot = 0; slot < maxSlots; ++slot)
+    {
+        // Stages group the same way as in OutsetVerbEngine: a slot switched parallel
+        // joins the stage of the slot before it
+        const bool parallelWithPrevious = slot > 0 && parameters[Parameters::chainSlot2ParallelParam + slot - 1] > 0.5f;
+        const bool parallelWithNext = slot < maxSlots - 1 && parameters[Parameters::chainSlot2ParallelParam + slot] > 0.5f;
+
+        auto& step = steps[static_cast<size_t>(numSteps++)];
+        step.slot = slot;
+        step.opensParallelStage = parallelWithNext && ! parallelWithPrevious;
+        step.isBranch = parallelWithPrevious;
+
+        const int effectType = static_cast<int>(parameters[Parameters::chainSlot1Param + slot]);
+
+        switch (effectType)
+        {
+            case EffectType::bitCrusher:
+                bindStep(step, bitCrushers);
+                break;
+            case EffectType::delay:
+                bindStep(step, delays);
+                break;
+            case EffectType::eq:
+                bindStep(step, eqs);
+                break;
+            case EffectType::reverb:
+                bindStep(step, reverbs);
+                break;
+            default:
+                continue;
+        }
+
+        step.effect = static_cast<EffectType>(effectType);
+    }
+}
+
+void OutsetVerbBatchEngine::updateLaneParameters(size_t lane, const Parameters& parameters, bool forceUpdate)
+{
+    auto& lastValues = lastParameterValues[lane];
+
+    // Note which parameters moved since this lane's last snapshot
+    std::bitset<Parameters::numParameters> changed;
+
+    for (int index = 0; index < Parameters::numParameters; ++index)
+    {
+        const float value = parameters[index];
+
+        if (forceUpdate || value != lastValues[index])
+        {
+            lastValues[index] = value;
+            changed.set(index);
+        }
+    }
+
+    if (changed.none())
+        return;
+
+    const auto& values = lastValues;
+
+    forEachNode(bitCrushers, [&](auto& node)
+    {
+        if (changed[Parameters::bitDepthParam])
+            node.setBitDepth(lane, values[Parameters::bitDepthParam]);
+        if (changed[Parameters::sampleRateReductionParam])
+            node.setSampleRateReduction(lane, values[Parameters::sampleRateReductionParam]);
+        if (changed[Parameters::bitCrusherMixParam])
+            node.setMix(lane, values[Parameters::bitCrusherMixParam]);
+    });
+
+    forEachNode(delays, [&](auto& node)
+    {
+        if (changed[Parameters::delayTimeParam])
+            node.setDelayTime(lane, values[Parameters::delayTimeParam]);
+        if (changed[Parameters::delayFeedbackParam])
+            node.setFeedback(lane, values[Parameters::delayFeedbackParam]);
+        if (changed[Parameters::delayMixParam])
+            node.setMix(lane, values[Parameters::delayMixParam]);
+        if (changed[Parameters::delayLowPassCutoffParam])
+            node.setLowPassCutoff(lane, values[Parameters::delayLowPassCutoffParam]);
+    });
+
+    // As in OutsetVerbEngine, bands past the count are switched off
+    const int numEQBands = values.getNumEQBands();
+
+    forEachNode(eqs, [&](auto& node)
+    {
+        using EQ = BatchParametricEQNode;
+
+        for (int band = 0; band < Parameters::maxEQBands; ++band)
+        {
+            if (changed[Parameters::eqNumBandsParam] || changed[Parameters::eqBand1TypeParam + band])
+            {
+                const int type = band < numEQBands ? juce::roundToInt(values[Parameters::eqBand1TypeParam + band]) : Parameters::bandOff;
+                node.setBandType(lane, band, static_cast<EQ::BandType>(juce::jlimit(0, static_cast<int>(Parameters::bandLowPass), type)));
+            }
+
+            if (changed[Parameters::eqBand1FreqParam + band])
+                node.setBandFrequency(lane, band, values[Parameters::eqBand1FreqParam + band]);
+            if (changed[Parameters::eqBand1GainParam + band])
+                node.setBandGain(lane, band, values[Parameters::eqBand1GainParam + band]);
+            if (changed[Parameters::eqBand1QParam + band])
+                node.setBandQ(lane, band, values[Parameters::eqBand1QParam + band]);
+
+            if (changed[Parameters::eqBand1SlopeParam + band])
+            {
+                const int slope = juce::roundToInt(values[Parameters::eqBand1SlopeParam + band]);
+                node.setBandSlope(lane, band, static_cast<EQ::CutSlope>(juce::jlimit(0, static_cast<int>(Parameters::slope48dB), slope)));
+            }
+        }
+    });
+
+    forEachNode(reverbs, [&](auto& node)
+    {
+        if (changed[Parameters::roomSizeParam])
+            node.setRoomSize(lane, values[Parameters::roomSizeParam]);
+        if (changed[Parameters::dampingParam])
+            node.setDamping(lane, values[Parameters::dampingParam]);
+        if (changed[Parameters::widthParam])
+            node.setWidth(lane, values[Parameters::widthParam]);
+        if (changed[Parameters::freezeModeParam])
+            node.setFreezeMode(lane, values[Parameters::freezeModeParam] > 0.5f ? 1.0f : 0.0f);
+        if (changed[Parameters::reverbMixParam])
+            node.setMix(lane, values[Parameters::reverbMixParam]);
+    });
+
+    for (int slot = 0; slot < maxSlots; ++slot)
+        if (changed[Parameters::chainSlot1LevelParam + slot])
+            slotLevels[static_cast<size_t>(slot)][lane].setTargetValue(values[Parameters::chainSlot1LevelParam + slot]);
+
+    // Bypassed effects and identity settings fade out in this lane only
+    for (int index = 0; index < numSteps; ++index)
+    {
+        auto& step = steps[static_cast<size_t>(index)];
+
+        if (step.process != nullptr)
+            step.engage[lane].setTargetValue(values.isEngaged(step.effect) ? 1.0f : 0.0f);
+    }
+}
+
+//==============================================================================
+void OutsetVerbBatchEngine::processTile(const juce::dsp::AudioBlock<BatchLane>& block)
+{
+    const auto numSamples = block.getNumSamples();
+    auto stageInput = stageInputBlock.getSubBlock(0, numSamples);
+    auto branch = branchBlock.getSubBlock(0, numSamples);
+
+    for (int index = 0; index < numSteps; ++index)
+    {
+        auto& step = steps[static_cast<size_t>(index)];
+
+        if (step.opensParallelStage)
+            stageInput.copyFrom(block);
+
+        if (step.isBranch)
+        {
+            // Later branches start from the stage input and are summed into the block
+            branch.copyFrom(stageInput);
+            processStep(step, branch);
+            applySlotLevel(step.slot, branch);
+            block.add(branch);
+        }
+        else
+        {
+            processStep(step, block);
+            applySlotLevel(step.slot, block);
+        }
+    }
+}
+
+void OutsetVerbBatchEngine::processStep(BatchStep& step, const juce::dsp::AudioBlock<BatchLane>& block)
+{
+    // An empty slot passes the block through
+    if (step.process == nullptr)
+        return;
+
+    if (isSteadyAt(step.engage, 1.0f))
+    {
+        step.process(step.node, block);
+        return;
+    }
+
+    // Some lane is fading or faded out. As in OutsetVerbEngine, the effect's input
+    // is faded and the dry input brought in around it; a lane faded all the way out
+    // feeds its effect silence and hears whatever it still holds ring out.
+    const auto numSamples = block.getNumSamples();
+    auto dry = dryBlock.getSubBlock(0, numSamples);
+    dry.copyFrom(block);
+
+    BatchLane startGain, gainIncrement;
+    getLaneRamp(step.engage, static_cast<int>(numSamples), startGain, gainIncrement);
+
+    for (size_t channel = 0; channel < block.getNumChannels(); ++channel)
+    {
+        auto* data = block.getChannelPointer(channel);
+
+        for (size_t sample = 0; sample < numSamples; ++sample)
+            data[sample] *= startGain + gainIncrement * static_cast<float>(sample);
+    }
+
+    step.process(step.node, block);
+
+    const auto one = BatchLane::expand(1.0f);
+
+    for (size_t channel = 0; channel < block.getNumChannels(); ++channel)
+    {
+        auto* data = block.getChannelPointer(channel);
+        const auto* dryData = dry.getChannelPointer(channel);
+
+        for (size_t sample = 0; sample < numSamples; ++sample)
+            data[sample] += dryData[sample] * (one - (startGain + gainIncrement * static_cast<float>(sample)));
+    }
+}
+
+void OutsetVerbBatchEngine::applySlotLevel(int slot, const juce::dsp::AudioBlock<BatchLane>& block)
+{
+    auto& levels = slotLevels[static_cast<size_t>(slot)];
+
+    // Free at unity in every lane
+    if (isSteadyAt(levels, 1.0f))
+        return;
+
+    const auto numSamples = block.getNumSamples();
+
+    BatchLane startGain, gainIncrement;
+    getLaneRamp(levels, static_cast<int>(numSamples), startGain, gainIncrement);
+
+    for (size_t channel = 0; channel < block.getNumChannels(); ++channel)
+    {
+        auto* data = block.getChannelPointer(channel);
+
+        for (size_t sample = 0; sample < numSamples; ++sample)
+            data[sample] *= startGain + gainIncrement * static_cast<float>(sample);
+    }
+}
+
+void OutsetVerbBatchEngine::getLaneRamp(LaneSmoother& smoothers, int numSamples, BatchLane& start, BatchLane& increment)
+{
+    // Linear ramp across the tile from each lane's current value to where its smoother lands
+    for (size_t lane = 0; lane < numLanes; ++lane)
+    {
+        const float startValue = smoothers[lane].getCurrentValue();
+        const float endValue = smoothers[lane].skip(numSamples);
+
+        start.set(lane, startValue);
+        increment.set(lane, (endValue - startValue) / static_cast<float>(numSamples));
+    }
+}
+
+bool OutsetVerbBatchEngine::isSteadyAt(const LaneSmoother& smoothers, float value)
+{
+    return std::all_of(smoothers.begin(), smoothers.end(), [value](const auto& smoother)
+    {
+        return ! smoother.isSmoothing() && smoother.getTargetValue() == value;
+    });
+}
+
+//==============================================================================
+template<typename NodeType>
+void OutsetVerbBatchEngine::processNode(void* node, const juce::dsp::AudioBlock<BatchLane>& block)
+{
+    static_cast<NodeType*>(node)->process(block);
+}
+
+template<typename NodeType>
+void OutsetVerbBatchEngine::resetNode(void* node)
+{
+    static_cast<NodeType*>(node)->reset();
+}
+
+template<typename NodeType>
+void OutsetVerbBatchEngine::bindStep(BatchStep& step, std::vector<std::unique_ptr<NodeType>>& nodes)
+{
+    nodes.push_back(std::make_unique<NodeType>());
+
+    step.process = &processNode<NodeType>;
+    step.reset = &resetNode<NodeType>;
+    step.node = nodes.back().get();
+}
+
+template<typename NodeType, typename Function>
+void OutsetVerbBatchEngine::forEachNode(std::vector<std::unique_ptr<NodeType>>& nodes, Function&& function)
+{
+    for (auto& node : nodes)
+        function(*node);
+}
@@ -0,0 +1,176 @@
+/*
+  ==============================================================================
+
+    OutsetVerbBatchEngine.h
+    
+    Runs several independent Outset-Verb instances side by side, one per
+    SIMD lane, for hosts that process many tracks with the same chain.
+    
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <juce_audio_basics/juce_audio_basics.h>
+#include <juce_dsp/juce_dsp.h>
+#include <juce_core/juce_core.h>
+#include <algorithm>
+#include <array>
+#include <bitset>
+#include <memory>
+#include <vector>
+#include "Effects/BatchLanes.h"
+#include "Effects/BatchBitCrusherNode.h"
+#include "Effects/BatchDelayNode.h"
+#include "Effects/BatchParametricEQNode.h"
+#include "Effects/BatchReverbNode.h"
+#include "OutsetVerbParameters.h"
+
+//==============================================================================
+/**
+    A batch of numLanes Outset-Verb instances sharing one effect chain.
+    
+    Each instance has its own parameters, its own effect state and its own
+    audio, and sounds like an OutsetVerbEngine<float> with the same settings.
+    The batch nodes keep every instance's state in one lane of a SIMD
+    register, so each instruction advances the whole batch at once.
+    
+    The chain order is fixed when the batch is created. The batch does not
+    put effects to sleep, run dual-mono input on one channel or report a
+    tail; a host needing those per instance should use OutsetVerbEngine.
+*/
+class OutsetVerbBatchEngine
+{
+public:
+    //==============================================================================
+    /** How many instances the batch runs, one per lane. */
+    static constexpr size_t numLanes = numBatchLanes;
+    
+    static constexpr int maxSlots = OutsetVerbParameters::maxSlots;
+    
+    //==============================================================================
+    /** Creates a batch with every instance starting from the given values. The
+        chain order is taken from these and kept for the life of the batch. */
+    explicit OutsetVerbBatchEngine(const OutsetVerbParameters& initialParameters = OutsetVerbParameters::getDefaults());
+    
+    /** Destructor. */
+    ~OutsetVerbBatchEngine() = default;
+    
+    //==============================================================================
+    /** Applies a new set of parameter values to one instance. The chain slot
+        and parallel values are ignored. Call this from the audio thread
+        between blocks; nothing here allocates. */
+    void setParameters(size_t lane, const OutsetVerbParameters& newParameters);
+    
+    //==============================================================================
+    /** Prepares the batch. spec describes a single instance. As with
+        OutsetVerbEngine, preparing again for the same layout reuses the
+        buffers and costs little more than reset(). */
+    void prepare(const juce::dsp::ProcessSpec& spec);
+    
+    /** Processes one buffer per instance in place. Every buffer must have the
+        same length; a null buffer leaves its lane running on silence. */
+    void processBlock(const std::array<juce::AudioBuffer<float>*, numLanes>& buffers);
+    
+    /** Resets every instance's effect state. The delay and reverb lines are
+        cleared as they are next read, so this does not scale with their length. */
+    void reset();
+    
+    /** Sets the ramp length used when smoothed parameters and slot levels change. */
+    void setSmoothingTime(double seconds);
+    
+private:
+    //==============================================================================
+    using Parameters = OutsetVerbParameters;
+    using EffectType = OutsetVerbParameters::EffectType;
+    using LaneSmoother = std::array<juce::SmoothedValue<float>, numLanes>;
+    
+    /** Same fade time as OutsetVerbEngine uses for bypass and identity settings. */
+    static constexpr double engageRampSeconds = 0.01;
+    
+    /** Host buffers are interleaved into the batch and run this many samples at a time. */
+    static constexpr int tileSize = 128;
+    
+    // One slot of the chain. The node is type-erased behind the thunks, as in
+    // OutsetVerbEngine's execution plan; an empty slot has none.
+    struct BatchStep
+    {
+        using ProcessFunction = void (*)(void*, const juce::dsp::AudioBlock<BatchLane>&);
+        using ResetFunction = void (*)(void*);
+        
+        ProcessFunction process = nullptr;
+        ResetFunction reset = nullptr;
+        void* node = nullptr;
+        EffectType effect = EffectType::none;
+        int slot = 0;
+        
+        bool opensParallelStage = false;        // copy the block into the stage input first
+        bool isBranch = false;                  // run on a copy of the stage input and sum into the block
+        
+        // How far each lane's effect is faded in
+        LaneSmoother engage;
+    };
+    
+    std::array<BatchStep, maxSlots> steps;
+    int numSteps = 0;
+    
+    // Only the instances the chain uses are created, in slot order
+    std::vector<std::unique_ptr<BatchBitCrusherNode>> bitCrushers;
+    std::vector<std::unique_ptr<BatchDelayNode>> delays;
+    std::vector<std::unique_ptr<BatchParametricEQNode>> eqs;
+    std::vector<std::unique_ptr<BatchReverbNode>> reverbs;
+    
+    // Output level of each slot in each lane
+    std::array<LaneSmoother, maxSlots> slotLevels;
+    double smoothingTimeSeconds = 0.02;
+    
+    // One tile of every lane, plus the stage input, branch and dry scratch
+    juce::HeapBlock<char> tileMemory, stageInputMemory, branchMemory, dryMemory;
+    juce::dsp::AudioBlock<BatchLane> tileBlock, stageInputBlock, branchBlock, dryBlock;
+    size_t numChannels = 0;
+    double currentSampleRate = 44100.0;
+    
+    // Values last pushed to each lane's nodes, used to skip unchanged parameters
+    std::array<Parameters, numLanes> lastParameterValues;
+    
+    //==============================================================================
+    /** Builds the steps and their nodes for the chain held in parameters. */
+    void buildChain(const Parameters& parameters);
+    
+    /** Pushes one lane's parameters that changed since the last call to its nodes. */
+    void updateLaneParameters(size_t lane, const Parameters& parameters, bool forceUpdate = false);
+    
+    /** Runs the whole chain over one tile of every lane. */
+    void processTile(const juce::dsp::AudioBlock<BatchLane>& block);
+    
+    /** Runs one step, fading it in or out in any lane where it is moving. */
+    void processStep(BatchStep& step, const juce::dsp::AudioBlock<BatchLane>& block);
+    
+    /** Scales the block by each lane's level for the slot, ramping lanes that move. */
+    void applySlotLevel(int slot, const juce::dsp::AudioBlock<BatchLane>& block);
+    
+    /** Advances each lane's smoother over numSamples and returns the linear ramp
+        across the tile as a start value and a per-sample increment. */
+    static void getLaneRamp(LaneSmoother& smoothers, int numSamples, BatchLane& start, BatchLane& increment);
+    
+    /** True if no lane's smoother is moving and every lane sits at value. */
+    static bool isSteadyAt(const LaneSmoother& smoothers, float value);
+    
+    //==============================================================================
+    /** Step thunks, instantiated once per node type. */
+    template<typename NodeType>
+    static void processNode(void* node, const juce::dsp::AudioBlock<BatchLane>& block);
+    
+    template<typename NodeType>
+    static void resetNode(void* node);
+    
+    /** Creates a node for the step and binds the step to it. */
+    template<typename NodeType>
+    static void bindStep(BatchStep& step, std::vector<std::unique_ptr<NodeType>>& nodes);
+    
+    /** Calls function(node) for every node of one type. */
+    template<typename NodeType, typename Function>
+    static void forEachNode(std::vector<std::unique_ptr<NodeType>>& nodes, Function&& function);
+    
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(OutsetVerbBatchEngine)
+};
@@ -2,7 +2,7 @@
   ==============================================================================
 
     OutsetVerbEngine.cpp
-    
+
     Audio processing engine implementation for Outset-Verb.
 
   ==============================================================================
@@ -11,293 +11,2228 @@
 #include "OutsetVerbEngine.h"
 
 //==============================================================================
-OutsetVerbEngine::OutsetVerbEngine(juce::AudioProcessorValueTreeState& apvtsRef)
-    : apvts(apvtsRef)
+template<typename SampleType>
+OutsetVerbEngine<SampleType>::OutsetVerbEngine(const OutsetVerbParameters& initialParameters)
+{
+    // Nothing else is running yet, so take the initial chain and values straight
+    // from the hand-over buffers and leave them empty for the audio thread
+    setParameters(initialParameters);
+    updateChainOrder(initialParameters);
+
+    publishedPlans.fetch();
+    currentPlan = publishedPlans.read();
+    pendingPlan = currentPlan;
+
+    publishedParameters.fetch();
+    updateChainParameters(publishedParameters.read(), true);
+}
+
+template<typename SampleType>
+OutsetVerbEngine<SampleType>::~OutsetVerbEngine()
+{
+    stopChainBuilder();
+    stopStageWorkers();
+}
+
+template<typename SampleType>
+void OutsetVerbEngine<SampleType>::setParameters(const OutsetVerbParameters& newParameters)
+{
+    publishedParameters.getWriteBuffer() = newParameters;
+    publishedParameters.publish();
+}
+
+template<typename SampleType>
+void OutsetVerbEngine<SampleType>::updateChainOrder(const OutsetVerbParameters& parameters)
+{
+    const auto chain = readChainConfiguration(parameters);
+    const std::lock_guard<std::mutex> lock(prewarmLock);
+
+    // Whatever the audio thread has let go of since the last call is freed first, so
+    // an order that brings an instance back starts it from scratch
+    releaseRetiredInstances();
+
+    if (chain == lastPublishedChain)
+        return;
+
+    // Compile the new order into the spare slot and hand it over without locking
+    lastPublishedChain = chain;
+    auto& plan = publishedPlans.getWriteBuffer();
+    compilePlan(chain, plan);
+
+    // Every instance the order adds gets its state before the audio thread can see
+    // it. Before the first prepare() there is nothing to size it for; prepare() does it.
+    prewarmPlan(plan, parameters);
+    publishedPlans.publish();
+}
+
+template<typename SampleType>
+size_t OutsetVerbEngine<SampleType>::getStateBytes()
 {
+    const std::lock_guard<std::mutex> lock(prewarmLock);
+    size_t numBytes = 0;
+
+    auto addPool = [&numBytes](auto& pool)
+    {
+        for (auto& pooledNode : pool)
+            numBytes += pooledNode.state.getSize();
+    };
+
+    addPool(bitCrusherPool);
+    addPool(delayPool);
+    addPool(eqPool);
+    addPool(reverbPool);
+    return numBytes;
 }
 
 //==============================================================================
-void OutsetVerbEngine::prepare(const juce::dsp::ProcessSpec& spec)
+template<typename SampleType>
+void OutsetVerbEngine<SampleType>::prepare(const juce::dsp::ProcessSpec& spec)
 {
-    // Prepare individual effect processors with the given audio specs
-    bitCrusherProcessor.prepare(spec);
-    delayProcessor.prepare(spec);
-    eqProcessor.prepare(spec);
-    reverbProcessor.prepare(spec);
+    currentSampleRate = spec.sampleRate;
+
+    // The stage workers touch the nodes, the plan and the tiles, so they stop first
+    stopStageWorkers();
+
+    // The effects only ever see one tile at a time, whatever the host block size
+    auto tileSpec = spec;
+    tileSpec.maximumBlockSize = static_cast<juce::uint32>(tileSize);
+
+    // Update parameters to the newest snapshot
+    publishedParameters.fetch();
+
+    {
+        const std::lock_guard<std::mutex> lock(prewarmLock);
+
+        // Start from the newest chain order with no transition in flight. It is fetched
+        // under the lock, so no plan binding an instance dropped below can follow it.
+        if (publishedPlans.fetch())
+            currentPlan = publishedPlans.read();
+        else if (chainTransition != ChainTransition::idle)
+            currentPlan = pendingPlan;
+
+        // The state is sized by the sample rate, channel count and EQ structure. If none
+        // changed, warm instances keep theirs and are only reset, which costs next to
+        // nothing; otherwise it is all dropped, and only the instances the chain runs
+        // on get state again below.
+        const bool keepState = prepared && tileSpec.sampleRate == nodeSpec.sampleRate
+                               && tileSpec.numChannels == nodeSpec.numChannels
+                               && eqTopology == preparedEQTopology;
+
+        // Configure every pooled instance, so parameter changes reach them all
+        auto configureNodes = [&tileSpec, keepState](auto& pool)
+        {
+            for (auto& pooledNode : pool)
+            {
+                pooledNode.node.configure(tileSpec);
+
+                if (keepState && pooledNode.warm.load(std::memory_order_relaxed))
+                {
+                    pooledNode.node.reset();
+                }
+                else
+                {
+                    pooledNode.warm.store(false, std::memory_order_relaxed);
+                    pooledNode.live.store(false, std::memory_order_relaxed);
+                    pooledNode.state.release();
+                }
+            }
+        };
+
+        configureNodes(bitCrusherPool);
+        configureNodes(delayPool);
+        configureNodes(eqPool);
+        configureNodes(reverbPool);
+
+        // Linear-phase EQs convolve in blocks of their own and cannot run sample by sample
+        const bool eqBlockBased = eqTopology == EQTopology::linearPhase;
+        forEachInstance(eqPool, [eqBlockBased](auto&, NodeActivity& activity) { activity.blockBased = eqBlockBased; });
+
+        nodeSpec = tileSpec;
+        preparedEQTopology = eqTopology;
+        prepared = true;
+
+        prewarmPlan(currentPlan, publishedParameters.read());
+
+        // No block is running, so the chain's instances can be handed over right away.
+        // That happens under the lock, so updateChainOrder() cannot free them first.
+        updateChainParameters(publishedParameters.read(), true);
+        adoptInstances(currentPlan);
+
+        pendingPlan = currentPlan;
+        chainTransition = ChainTransition::idle;
+        retireUnboundInstances();
+        acknowledgedPlanSerial.store(publishedPlans.read().serial, std::memory_order_release);
+    }
+
+    transitionBuffer.setSize(static_cast<int>(spec.numChannels), tileSize);
+    scratch.setSize(static_cast<int>(spec.numChannels));
+
+    for (auto& level : slotLevels)
+        level.reset(currentSampleRate, smoothingTimeSeconds);
+
+    for (auto& level : incomingSlotLevels)
+        level.reset(currentSampleRate, smoothingTimeSeconds);
+
+    // One worker per extra channel, up to one per spare core, if the channels may ever be spread
+    const int numWorkers = juce::jmin(static_cast<int>(spec.numChannels), static_cast<int>(std::thread::hardware_concurrency())) - 1;
+    const bool wantsWorkers = channelThreading != ChannelThreading::off
+                              && static_cast<int>(spec.numChannels) >= minThreadedChannels && numWorkers > 0;
+
+    if (! wantsWorkers)
+        workerPool.reset();
+    else if (workerPool == nullptr || workerPool->getNumThreads() != numWorkers + 1)
+        workerPool = std::make_unique<WorkerPool>(numWorkers);
+
+    // Layouts wide enough for channel threading already spread across the cores with
+    // no added delay; narrower ones are pipelined, delayed by one block in whole tiles
+    const bool usePipeline = pipelined && ! wantsWorkers;
+
+    preparedBlockSize = juce::jmax(1, static_cast<int>(spec.maximumBlockSize));
+    latencySamples = usePipeline ? (preparedBlockSize + tileSize - 1) / tileSize * tileSize : 0;
+
+    if (usePipeline)
+    {
+        // Enough tiles for the delay, one block of input and the tiles being filled and read
+        const int numTiles = (latencySamples + preparedBlockSize) / tileSize + 3;
+
+        pipelineTiles.resize(static_cast<size_t>(numTiles));
+
+        for (auto& tile : pipelineTiles)
+            tile.buffer.setSize(static_cast<int>(spec.numChannels), tileSize);
+
+        for (auto& queue : stageQueues)
+            queue.setCapacity(numTiles);
+
+        pipelineOutput.setCapacity(numTiles);
+
+        for (auto& stageTileScratch : stageScratch)
+            stageTileScratch.setSize(static_cast<int>(spec.numChannels));
+
+        finishedTiles.setCapacity(numTiles);
+        freeTiles.reserve(static_cast<size_t>(numTiles));
+    }
+    else
+    {
+        pipelineTiles.clear();
+        freeTiles.clear();
+    }
+
+    // Start each effect fully in or out according to its bypass state - no ramp on load
+    forEachActivity([this](NodeActivity& activity) { activity.engage.reset(currentSampleRate, engageRampSeconds); });
+
+    // The stages are laid out first, so each starts with its share of the tail
+    if (usePipeline)
+        updatePipelineStages();
+
+    updateTailLengths();
+    updateChainLatency();
+    wakeAllNodes();
+
+    if (usePipeline)
+    {
+        resetPipelineTiles();
+        startStageWorkers();
+    }
 
-    // Update parameters to current APVTS values
-    updateChainParameters();
+    if (! chainBuilder.joinable())
+        startChainBuilder();
 }
 
-void OutsetVerbEngine::processBlock(juce::AudioBuffer<float>& buffer)
+template<typename SampleType>
+void OutsetVerbEngine<SampleType>::processBlock(juce::AudioBuffer<SampleType>& buffer)
 {
     auto numSamples = buffer.getNumSamples();
-    
+
     // Early exit if no samples
     if (numSamples == 0)
         return;
 
-    // Update parameters from APVTS
-    updateChainParameters();
-
     // Create audio block from buffer for DSP processing
-    juce::dsp::AudioBlock<float> audioBlock(buffer);
+    juce::dsp::AudioBlock<SampleType> audioBlock(buffer);
 
-    // Process through effects in the configured order
-    for (int slot = 0; slot < 4; ++slot)
+    updateFilterDesignThread();
+
+    if (! stageWorkers.empty())
     {
-        int effectType = chainConfiguration[slot];
+        processPipelined(audioBlock);
+        return;
+    }
 
-        // Skip if no effect selected for this slot
-        if (effectType == EffectType::none)
-            continue;
+    // Long offline blocks may spread the per-channel effects across the workers
+    threadedBlock = workerPool != nullptr && numSamples >= minThreadedBlockSize
+                    && (channelThreading == ChannelThreading::always || nonRealtime.load(std::memory_order_relaxed));
+
+    // Run the whole chain over one tile before starting the next. This also
+    // covers hosts that pass more samples than they prepared for.
+    for (size_t start = 0; start < audioBlock.getNumSamples(); start += tileSize)
+    {
+        auto tile = audioBlock.getSubBlock(start, juce::jmin(static_cast<size_t>(tileSize), audioBlock.getNumSamples() - start));
+
+        // Pick up the newest parameters and any plan compiled off the audio thread
+        if (publishedParameters.fetch())
+            updateChainParameters(publishedParameters.read());
+
+        fetchChainOrder();
+        processTile(tile);
+    }
+}
+
+template<typename SampleType>
+void OutsetVerbEngine<SampleType>::reset()
+{
+    // Let the tiles in flight finish before the nodes under them are cleared
+    if (! stageWorkers.empty())
+    {
+        drainPipeline();
+        resetPipelineTiles();
+    }
+
+    // Reset every instance the audio thread owns. The others are either fresh from
+    // prewarming or reset when a plan brings them back, and may be freed meanwhile.
+    auto resetInstance = [](auto& pooledNode) { pooledNode.node.reset(); };
+
+    forEachLiveInstance(bitCrusherPool, resetInstance);
+    forEachLiveInstance(delayPool, resetInstance);
+    forEachLiveInstance(eqPool, resetInstance);
+    forEachLiveInstance(reverbPool, resetInstance);
+
+    wakeAllNodes();
+}
+
+template<typename SampleType>
+void OutsetVerbEngine<SampleType>::setChainCrossfadeTime(double seconds)
+{
+    // A transition already running keeps the length it started with
+    chainCrossfadeSeconds = juce::jmax(0.0, seconds);
+}
+
+template<typename SampleType>
+void OutsetVerbEngine<SampleType>::setChannelThreading(ChannelThreading newThreading)
+{
+    channelThreading = newThreading;
+}
+
+template<typename SampleType>
+void OutsetVerbEngine<SampleType>::setPipelined(bool shouldBePipelined)
+{
+    pipelined = shouldBePipelined;
+}
+
+template<typename SampleType>
+void OutsetVerbEngine<SampleType>::setEQTopology(EQTopology newTopology)
+{
+    // A cold instance being prewarmed reads its topology when it is configured
+    const std::lock_guard<std::mutex> lock(prewarmLock);
+
+    eqTopology = newTopology;
+    forEachInstance(eqPool, [newTopology](auto& node, NodeActivity&) { node.setTopology(newTopology); });
+}
+
+template<typename SampleType>
+void OutsetVerbEngine<SampleType>::setSmoothingTime(double seconds)
+{
+    smoothingTimeSeconds = seconds;
+
+    for (auto& level : slotLevels)
+        level.reset(currentSampleRate, smoothingTimeSeconds);
+
+    for (auto& level : incomingSlotLevels)
+        level.reset(currentSampleRate, smoothingTimeSeconds);
+
+    forEachInstance(bitCrusherPool, [seconds](auto& node, NodeActivity&) { node.setSmoothingTime(seconds); });
+    forEachInstance(delayPool, [seconds](auto& node, NodeActivity&) { node.setSmoothingTime(seconds); });
+    forEachInstance(eqPool, [seconds](auto& node, NodeActivity&) { node.setSmoothingTime(seconds); });
+}
+
+//==============================================================================
+template<typename SampleType>
+void OutsetVerbEngine<SampleType>::updateChainParameters(const Parameters& parameters, bool forceUpdate)
+{
+    // Note which parameters moved since the last snapshot
+    ParameterFlags changed;
+
+    for (int index = 0; index < Parameters::numParameters; ++index)
+    {
+        const float value = parameters[index];
+
+        if (forceUpdate || value != lastParameterValues[index])
+        {
+            lastParameterValues[index] = value;
+            changed.set(index);
+        }
+    }
 
-        // Create process context for this effect
-        juce::dsp::ProcessContextReplacing<float> context(audioBlock);
+    // Nothing moved - the nodes are already up to date
+    if (changed.none())
+        return;
+
+    // Duplicate instances share their effect's parameters, so every live instance
+    // is kept in sync whether or not it is in the current chain. Cold ones belong
+    // to the thread prewarming them and catch up when a plan hands them over.
+    auto syncPool = [this, forceUpdate](auto& pool)
+    {
+        forEachLiveInstance(pool, [this, forceUpdate](auto& pooledNode) { syncInstance(pooledNode, lastParameterValues, forceUpdate); });
+    };
+
+    syncPool(bitCrusherPool);
+    syncPool(delayPool);
+    syncPool(eqPool);
+    syncPool(reverbPool);
 
-        // Process through the appropriate effect
-        switch (effectType)
+    const auto& values = lastParameterValues;
+
+    // Update slot levels, for the incoming order of a crossfade too
+    for (int slot = 0; slot < maxSlots; ++slot)
+    {
+        if (changed[Parameters::chainSlot1LevelParam + slot])
         {
-            case EffectType::bitCrusher:
-                bitCrusherProcessor.process(context);
-                break;
-            case EffectType::delay:
-                delayProcessor.process(context);
-                break;
-            case EffectType::eq:
-                eqProcessor.process(context);
-                break;
-            case EffectType::reverb:
-                reverbProcessor.process(context);
-                break;
-            default:
-                // Unknown effect type - skip
-                break;
+            slotLevels[static_cast<size_t>(slot)].setTargetValue(values[Parameters::chainSlot1LevelParam + slot]);
+            incomingSlotLevels[static_cast<size_t>(slot)].setTargetValue(values[Parameters::chainSlot1LevelParam + slot]);
         }
     }
+
+    // Tails depend on times, feedback, room size and mixes - cheap enough to redo wholesale
+    updateTailLengths();
+    updateEngageTargets();
+}
+
+template<typename SampleType>
+template<typename NodeType>
+void OutsetVerbEngine<SampleType>::syncInstance(PooledNode<NodeType>& pooledNode, const Parameters& values, bool forceUpdate)
+{
+    ParameterFlags changed;
+
+    for (int index = 0; index < Parameters::numParameters; ++index)
+        if (forceUpdate || values[index] != pooledNode.appliedParameters[index])
+            changed.set(index);
+
+    if (changed.none())
+        return;
+
+    applyParameters(pooledNode.node, values, changed);
+    pooledNode.appliedParameters = values;
 }
 
-void OutsetVerbEngine::reset()
+template<typename SampleType>
+void OutsetVerbEngine<SampleType>::applyParameters(typename EngineNodes::BitCrusher& node, const Parameters& values, const ParameterFlags& changed)
 {
-    // Reset individual effect processors
-    bitCrusherProcessor.reset();
-    delayProcessor.reset();
-    eqProcessor.reset();
-    reverbProcessor.reset();
+    if (changed[Parameters::bitDepthParam])
+        node.setBitDepth(values[Parameters::bitDepthParam]);
+    if (changed[Parameters::sampleRateReductionParam])
+        node.setSampleRateReduction(values[Parameters::sampleRateReductionParam]);
+    if (changed[Parameters::bitCrusherMixParam])
+        node.setMix(values[Parameters::bitCrusherMixParam]);
 }
 
-//==============================================================================
-void OutsetVerbEngine::updateChainParameters()
-{
-    // Update BitCrusher parameters
-    bitCrusherProcessor.setBitDepth(apvts.getRawParameterValue("bitDepth")->load());
-    bitCrusherProcessor.setSampleRateReduction(apvts.getRawParameterValue("sampleRateReduction")->load());
-    bitCrusherProcessor.setMix(apvts.getRawParameterValue("bitCrusherMix")->load());
-
-    // Update Delay parameters
-    delayProcessor.setDelayTime(apvts.getRawParameterValue("delayTime")->load());
-    delayProcessor.setFeedback(apvts.getRawParameterValue("delayFeedback")->load());
-    delayProcessor.setMix(apvts.getRawParameterValue("delayMix")->load());
-    delayProcessor.setLowPassCutoff(apvts.getRawParameterValue("delayLowPassCutoff")->load());
-
-    // Update EQ parameters
-    eqProcessor.setLowGain(apvts.getRawParameterValue("lowGain")->load());
-    eqProcessor.setLowFreq(apvts.getRawParameterValue("lowFreq")->load());
-    eqProcessor.setMidGain(apvts.getRawParameterValue("midGain")->load());
-    eqProcessor.setMidFreq(apvts.getRawParameterValue("midFreq")->load());
-    eqProcessor.setMidQ(apvts.getRawParameterValue("midQ")->load());
-    eqProcessor.setHighGain(apvts.getRawParameterValue("highGain")->load());
-    eqProcessor.setHighFreq(apvts.getRawParameterValue("highFreq")->load());
-
-    // Update Reverb parameters
-    reverbProcessor.setRoomSize(apvts.getRawParameterValue("roomSize")->load());
-    reverbProcessor.setDamping(apvts.getRawParameterValue("damping")->load());
-    reverbProcessor.setWidth(apvts.getRawParameterValue("width")->load());
+template<typename SampleType>
+void OutsetVerbEngine<SampleType>::applyParameters(typename EngineNodes::Delay& node, const Parameters& values, const ParameterFlags& changed)
+{
+    if (changed[Parameters::delayTimeParam])
+        node.setDelayTime(values[Parameters::delayTimeParam]);
+    if (changed[Parameters::delayFeedbackParam])
+        node.setFeedback(values[Parameters::delayFeedbackParam]);
+    if (changed[Parameters::delayMixParam])
+        node.setMix(values[Parameters::delayMixParam]);
+    if (changed[Parameters::delayLowPassCutoffParam])
+        node.setLowPassCutoff(values[Parameters::delayLowPassCutoffParam]);
+}
+
+template<typename SampleType>
+void OutsetVerbEngine<SampleType>::applyParameters(typename EngineNodes::EQ& node, const Parameters& values, const ParameterFlags& changed)
+{
+    using EQ = typename EngineNodes::EQ;
+
+    static_assert(Parameters::maxEQBands == EQ::maxBands, "Every EQ band parameter needs a band in the node");
+    static_assert(static_cast<int>(EQ::BandType::lowPass) == Parameters::bandLowPass, "Band types are passed on by value");
+    static_assert(static_cast<int>(EQ::CutSlope::dB48) == Parameters::slope48dB, "Slopes are passed on by value");
+
+    // The node always has room for every band, and the ones past the count are
+    // switched off, so changing the count never needs a prepare
+    const int numBands = values.getNumEQBands();
+
+    for (int band = 0; band < Parameters::maxEQBands; ++band)
+    {
+        if (changed[Parameters::eqNumBandsParam] || changed[Parameters::eqBand1TypeParam + band])
+        {
+            const int type = band < numBands ? juce::roundToInt(values[Parameters::eqBand1TypeParam + band]) : Parameters::bandOff;
+            node.setBandType(band, static_cast<typename EQ::BandType>(juce::jlimit(0, static_cast<int>(Parameters::bandLowPass), type)));
+        }
+
+        if (changed[Parameters::eqBand1FreqParam + band])
+            node.setBandFrequency(band, values[Parameters::eqBand1FreqParam + band]);
+        if (changed[Parameters::eqBand1GainParam + band])
+            node.setBandGain(band, values[Parameters::eqBand1GainParam + band]);
+        if (changed[Parameters::eqBand1QParam + band])
+            node.setBandQ(band, values[Parameters::eqBand1QParam + band]);
+
+        if (changed[Parameters::eqBand1SlopeParam + band])
+        {
+            const int slope = juce::roundToInt(values[Parameters::eqBand1SlopeParam + band]);
+            node.setBandSlope(band, static_cast<typename EQ::CutSlope>(juce::jlimit(0, static_cast<int>(Parameters::slope48dB), slope)));
+        }
+    }
+}
+
+template<typename SampleType>
+void OutsetVerbEngine<SampleType>::applyParameters(typename EngineNodes::Reverb& node, const Parameters& values, const ParameterFlags& changed)
+{
+    if (changed[Parameters::roomSizeParam])
+        node.setRoomSize(values[Parameters::roomSizeParam]);
+    if (changed[Parameters::dampingParam])
+        node.setDamping(values[Parameters::dampingParam]);
+    if (changed[Parameters::widthParam])
+        node.setWidth(values[Parameters::widthParam]);
 
     // Handle freeze mode - convert bool to float
-    bool freezeMode = apvts.getRawParameterValue("freezeMode")->load() > 0.5f;
-    reverbProcessor.setFreezeMode(freezeMode ? 1.0f : 0.0f);
+    if (changed[Parameters::freezeModeParam])
+        node.setFreezeMode(values[Parameters::freezeModeParam] > 0.5f ? 1.0f : 0.0f);
 
     // Handle reverb mix parameter
-    float reverbMixValue = apvts.getRawParameterValue("reverbMix")->load();
-    reverbProcessor.setMix(reverbMixValue);
+    if (changed[Parameters::reverbMixParam])
+        node.setMix(values[Parameters::reverbMixParam]);
+}
+
+template<typename SampleType>
+void OutsetVerbEngine<SampleType>::updateEngageTargets()
+{
+    auto updatePool = [this](auto& pool)
+    {
+        for (auto& pooledNode : pool)
+            updateEngageTarget(pooledNode, lastParameterValues);
+    };
+
+    updatePool(bitCrusherPool);
+    updatePool(delayPool);
+    updatePool(eqPool);
+    updatePool(reverbPool);
+}
+
+template<typename SampleType>
+template<typename NodeType>
+void OutsetVerbEngine<SampleType>::updateEngageTarget(PooledNode<NodeType>& pooledNode, const Parameters& values)
+{
+    const bool engaged = values.isEngaged(getEffectType<NodeType>());
+
+    if constexpr (std::is_same_v<NodeType, typename EngineNodes::EQ>)
+    {
+        // A linear-phase EQ delays all it passes, so fading it out would mix the
+        // undelayed input in. It stays engaged and glides to a plain delay instead.
+        const bool alwaysEngaged = preparedEQTopology == EQTopology::linearPhase;
+        pooledNode.activity.engage.setTargetValue(engaged || alwaysEngaged ? 1.0f : 0.0f);
+
+        if (pooledNode.live.load(std::memory_order_relaxed))
+            pooledNode.node.setBypassed(! engaged);
+    }
+    else
+    {
+        pooledNode.activity.engage.setTargetValue(engaged ? 1.0f : 0.0f);
+    }
+}
+
+template<typename SampleType>
+typename OutsetVerbEngine<SampleType>::ChainConfiguration OutsetVerbEngine<SampleType>::readChainConfiguration(const Parameters& parameters)
+{
+    ChainConfiguration chain;
+
+    for (int slot = 0; slot < maxSlots; ++slot)
+    {
+        const auto index = static_cast<size_t>(slot);
+        chain.effects[index] = static_cast<int>(parameters[Parameters::chainSlot1Param + slot]);
+
+        // The first slot always starts a new stage
+        chain.parallelWithPrevious[index] = slot > 0
+            && parameters[Parameters::chainSlot2ParallelParam + slot - 1] > 0.5f;
+    }
+
+    return chain;
+}
+
+template<typename SampleType>
+void OutsetVerbEngine<SampleType>::compilePlan(const ChainConfiguration& chain, ExecutionPlan& plan)
+{
+    plan.chain = chain;
+    plan.numSteps = 0;
+    plan.numMonoSteps = 0;
+    plan.serial = ++numPlansCompiled;
+    chooseInstances(plan);
+
+    for (int stageStart = 0; stageStart < maxSlots;)
+    {
+        const int stageEnd = chain.getStageEnd(stageStart);
+        const bool parallel = stageEnd - stageStart > 1;
+
+        for (int slot = stageStart; slot < stageEnd; ++slot)
+        {
+            auto& step = plan.steps[static_cast<size_t>(plan.numSteps++)];
+            step = PlanStep();
+            step.slot = slot;
+            step.run = &runEmptySlot;
+
+            // The first branch of a parallel stage runs in place on the block
+            step.opensParallelStage = parallel && slot == stageStart;
+            step.isBranch = parallel && slot > stageStart;
+            step.closesParallelStage = parallel && slot == stageEnd - 1;
+
+            visitPool(chain.effects[static_cast<size_t>(slot)], [&plan, &step, slot](auto& pool)
+            {
+                auto& pooledNode = pool[plan.instances[static_cast<size_t>(slot)]];
+                bindStep(step, pooledNode);
+                pooledNode.lastBindingSerial = plan.serial;
+            });
+        }
+
+        // A linear-phase EQ delays its branch, so the stage's other branches are held
+        // back to match through a line of the stage's first EQ
+        const int firstStageStep = plan.numSteps - (stageEnd - stageStart);
+        const auto firstEQ = std::find(chain.effects.begin() + stageStart, chain.effects.begin() + stageEnd, static_cast<int>(EffectType::eq));
+
+        if (parallel && firstEQ != chain.effects.begin() + stageEnd)
+            for (int index = firstStageStep; index < plan.numSteps; ++index)
+                plan.steps[static_cast<size_t>(index)].stageEQStep = firstStageStep + static_cast<int>(firstEQ - (chain.effects.begin() + stageStart));
+
+        // Everything from the first stage with a reverb on sees every channel
+        const bool couplesChannels = std::any_of(chain.effects.begin() + stageStart, chain.effects.begin() + stageEnd,
+                                                 [](int effectType) { return effectType == EffectType::reverb; });
+
+        if (! couplesChannels && plan.numMonoSteps == plan.numSteps - (stageEnd - stageStart))
+            plan.numMonoSteps = plan.numSteps;
+
+        stageStart = stageEnd;
+    }
+
+    fuseSerialRuns(plan);
+}
+
+template<typename SampleType>
+void OutsetVerbEngine<SampleType>::chooseInstances(ExecutionPlan& plan)
+{
+    // Which instances of each effect the plan has taken from its pool so far
+    std::array<std::array<bool, maxSlots>, EffectType::numEffectTypes> taken {};
+
+    auto chooseInstance = [](auto& pool, std::array<bool, maxSlots>& poolTaken)
+    {
+        // An instance the audio thread is not running can start from silence next to
+        // the order it is running now; only a pool with none left shares one with it
+        for (const bool allowLive : { false, true })
+        {
+            for (size_t instance = 0; instance < pool.size(); ++instance)
+            {
+                if (poolTaken[instance] || (! allowLive && pool[instance].live.load(std::memory_order_acquire)))
+                    continue;
+
+                poolTaken[instance] = true;
+                return instance;
+            }
+        }
 
-    // Update chain configuration from parameters
-    chainConfiguration[0] = static_cast<int>(apvts.getRawParameterValue("chainSlot1")->load());
-    chainConfiguration[1] = static_cast<int>(apvts.getRawParameterValue("chainSlot2")->load());
-    chainConfiguration[2] = static_cast<int>(apvts.getRawParameterValue("chainSlot3")->load());
-    chainConfiguration[3] = static_cast<int>(apvts.getRawParameterValue("chainSlot4")->load());
+        // A pool has an instance for every slot, so a chain can never run out
+        jassertfalse;
+        return static_cast<size_t>(0);
+    };
+
+    for (int slot = 0; slot < maxSlots; ++slot)
+    {
+        const int effectType = plan.chain.effects[static_cast<size_t>(slot)];
+        plan.instances[static_cast<size_t>(slot)] = 0;
+
+        visitPool(effectType, [&](auto& pool)
+        {
+            plan.instances[static_cast<size_t>(slot)] = chooseInstance(pool, taken[static_cast<size_t>(effectType)]);
+        });
+    }
 }
 
 //==============================================================================
-juce::AudioProcessorValueTreeState::ParameterLayout OutsetVerbEngine::createParameterLayout()
-{
-    juce::AudioProcessorValueTreeState::ParameterLayout layout;
-
-    // BitCrusher parameters
-    layout.add(std::make_unique<juce::AudioParameterFloat>(
-        juce::ParameterID("bitDepth", 1),
-        "Bit Depth",
-        juce::NormalisableRange<float>(1.0f, 16.0f, 1.0f),
-        16.0f)
-    );
-
-    layout.add(std::make_unique<juce::AudioParameterFloat>(
-        juce::ParameterID("sampleRateReduction", 1),
-        "Sample Rate Reduction",
-        juce::NormalisableRange<float>(1.0f, 50.0f, 1.0f),
-        1.0f)
-    );
-
-    layout.add(std::make_unique<juce::AudioParameterFloat>(
-        juce::ParameterID("bitCrusherMix", 1),
-        "BitCrusher Mix",
-        juce::NormalisableRange<float>(0.0f, 1.0f, 0.01f),
-        0.0f)
-    );
-
-    // Delay parameters
-    layout.add(std::make_unique<juce::AudioParameterFloat>(
-        juce::ParameterID("delayTime", 1),
-        "Delay Time",
-        juce::NormalisableRange<float>(0.0f, 2000.0f, 1.0f),
-        250.0f)
-    );
-
-    layout.add(std::make_unique<juce::AudioParameterFloat>(
-        juce::ParameterID("delayFeedback", 1),
-        "Delay Feedback",
-        juce::NormalisableRange<float>(0.0f, 0.95f, 0.01f),
-        0.3f)
-    );
-
-    layout.add(std::make_unique<juce::AudioParameterFloat>(
-        juce::ParameterID("delayMix", 1),
-        "Delay Mix",
-        juce::NormalisableRange<float>(0.0f, 1.0f, 0.01f),
-        0.0f)
-    );
-
-    layout.add(std::make_unique<juce::AudioParameterFloat>(
-        juce::ParameterID("delayLowPassCutoff", 1),
-        "Delay Low Pass",
-        juce::NormalisableRange<float>(200.0f, 20000.0f, 1.0f),
-        8000.0f)
-    );
-
-    // EQ parameters
-    layout.add(std::make_unique<juce::AudioParameterFloat>(
-        juce::ParameterID("lowGain", 1),
-        "Low Gain",
-        juce::NormalisableRange<float>(-12.0f, 12.0f, 0.1f),
-        0.0f)
-    );
-
-    layout.add(std::make_unique<juce::AudioParameterFloat>(
-        juce::ParameterID("lowFreq", 1),
-        "Low Freq",
-        juce::NormalisableRange<float>(20.0f, 500.0f, 1.0f),
-        200.0f)
-    );
-
-    layout.add(std::make_unique<juce::AudioParameterFloat>(
-        juce::ParameterID("midGain", 1),
-        "Mid Gain",
-        juce::NormalisableRange<float>(-12.0f, 12.0f, 0.1f),
-        0.0f)
-    );
-
-    layout.add(std::make_unique<juce::AudioParameterFloat>(
-        juce::ParameterID("midFreq", 1),
-        "Mid Freq",
-        juce::NormalisableRange<float>(200.0f, 5000.0f, 1.0f),
-        1000.0f)
-    );
-
-    layout.add(std::make_unique<juce::AudioParameterFloat>(
-        juce::ParameterID("midQ", 1),
-        "Mid Q",
-        juce::NormalisableRange<float>(0.1f, 10.0f, 0.1f),
-        1.0f)
-    );
-
-    layout.add(std::make_unique<juce::AudioParameterFloat>(
-        juce::ParameterID("highGain", 1),
-        "High Gain",
-        juce::NormalisableRange<float>(-12.0f, 12.0f, 0.1f),
-        0.0f)
-    );
-
-    layout.add(std::make_unique<juce::AudioParameterFloat>(
-        juce::ParameterID("highFreq", 1),
-        "High Freq",
-        juce::NormalisableRange<float>(2000.0f, 20000.0f, 1.0f),
-        8000.0f)
-    );
-
-    // Reverb parameters
-    layout.add(std::make_unique<juce::AudioParameterFloat>(
-        juce::ParameterID("roomSize", 1),
-        "Room Size",
-        juce::NormalisableRange<float>(0.0f, 1.0f, 0.01f),
-        0.5f)
-    );
-
-    layout.add(std::make_unique<juce::AudioParameterFloat>(
-        juce::ParameterID("damping", 1),
-        "Dampening",
-        juce::NormalisableRange<float>(0.0f, 1.0f, 0.01f),
-        0.5f)
-    );
-
-    layout.add(std::make_unique<juce::AudioParameterFloat>(
-        juce::ParameterID("reverbMix", 1),
-        "Reverb Mix",
-        juce::NormalisableRange<float>(0.0f, 1.0f, 0.01f),
-        0.0f)
-    );
-
-    layout.add(std::make_unique<juce::AudioParameterFloat>(
-        juce::ParameterID("width", 1),
-        "Width",
-        juce::NormalisableRange<float>(0.0f, 1.0f, 0.01f),
-        0.5f)
-    );
-
-    layout.add(std::make_unique<juce::AudioParameterBool>(
-        juce::ParameterID("freezeMode", 1),
-        "Freeze",
-        false)
-    );
-
-    // Chain configuration parameters
-    layout.add(std::make_unique<juce::AudioParameterChoice>(
-        juce::ParameterID("chainSlot1", 1),
-        "Chain Slot 1",
-        juce::StringArray{"None", "Bit Crusher", "Delay", "EQ", "Reverb"},
-        0)  // Default: None
-    );
-
-    layout.add(std::make_unique<juce::AudioParameterChoice>(
-        juce::ParameterID("chainSlot2", 1),
-        "Chain Slot 2",
-        juce::StringArray{"None", "Bit Crusher", "Delay", "EQ", "Reverb"},
-        0)  // Default: None
-    );
-
-    layout.add(std::make_unique<juce::AudioParameterChoice>(
-        juce::ParameterID("chainSlot3", 1),
-        "Chain Slot 3",
-        juce::StringArray{"None", "Bit Crusher", "Delay", "EQ", "Reverb"},
-        0)  // Default: None
-    );
-
-    layout.add(std::make_unique<juce::AudioParameterChoice>(
-        juce::ParameterID("chainSlot4", 1),
-        "Chain Slot 4",
-        juce::StringArray{"None", "Bit Crusher", "Delay", "EQ", "Reverb"},
-        0)  // Default: None
-    );
-
-    return layout;
+template<typename SampleType>
+void OutsetVerbEngine<SampleType>::processTile(juce::dsp::AudioBlock<SampleType>& block)
+{
+    const auto numChannels = block.getNumChannels();
+    const auto numSamples = block.getNumSamples();
+
+    // Dual-mono input that has stayed that way for longer than the mono steps ring
+    // runs them on the first channel alone, then copies it to the others
+    if (numChannels > 1 && isDualMono(block))
+        dualMonoSamples += static_cast<juce::int64>(numSamples);
+    else
+        dualMonoSamples = 0;
+
+    const bool runMono = dualMonoSamples > monoSettleSamples;
+
+    if (chainTransition == ChainTransition::idle)
+    {
+        processChain(currentPlan, block, runMono, slotLevels);
+        return;
+    }
+
+    // Keep a copy of the input, for the incoming order to run on or to pass through dry
+    auto transitionBlock = juce::dsp::AudioBlock<SampleType>(transitionBuffer)
+                               .getSubsetChannelBlock(0, numChannels)
+                               .getSubBlock(0, numSamples);
+    transitionBlock.copyFrom(block);
+
+    processChain(currentPlan, block, runMono, slotLevels);
+
+    if (chainTransition == ChainTransition::crossfading)
+    {
+        // The incoming order's instances start out on every channel, so it never runs mono
+        processChain(pendingPlan, transitionBlock, false, incomingSlotLevels);
+        applyChainCrossfade(block, transitionBlock);
+    }
+    else
+    {
+        applyDryPassage(block, transitionBlock);
+    }
+}
+
+template<typename SampleType>
+void OutsetVerbEngine<SampleType>::processChain(const ExecutionPlan& plan, juce::dsp::AudioBlock<SampleType>& block, bool runMono, SlotLevels& levels)
+{
+    const auto numChannels = block.getNumChannels();
+
+    // The output of each stage is the input of the next, so each level is measured once
+    bool inputSilent = isSilent(block);
+
+    if (plan.numMonoSteps > 0 && runMono)
+    {
+        auto firstChannel = block.getSubsetChannelBlock(0, 1);
+        processSteps(plan, 0, plan.numMonoSteps, firstChannel, numChannels, inputSilent, scratch, levels);
+
+        // The reverb's stage is reached - from here on every channel is processed
+        copyFirstChannel(block);
+        processSteps(plan, plan.numMonoSteps, plan.numSteps, block, numChannels, inputSilent, scratch, levels);
+    }
+    else
+    {
+        processSteps(plan, 0, plan.numSteps, block, numChannels, inputSilent, scratch, levels);
+    }
+}
+
+template<typename SampleType>
+void OutsetVerbEngine<SampleType>::processSteps(const ExecutionPlan& plan, int firstStep, int endStep, juce::dsp::AudioBlock<SampleType>& block,
+                                                size_t numChannels, bool& inputSilent, TileScratch& tileScratch, SlotLevels& levels)
+{
+    const auto activeChannels = block.getNumChannels();
+    const auto numSamples = block.getNumSamples();
+    const bool runningMono = activeChannels < numChannels;
+
+    auto stageInput = juce::dsp::AudioBlock<SampleType>(tileScratch.stageInput)
+                          .getSubsetChannelBlock(0, activeChannels)
+                          .getSubBlock(0, numSamples);
+    auto branch = juce::dsp::AudioBlock<SampleType>(tileScratch.branch)
+                      .getSubsetChannelBlock(0, activeChannels)
+                      .getSubBlock(0, numSamples);
+    auto delayed = juce::dsp::AudioBlock<SampleType>(tileScratch.delayed)
+                       .getSubsetChannelBlock(0, activeChannels)
+                       .getSubBlock(0, numSamples);
+
+    bool stageInputSilent = inputSilent;
+
+    // The EQ whose delay the branches of the current parallel stage are matched to, if any
+    typename EngineNodes::EQ* stageEQ = nullptr;
+
+    // Per-channel effects share wide blocks out across the workers
+    auto* pool = threadedBlock && activeChannels >= static_cast<size_t>(minThreadedChannels) ? workerPool.get() : nullptr;
+
+    for (int index = firstStep; index < endStep; ++index)
+    {
+        const auto& step = plan.steps[static_cast<size_t>(index)];
+
+        // A run of steady serial effects goes through its specialized kernel in one pass,
+        // unless a pipeline stage boundary cuts it and its steps have to run separately
+        if (step.fused != nullptr && (step.numFusedSteps > 1 || pool != nullptr)
+            && index + step.numFusedSteps <= endStep && canRunFused(step, levels))
+        {
+            updateChannelStates(&step, step.numFusedSteps, runningMono, numChannels);
+            processFusedRun(step, block, inputSilent, pool, levels);
+            index += step.numFusedSteps - 1;
+            continue;
+        }
+
+        updateChannelStates(&step, 1, runningMono, numChannels);
+
+        if (step.opensParallelStage)
+        {
+            stageInput.copyFrom(block);
+            stageInputSilent = inputSilent;
+
+            // Only linear-phase EQs, which run in blocks, delay their branch
+            const auto* eqStep = step.stageEQStep >= 0 ? &plan.steps[static_cast<size_t>(step.stageEQStep)] : nullptr;
+            stageEQ = eqStep != nullptr && eqStep->activity->blockBased
+                        ? &static_cast<PooledNode<typename EngineNodes::EQ>*>(eqStep->node)->node
+                        : nullptr;
+
+            if (stageEQ != nullptr)
+                delayed.clear();
+        }
+
+        // Branches without the EQ are summed apart, to be delayed in one go at the end
+        const bool delayedBranch = stageEQ != nullptr && plan.chain.effects[static_cast<size_t>(step.slot)] != EffectType::eq;
+
+        if (step.isBranch)
+        {
+            // Later branches start from the stage input and are summed into the block
+            branch.copyFrom(stageInput);
+
+            bool branchSilent = stageInputSilent;
+            step.run(*this, step, branch, branchSilent, tileScratch);
+            applySlotLevel(levels[static_cast<size_t>(step.slot)], branch);
+
+            auto& sum = delayedBranch ? delayed : block;
+
+            for (size_t channel = 0; channel < activeChannels; ++channel)
+                juce::FloatVectorOperations::add(sum.getChannelPointer(channel),
+                                                 branch.getChannelPointer(channel),
+                                                 static_cast<int>(numSamples));
+        }
+        else
+        {
+            // Serial slots and first branches work in place with no copies
+            step.run(*this, step, block, inputSilent, tileScratch);
+            applySlotLevel(levels[static_cast<size_t>(step.slot)], block);
+
+            // A first branch to be delayed moves aside, leaving the block to the EQ branches
+            if (delayedBranch)
+            {
+                delayed.copyFrom(block);
+                block.clear();
+            }
+        }
+
+        if (step.closesParallelStage)
+        {
+            if (stageEQ != nullptr)
+            {
+                stageEQ->delayAlongside(delayed);
+                block.add(delayed);
+                stageEQ = nullptr;
+            }
+
+            inputSilent = isSilent(block);
+        }
+    }
 }
+
+template<typename SampleType>
+void OutsetVerbEngine<SampleType>::updateChannelStates(const PlanStep* steps, int numSteps, bool runningMono, size_t numChannels)
+{
+    for (int index = 0; index < numSteps; ++index)
+    {
+        const auto& step = steps[index];
+
+        if (step.copyFirstChannelState == nullptr)
+            continue;
+
+        auto& activity = *step.activity;
+
+        if (runningMono)
+        {
+            activity.monoState = true;
+        }
+        else if (activity.monoState)
+        {
+            // The channels just diverged - they pick up exactly where the first one is
+            step.copyFirstChannelState(step.node, numChannels);
+            activity.monoState = false;
+        }
+    }
+}
+
+template<typename SampleType>
+template<typename NodeType>
+void OutsetVerbEngine<SampleType>::processSlot(NodeType& node, NodeActivity& activity, juce::dsp::AudioBlock<SampleType>& block, bool& inputSilent,
+                                               TileScratch& tileScratch)
+{
+    const auto numSamples = static_cast<juce::int64>(block.getNumSamples());
+
+    if (! activity.engage.isSmoothing() && activity.engage.getTargetValue() == 0.0f)
+    {
+        // Bypassed - the input passes straight through the node's bypass path...
+        juce::dsp::ProcessContextReplacing<SampleType> context(block);
+        context.isBypassed = true;
+        node.process(context);
+
+        // ...while whatever is still circulating inside it rings out on top
+        if (! activity.asleep)
+        {
+            const bool ringOutSilent = processRingOut(node, block, tileScratch);
+
+            activity.silentSamples += numSamples;
+            activity.asleep = ringOutSilent && activity.silentSamples >= activity.tailSamples;
+
+            if (! ringOutSilent)
+                inputSilent = isSilent(block);
+        }
+        return;
+    }
+
+    // Nothing in and nothing left ringing - the block passes straight through
+    if (inputSilent && activity.asleep)
+        return;
+
+    if (activity.engage.isSmoothing())
+    {
+        processEngageRamp(node, activity, block, tileScratch);
+    }
+    else
+    {
+        juce::dsp::ProcessContextReplacing<SampleType> context(block);
+        node.process(context);
+    }
+
+    const bool outputSilent = isSilent(block);
+
+    if (inputSilent)
+    {
+        activity.silentSamples += numSamples;
+        activity.asleep = outputSilent && activity.silentSamples >= activity.tailSamples;
+    }
+    else
+    {
+        activity.silentSamples = 0;
+        activity.asleep = false;
+    }
+
+    inputSilent = outputSilent;
+}
+
+template<typename SampleType>
+template<typename NodeType>
+void OutsetVerbEngine<SampleType>::processEngageRamp(NodeType& node, NodeActivity& activity, juce::dsp::AudioBlock<SampleType>& block,
+                                                     TileScratch& tileScratch)
+{
+    const auto numSamples = block.getNumSamples();
+
+    auto dryBlock = juce::dsp::AudioBlock<SampleType>(tileScratch.bypass)
+                        .getSubsetChannelBlock(0, block.getNumChannels())
+                        .getSubBlock(0, numSamples);
+    dryBlock.copyFrom(block);
+
+    // Linear ramp across the tile from the current gain to where the smoother lands
+    const float startGain = activity.engage.getCurrentValue();
+    const float endGain = activity.engage.skip(static_cast<int>(numSamples));
+    const float gainIncrement = (endGain - startGain) / static_cast<float>(numSamples);
+
+    // Fade the effect's input rather than its output, so echoes and reverb
+    // already in flight keep ringing out after the effect is switched off
+    for (size_t channel = 0; channel < block.getNumChannels(); ++channel)
+    {
+        auto* data = block.getChannelPointer(channel);
+
+        for (size_t sample = 0; sample < numSamples; ++sample)
+            data[sample] *= startGain + gainIncrement * static_cast<float>(sample);
+    }
+
+    juce::dsp::ProcessContextReplacing<SampleType> context(block);
+    node.process(context);
+
+    // ...and bring the untouched input in around it
+    for (size_t channel = 0; channel < block.getNumChannels(); ++channel)
+    {
+        auto* data = block.getChannelPointer(channel);
+        const auto* dryData = dryBlock.getChannelPointer(channel);
+
+        for (size_t sample = 0; sample < numSamples; ++sample)
+            data[sample] += dryData[sample] * (1.0f - (startGain + gainIncrement * static_cast<float>(sample)));
+    }
+}
+
+template<typename SampleType>
+template<typename NodeType>
+bool OutsetVerbEngine<SampleType>::processRingOut(NodeType& node, juce::dsp::AudioBlock<SampleType>& block, TileScratch& tileScratch)
+{
+    auto ringOutBlock = juce::dsp::AudioBlock<SampleType>(tileScratch.bypass)
+                            .getSubsetChannelBlock(0, block.getNumChannels())
+                            .getSubBlock(0, block.getNumSamples());
+    ringOutBlock.clear();
+
+    juce::dsp::ProcessContextReplacing<SampleType> context(ringOutBlock);
+    node.process(context);
+
+    if (isSilent(ringOutBlock))
+        return true;
+
+    block.add(ringOutBlock);
+    return false;
+}
+
+template<typename SampleType>
+void OutsetVerbEngine<SampleType>::applySlotLevel(juce::SmoothedValue<float>& level, juce::dsp::AudioBlock<SampleType>& block)
+{
+    const auto numSamples = block.getNumSamples();
+
+    if (! level.isSmoothing())
+    {
+        const float gain = level.getTargetValue();
+
+        if (gain != 1.0f)
+            for (size_t channel = 0; channel < block.getNumChannels(); ++channel)
+                juce::FloatVectorOperations::multiply(block.getChannelPointer(channel), static_cast<SampleType>(gain), static_cast<int>(numSamples));
+
+        return;
+    }
+
+    // Linear ramp across the tile from the current level to where the smoother lands
+    const float startGain = level.getCurrentValue();
+    const float endGain = level.skip(static_cast<int>(numSamples));
+    const float gainIncrement = (endGain - startGain) / static_cast<float>(numSamples);
+
+    for (size_t channel = 0; channel < block.getNumChannels(); ++channel)
+    {
+        auto* data = block.getChannelPointer(channel);
+
+        for (size_t sample = 0; sample < numSamples; ++sample)
+            data[sample] *= startGain + gainIncrement * static_cast<float>(sample);
+    }
+}
+
+//==============================================================================
+template<typename SampleType>
+void OutsetVerbEngine<SampleType>::adoptInstances(const ExecutionPlan& plan)
+{
+    bool adoptedAny = false;
+
+    for (int index = 0; index < plan.numSteps; ++index)
+    {
+        const auto& step = plan.steps[static_cast<size_t>(index)];
+
+        if (step.adopt != nullptr)
+            adoptedAny = step.adopt(*this, step.node) || adoptedAny;
+    }
+
+    // The newcomers' bypass and tails were left alone while they were cold
+    if (adoptedAny)
+    {
+        updateEngageTargets();
+        updateTailLengths();
+    }
+}
+
+template<typename SampleType>
+void OutsetVerbEngine<SampleType>::beginChainTransition(const ExecutionPlan& newPlan)
+{
+    // Changed and changed back before this thread saw it - the order running now
+    // carries on, and the instances the new plan was given are never taken over
+    if (newPlan.chain == currentPlan.chain)
+        return;
+
+    // Instances only become the audio thread's once it sees a plan binding them
+    adoptInstances(newPlan);
+    pendingPlan = newPlan;
+
+    // No crossfade configured - switch on the spot
+    if (chainCrossfadeSeconds <= 0.0)
+    {
+        resetJoiningInstances();
+        switchToPendingPlan();
+        return;
+    }
+
+    const auto sharesInstance = std::any_of(newPlan.steps.begin(), newPlan.steps.begin() + newPlan.numSteps, [this](const PlanStep& step)
+    {
+        const auto end = currentPlan.steps.begin() + currentPlan.numSteps;
+        return step.node != nullptr
+               && std::any_of(currentPlan.steps.begin(), end, [&step](const PlanStep& running) { return running.node == step.node; });
+    });
+
+    // An instance cannot run in both orders at once, so if a pool ran short the old
+    // order fades out to the dry signal before the new one fades in, half the time each
+    if (sharesInstance)
+    {
+        chainTransition = ChainTransition::fadingOut;
+        chainMix.reset(currentSampleRate, chainCrossfadeSeconds * 0.5);
+        chainMix.setCurrentAndTargetValue(1.0f);
+        chainMix.setTargetValue(0.0f);
+        return;
+    }
+
+    // Otherwise both orders run across the whole window and the new one takes over
+    // from the old at equal power, so tails never drop out to the dry signal
+    resetJoiningInstances();
+    incomingSlotLevels = slotLevels;
+
+    chainTransition = ChainTransition::crossfading;
+    chainMix.reset(currentSampleRate, chainCrossfadeSeconds);
+    chainMix.setCurrentAndTargetValue(0.0f);
+    chainMix.setTargetValue(1.0f);
+
+    // Until the old order is gone the host has to wait out both tails
+    updateTailLengths();
+}
+
+template<typename SampleType>
+void OutsetVerbEngine<SampleType>::fetchChainOrder()
+{
+    // In pipelined mode the plan only changes while no tile is in flight, and the
+    // nodes catch up on any values no tile has carried to them yet
+    auto takePublishedPlan = [this]
+    {
+        if (! stageWorkers.empty())
+        {
+            drainPipeline();
+            updateChainParameters(publishedParameters.read());
+        }
+
+        beginChainTransition(publishedPlans.read());
+        retireUnboundInstances();
+
+        // Only stored once the new plan's instances are live, so the message thread
+        // never mistakes an instance this thread is about to take over for a free one
+        acknowledgedPlanSerial.store(publishedPlans.read().serial, std::memory_order_release);
+    };
+
+    // Only two orders ever run at once, so a new one waits for a transition to finish
+    if (chainTransition != ChainTransition::idle)
+        return;
+
+    if (publishedPlans.fetch())
+        takePublishedPlan();
+
+    // The newest values fetched, which in pipelined mode the nodes may not have yet
+    const auto& newestValues = publishedParameters.read();
+
+    if (! nonRealtime.load(std::memory_order_relaxed) || ! chainBuilder.joinable()
+        || readChainConfiguration(newestValues) == pendingPlan.chain)
+        return;
+
+    // Offline, the builder allocates and compiles the new order straight away while
+    // this thread waits, so bounced chain automation lands exactly where it is written
+    {
+        std::unique_lock<std::mutex> lock(chainBuildMutex);
+        chainBuildRequest = newestValues;
+        chainBuildRequested = true;
+        chainBuildCondition.notify_all();
+        chainBuildCondition.wait(lock, [this] { return ! chainBuildRequested; });
+    }
+
+    if (publishedPlans.fetch())
+        takePublishedPlan();
+}
+
+template<typename SampleType>
+void OutsetVerbEngine<SampleType>::startChainBuilder()
+{
+    chainBuilderShouldExit = false;
+    chainBuilder = std::thread([this] { chainBuilderLoop(); });
+}
+
+template<typename SampleType>
+void OutsetVerbEngine<SampleType>::stopChainBuilder()
+{
+    if (! chainBuilder.joinable())
+        return;
+
+    {
+        std::lock_guard<std::mutex> lock(chainBuildMutex);
+        chainBuilderShouldExit = true;
+    }
+
+    chainBuildCondition.notify_all();
+    chainBuilder.join();
+}
+
+template<typename SampleType>
+void OutsetVerbEngine<SampleType>::chainBuilderLoop()
+{
+    std::unique_lock<std::mutex> lock(chainBuildMutex);
+
+    for (;;)
+    {
+        chainBuildCondition.wait(lock, [this] { return chainBuilderShouldExit || chainBuildRequested; });
+
+        if (chainBuilderShouldExit)
+            return;
+
+        // The audio thread is waiting and leaves the request alone until it is done
+        lock.unlock();
+        updateChainOrder(chainBuildRequest);
+        lock.lock();
+
+        chainBuildRequested = false;
+        chainBuildCondition.notify_all();
+    }
+}
+
+template<typename SampleType>
+void OutsetVerbEngine<SampleType>::applyChainCrossfade(juce::dsp::AudioBlock<SampleType>& block, const juce::dsp::AudioBlock<SampleType>& incoming)
+{
+    const auto numSamples = block.getNumSamples();
+
+    // Linear ramp across the tile from the current mix to where the smoother lands,
+    // turned into equal-power gains once for every channel
+    const float startMix = chainMix.getCurrentValue();
+    const float endMix = chainMix.skip(static_cast<int>(numSamples));
+    const float mixIncrement = (endMix - startMix) / static_cast<float>(numSamples);
+
+    std::array<SampleType, tileSize> outgoingGains, incomingGains;
+
+    for (size_t sample = 0; sample < numSamples; ++sample)
+    {
+        const float angle = (startMix + mixIncrement * static_cast<float>(sample)) * juce::MathConstants<float>::halfPi;
+        outgoingGains[sample] = static_cast<SampleType>(std::cos(angle));
+        incomingGains[sample] = static_cast<SampleType>(std::sin(angle));
+    }
+
+    for (size_t channel = 0; channel < block.getNumChannels(); ++channel)
+    {
+        auto* outgoingData = block.getChannelPointer(channel);
+        const auto* incomingData = incoming.getChannelPointer(channel);
+
+        for (size_t sample = 0; sample < numSamples; ++sample)
+            outgoingData[sample] = outgoingData[sample] * outgoingGains[sample] + incomingData[sample] * incomingGains[sample];
+    }
+
+    if (chainMix.isSmoothing())
+        return;
+
+    // Only the new order is heard now, on levels that have been ramping alongside
+    slotLevels = incomingSlotLevels;
+    switchToPendingPlan();
+    chainTransition = ChainTransition::idle;
+}
+
+template<typename SampleType>
+void OutsetVerbEngine<SampleType>::applyDryPassage(juce::dsp::AudioBlock<SampleType>& block, const juce::dsp::AudioBlock<SampleType>& dry)
+{
+    const auto numSamples = block.getNumSamples();
+
+    // Linear ramp across the tile from the current mix to where the smoother lands
+    const float startMix = chainMix.getCurrentValue();
+    const float endMix = chainMix.skip(static_cast<int>(numSamples));
+    const float mixIncrement = (endMix - startMix) / static_cast<float>(numSamples);
+
+    for (size_t channel = 0; channel < block.getNumChannels(); ++channel)
+    {
+        auto* wetData = block.getChannelPointer(channel);
+        const auto* dryData = dry.getChannelPointer(channel);
+
+        for (size_t sample = 0; sample < numSamples; ++sample)
+        {
+            const float mixAmount = startMix + mixIncrement * static_cast<float>(sample);
+            wetData[sample] = dryData[sample] + mixAmount * (wetData[sample] - dryData[sample]);
+        }
+    }
+
+    if (chainMix.isSmoothing())
+        return;
+
+    // Fully dry - safe to swap the order and fade the new one in
+    if (chainTransition == ChainTransition::fadingOut)
+    {
+        resetJoiningInstances();
+        switchToPendingPlan();
+        chainTransition = ChainTransition::fadingIn;
+        chainMix.setTargetValue(1.0f);
+    }
+    else
+    {
+        chainTransition = ChainTransition::idle;
+    }
+}
+
+template<typename SampleType>
+void OutsetVerbEngine<SampleType>::resetJoiningInstances()
+{
+    // Instances joining the chain would otherwise replay whatever they last processed
+    const auto runningBegin = currentPlan.steps.begin();
+    const auto runningEnd = runningBegin + currentPlan.numSteps;
+
+    for (int index = 0; index < pendingPlan.numSteps; ++index)
+    {
+        const auto& step = pendingPlan.steps[static_cast<size_t>(index)];
+
+        if (step.reset == nullptr)
+            continue;
+
+        const bool wasRunning = std::any_of(runningBegin, runningEnd,
+                                            [&step](const PlanStep& running) { return running.node == step.node; });
+
+        if (! wasRunning)
+            step.reset(step.node);
+    }
+}
+
+template<typename SampleType>
+void OutsetVerbEngine<SampleType>::switchToPendingPlan()
+{
+    currentPlan = pendingPlan;
+    retireUnboundInstances();
+
+    updatePipelineStages();
+    updateTailLengths();
+    updateChainLatency();
+}
+
+template<typename SampleType>
+void OutsetVerbEngine<SampleType>::retireUnboundInstances()
+{
+    auto isBound = [](const ExecutionPlan& plan, const void* pooledNode)
+    {
+        const auto end = plan.steps.begin() + plan.numSteps;
+        return std::any_of(plan.steps.begin(), end, [pooledNode](const PlanStep& step) { return step.node == pooledNode; });
+    };
+
+    auto retirePool = [this, &isBound](auto& pool)
+    {
+        forEachLiveInstance(pool, [this, &isBound](auto& pooledNode)
+        {
+            // Releasing the flag publishes everything this thread did to the instance
+            if (! isBound(currentPlan, &pooledNode) && ! isBound(pendingPlan, &pooledNode))
+                pooledNode.live.store(false, std::memory_order_release);
+        });
+    };
+
+    retirePool(bitCrusherPool);
+    retirePool(delayPool);
+    retirePool(eqPool);
+    retirePool(reverbPool);
+}
+
+template<typename SampleType>
+void OutsetVerbEngine<SampleType>::releaseRetiredInstances()
+{
+    // Plans are only ever picked up newest first, so an instance no plan since the
+    // acknowledged one binds is never handed to the audio thread again
+    const auto acknowledgedSerial = acknowledgedPlanSerial.load(std::memory_order_acquire);
+
+    auto releasePool = [acknowledgedSerial](auto& pool)
+    {
+        for (auto& pooledNode : pool)
+        {
+            if (! pooledNode.warm.load(std::memory_order_relaxed) || pooledNode.lastBindingSerial > acknowledgedSerial
+                || pooledNode.live.load(std::memory_order_acquire))
+                continue;
+
+            // As prepare() drops state: live is already clear, as the audio thread left it
+            pooledNode.warm.store(false, std::memory_order_relaxed);
+            pooledNode.state.release();
+        }
+    };
+
+    releasePool(bitCrusherPool);
+    releasePool(delayPool);
+    releasePool(eqPool);
+    releasePool(reverbPool);
+}
+
+//==============================================================================
+template<typename SampleType>
+void OutsetVerbEngine<SampleType>::processPipelined(juce::dsp::AudioBlock<SampleType>& block)
+{
+    const auto numChannels = block.getNumChannels();
+
+    // Hosts passing more than they prepared for are handled one prepared block at a
+    // time, so the tiles in flight never outgrow the pool
+    for (size_t start = 0; start < block.getNumSamples(); start += static_cast<size_t>(preparedBlockSize))
+    {
+        auto chunk = block.getSubBlock(start, juce::jmin(static_cast<size_t>(preparedBlockSize), block.getNumSamples() - start));
+        const auto numSamples = chunk.getNumSamples();
+
+        // New values travel with the tiles and each stage applies them as the first
+        // tile carrying them arrives. The plan can only change while no tile is in
+        // flight, so a new order still waits for the pipeline to empty.
+        if (publishedParameters.fetch())
+            ++pipelineParametersSerial;
+
+        fetchChainOrder();
+
+        // Gather the input into tiles, sending each one off as soon as it is full...
+        for (size_t position = 0; position < numSamples;)
+        {
+            if (inputTile < 0)
+            {
+                jassert(! freeTiles.empty());
+                inputTile = freeTiles.back();
+                freeTiles.pop_back();
+                inputTileSamples = 0;
+            }
+
+            const auto count = juce::jmin(static_cast<size_t>(tileSize - inputTileSamples), numSamples - position);
+
+            juce::dsp::AudioBlock<SampleType>(pipelineTiles[static_cast<size_t>(inputTile)].buffer)
+                .getSubsetChannelBlock(0, numChannels)
+                .getSubBlock(static_cast<size_t>(inputTileSamples), count)
+                .copyFrom(chunk.getSubBlock(position, count));
+
+            inputTileSamples += static_cast<int>(count);
+            position += count;
+
+            if (inputTileSamples == tileSize)
+            {
+                submitTile(inputTile);
+                inputTile = -1;
+            }
+        }
+
+        // ...then read the output back from tiles submitted latencySamples earlier
+        for (size_t position = 0; position < numSamples;)
+        {
+            if (preRollSamples > 0)
+            {
+                const auto count = juce::jmin(static_cast<size_t>(preRollSamples), numSamples - position);
+                chunk.getSubBlock(position, count).clear();
+
+                preRollSamples -= static_cast<int>(count);
+                position += count;
+                continue;
+            }
+
+            if (outputTile < 0)
+            {
+                outputTile = takeFinishedTile();
+                outputTileSamples = 0;
+            }
+
+            const auto count = juce::jmin(static_cast<size_t>(tileSize - outputTileSamples), numSamples - position);
+
+            chunk.getSubBlock(position, count)
+                .copyFrom(juce::dsp::AudioBlock<SampleType>(pipelineTiles[static_cast<size_t>(outputTile)].buffer)
+                              .getSubsetChannelBlock(0, numChannels)
+                              .getSubBlock(static_cast<size_t>(outputTileSamples), count));
+
+            outputTileSamples += static_cast<int>(count);
+            position += count;
+
+            if (outputTileSamples == tileSize)
+            {
+                freeTiles.push_back(outputTile);
+                outputTile = -1;
+            }
+        }
+    }
+}
+
+template<typename SampleType>
+void OutsetVerbEngine<SampleType>::submitTile(int tileIndex)
+{
+    auto& tile = pipelineTiles[static_cast<size_t>(tileIndex)];
+    juce::dsp::AudioBlock<SampleType> block(tile.buffer);
+
+    // The stages always see every channel, so the dual-mono count starts over
+    dualMonoSamples = 0;
+
+    // A crossfade mixes the whole chain's output with its input, so it runs here
+    if (chainTransition != ChainTransition::idle)
+    {
+        drainPipeline();
+        updateChainParameters(publishedParameters.read());
+        processTile(block);
+        finishedTiles.push(tileIndex);
+        return;
+    }
+
+    tile.inputSilent = isSilent(block);
+    tile.parameters = publishedParameters.read();
+    tile.parametersSerial = pipelineParametersSerial;
+
+    stageQueues[0].push(tileIndex);
+    ++tilesInPipeline;
+    wakeStageWorker(0);
+}
+
+template<typename SampleType>
+int OutsetVerbEngine<SampleType>::takeFinishedTile()
+{
+    // Tiles taken off early by drainPipeline() are older than anything still in flight
+    int tileIndex = -1;
+
+    if (finishedTiles.pop(tileIndex))
+        return tileIndex;
+
+    while (! pipelineOutput.pop(tileIndex))
+        waitForPipelineOutput();
+
+    --tilesInPipeline;
+    return tileIndex;
+}
+
+template<typename SampleType>
+void OutsetVerbEngine<SampleType>::drainPipeline()
+{
+    while (tilesInPipeline > 0)
+    {
+        int tileIndex = -1;
+
+        if (pipelineOutput.pop(tileIndex))
+        {
+            finishedTiles.push(tileIndex);
+            --tilesInPipeline;
+        }
+        else
+        {
+            waitForPipelineOutput();
+        }
+    }
+}
+
+template<typename SampleType>
+void OutsetVerbEngine<SampleType>::waitForPipelineOutput()
+{
+    std::unique_lock<std::mutex> lock(pipelineOutputMutex);
+    pipelineOutputCondition.wait(lock, [this] { return ! pipelineOutput.isEmpty(); });
+}
+
+template<typename SampleType>
+void OutsetVerbEngine<SampleType>::resetPipelineTiles()
+{
+    jassert(tilesInPipeline == 0);
+
+    freeTiles.clear();
+
+    for (int index = static_cast<int>(pipelineTiles.size()); --index >= 0;)
+        freeTiles.push_back(index);
+
+    finishedTiles.clear();
+    inputTile = -1;
+    outputTile = -1;
+    preRollSamples = latencySamples;
+}
+
+template<typename SampleType>
+void OutsetVerbEngine<SampleType>::updatePipelineStages()
+{
+    // Stages of empty slots only scale by their levels, so they share the stage before them
+    numPipelineStages = 0;
+
+    for (int index = 0; index < currentPlan.numSteps; ++index)
+    {
+        const auto& step = currentPlan.steps[static_cast<size_t>(index)];
+
+        if (step.isBranch)
+            continue;
+
+        const int stageEnd = currentPlan.chain.getStageEnd(step.slot);
+        const bool hasEffect = std::any_of(currentPlan.steps.begin() + index, currentPlan.steps.begin() + (index + stageEnd - step.slot),
+                                           [](const PlanStep& stageStep) { return stageStep.activity != nullptr; });
+
+        if (numPipelineStages == 0 || hasEffect)
+            pipelineStageStarts[static_cast<size_t>(numPipelineStages++)] = index;
+    }
+
+    pipelineStageStarts[static_cast<size_t>(numPipelineStages)] = currentPlan.numSteps;
+
+    // Pipelining only runs offline and the pipeline is empty whenever the plan
+    // changes, so the workers can be swapped for the right number of them here
+    if (! stageWorkers.empty() && static_cast<int>(stageWorkers.size()) != numPipelineStages)
+    {
+        stopStageWorkers();
+        startStageWorkers();
+    }
+}
+
+template<typename SampleType>
+void OutsetVerbEngine<SampleType>::applyStageParameters(int stage, const Parameters& values)
+{
+    const int firstStep = pipelineStageStarts[static_cast<size_t>(stage)];
+    const int endStep = pipelineStageStarts[static_cast<size_t>(stage) + 1];
+
+    for (int index = firstStep; index < endStep; ++index)
+    {
+        const auto& step = currentPlan.steps[static_cast<size_t>(index)];
+
+        if (step.sync != nullptr)
+            step.sync(*this, step.node, values);
+
+        slotLevels[static_cast<size_t>(step.slot)].setTargetValue(values[Parameters::chainSlot1LevelParam + step.slot]);
+    }
+
+    // Each stage only re-estimates its own steps; the total is as fresh as the
+    // stages ahead of this one, which took the values up first
+    stageTailSeconds[static_cast<size_t>(stage)].store(getStepsTailSeconds(currentPlan, firstStep, endStep), std::memory_order_relaxed);
+
+    double chainTail = 0.0;
+
+    for (int index = 0; index < numPipelineStages; ++index)
+        chainTail += stageTailSeconds[static_cast<size_t>(index)].load(std::memory_order_relaxed);
+
+    tailLengthSeconds.store(chainTail, std::memory_order_relaxed);
+}
+
+template<typename SampleType>
+void OutsetVerbEngine<SampleType>::startStageWorkers()
+{
+    jassert(numPipelineStages > 0);
+
+    stageWorkersShouldExit = false;
+    stageWorkers.reserve(static_cast<size_t>(maxSlots));
+
+    // A worker spinning for a tile on a shared core only holds up the stage it waits on
+    stageWorkersSpin = numPipelineStages < static_cast<int>(std::thread::hardware_concurrency());
+
+    for (int stage = 0; stage < numPipelineStages; ++stage)
+        stageWorkers.emplace_back([this, stage] { stageWorkerLoop(stage); });
+}
+
+template<typename SampleType>
+void OutsetVerbEngine<SampleType>::stopStageWorkers()
+{
+    if (stageWorkers.empty())
+        return;
+
+    drainPipeline();
+
+    {
+        std::lock_guard<std::mutex> lock(stageWakeMutex);
+        stageWorkersShouldExit = true;
+    }
+
+    for (auto& condition : stageWakeConditions)
+        condition.notify_all();
+
+    for (auto& worker : stageWorkers)
+        worker.join();
+
+    stageWorkers.clear();
+}
+
+template<typename SampleType>
+void OutsetVerbEngine<SampleType>::wakeStageWorker(int stage)
+{
+    // Taking the lock means a worker about to sleep either sees the new tile or gets the notification
+    {
+        std::lock_guard<std::mutex> lock(stageWakeMutex);
+    }
+
+    stageWakeConditions[static_cast<size_t>(stage)].notify_one();
+}
+
+template<typename SampleType>
+void OutsetVerbEngine<SampleType>::stageWorkerLoop(int stage)
+{
+    // The stages are audio processing, so flush denormals as the audio thread does
+    juce::ScopedNoDenormals noDenormals;
+
+    auto& input = stageQueues[static_cast<size_t>(stage)];
+    auto& stageTileScratch = stageScratch[static_cast<size_t>(stage)];
+
+    auto tileQueued = [&input] { return ! input.isEmpty(); };
+
+    for (;;)
+    {
+        int tileIndex = -1;
+
+        // Spin briefly, as the next tile usually follows close behind, then sleep
+        while (! input.pop(tileIndex))
+        {
+            if (stageWorkersSpin && WorkerPool::spinUntil(tileQueued))
+                continue;
+
+            std::unique_lock<std::mutex> lock(stageWakeMutex);
+            stageWakeConditions[static_cast<size_t>(stage)].wait(lock, [this, &tileQueued] { return stageWorkersShouldExit || tileQueued(); });
+
+            if (stageWorkersShouldExit)
+                return;
+        }
+
+        // The stage layout was written before the tile was queued, and cannot change while it is in flight
+        auto& tile = pipelineTiles[static_cast<size_t>(tileIndex)];
+        juce::dsp::AudioBlock<SampleType> block(tile.buffer);
+
+        auto& appliedSerial = stageParametersSerials[static_cast<size_t>(stage)];
+
+        if (tile.parametersSerial != appliedSerial)
+        {
+            applyStageParameters(stage, tile.parameters);
+            appliedSerial = tile.parametersSerial;
+        }
+
+        processSteps(currentPlan, pipelineStageStarts[static_cast<size_t>(stage)], pipelineStageStarts[static_cast<size_t>(stage) + 1],
+                     block, block.getNumChannels(), tile.inputSilent, stageTileScratch, slotLevels);
+
+        // The last stage hands the tile back to the audio thread
+        if (stage + 1 < numPipelineStages)
+        {
+            stageQueues[static_cast<size_t>(stage) + 1].push(tileIndex);
+            wakeStageWorker(stage + 1);
+        }
+        else
+        {
+            pipelineOutput.push(tileIndex);
+
+            {
+                std::lock_guard<std::mutex> lock(pipelineOutputMutex);
+            }
+
+            pipelineOutputCondition.notify_one();
+        }
+    }
+}
+
+//==============================================================================
+template<typename SampleType>
+template<typename NodeType>
+void OutsetVerbEngine<SampleType>::runNode(OutsetVerbEngine& engine, const PlanStep& step, juce::dsp::AudioBlock<SampleType>& block, bool& inputSilent,
+                                           TileScratch& tileScratch)
+{
+    auto& pooledNode = *static_cast<PooledNode<NodeType>*>(step.node);
+    engine.processSlot(pooledNode.node, pooledNode.activity, block, inputSilent, tileScratch);
+}
+
+template<typename SampleType>
+template<typename NodeType>
+void OutsetVerbEngine<SampleType>::resetNode(void* pooledNode)
+{
+    auto& pooled = *static_cast<PooledNode<NodeType>*>(pooledNode);
+    pooled.node.reset();
+
+    // Start from a clean slate, fully in or out as its bypass state asks
+    pooled.activity.silentSamples = 0;
+    pooled.activity.asleep = false;
+    pooled.activity.monoState = false;
+    pooled.activity.engage.setCurrentAndTargetValue(pooled.activity.engage.getTargetValue());
+}
+
+template<typename SampleType>
+template<typename NodeType>
+void OutsetVerbEngine<SampleType>::copyFirstChannelState(void* pooledNode, size_t numChannels)
+{
+    auto& node = static_cast<PooledNode<NodeType>*>(pooledNode)->node;
+
+    for (size_t channel = 1; channel < numChannels; ++channel)
+        node.copyChannelState(0, channel);
+}
+
+template<typename SampleType>
+template<typename NodeType>
+bool OutsetVerbEngine<SampleType>::adoptNode(OutsetVerbEngine& engine, void* pooledNode)
+{
+    auto& pooled = *static_cast<PooledNode<NodeType>*>(pooledNode);
+
+    if (pooled.live.load(std::memory_order_relaxed))
+        return false;
+
+    // The warm flag and the plan hand-over make the prewarming thread's writes
+    // visible here, and that thread leaves a warm instance alone until it is let go
+    pooled.live.store(true, std::memory_order_relaxed);
+    engine.syncInstance(pooled, engine.lastParameterValues, false);
+
+    if constexpr (designsFilters<NodeType>)
+        pooled.node.setDesignInBackground(engine.filtersDesignedInBackground);
+
+    return true;
+}
+
+template<typename SampleType>
+template<typename NodeType>
+void OutsetVerbEngine<SampleType>::syncNode(OutsetVerbEngine& engine, void* pooledNode, const Parameters& values)
+{
+    auto& pooled = *static_cast<PooledNode<NodeType>*>(pooledNode);
+
+    engine.syncInstance(pooled, values, false);
+    engine.updateEngageTarget(pooled, values);
+    engine.updateTailLength(pooled);
+}
+
+template<typename SampleType>
+void OutsetVerbEngine<SampleType>::runEmptySlot(OutsetVerbEngine&, const PlanStep&, juce::dsp::AudioBlock<SampleType>&, bool&, TileScratch&)
+{
+}
+
+template<typename SampleType>
+template<typename NodeType>
+void OutsetVerbEngine<SampleType>::bindStep(PlanStep& step, PooledNode<NodeType>& pooledNode)
+{
+    step.run = &runNode<NodeType>;
+    step.reset = &resetNode<NodeType>;
+    step.adopt = &adoptNode<NodeType>;
+    step.sync = &syncNode<NodeType>;
+    step.node = &pooledNode;
+    step.activity = &pooledNode.activity;
+
+    // The reverb only ever runs on every channel
+    if constexpr (! std::is_same_v<NodeType, typename EngineNodes::Reverb>)
+        step.copyFirstChannelState = &copyFirstChannelState<NodeType>;
+}
+
+//==============================================================================
+template<typename SampleType>
+void OutsetVerbEngine<SampleType>::fuseSerialRuns(ExecutionPlan& plan)
+{
+    auto isFusable = [&plan](int index)
+    {
+        const auto& step = plan.steps[static_cast<size_t>(index)];
+        const int effectType = plan.chain.effects[static_cast<size_t>(step.slot)];
+
+        return ! step.opensParallelStage && ! step.isBranch
+            && effectType >= EffectType::bitCrusher
+            && effectType < EffectType::bitCrusher + static_cast<int>(numFusableTypes);
+    };
+
+    for (int runStart = 0; runStart < plan.numSteps;)
+    {
+        int runEnd = runStart;
+
+        while (runEnd < plan.numSteps && runEnd - runStart < maxFusedSteps && isFusable(runEnd))
+            ++runEnd;
+
+        // A lone effect gains nothing from fusing, so processChain only runs it
+        // through its kernel when spreading its channels across the workers
+        if (runEnd > runStart)
+        {
+            auto& firstStep = plan.steps[static_cast<size_t>(runStart)];
+            firstStep.fused = getFusedKernel(plan.chain, firstStep.slot, runEnd - runStart);
+            firstStep.numFusedSteps = runEnd - runStart;
+        }
+
+        runStart = juce::jmax(runEnd, runStart + 1);
+    }
+}
+
+template<typename SampleType>
+bool OutsetVerbEngine<SampleType>::canRunFused(const PlanStep& firstStep, const SlotLevels& levels)
+{
+    const auto* steps = &firstStep;
+
+    for (int index = 0; index < firstStep.numFusedSteps; ++index)
+    {
+        const auto& engage = steps[index].activity->engage;
+
+        if (steps[index].activity->blockBased || engage.isSmoothing() || engage.getTargetValue() != 1.0f
+            || levels[static_cast<size_t>(steps[index].slot)].isSmoothing())
+            return false;
+    }
+
+    return true;
+}
+
+template<typename SampleType>
+void OutsetVerbEngine<SampleType>::processFusedRun(const PlanStep& firstStep, juce::dsp::AudioBlock<SampleType>& block, bool& inputSilent, WorkerPool* pool,
+                                                   const SlotLevels& levels)
+{
+    const auto* steps = &firstStep;
+    const int numSteps = firstStep.numFusedSteps;
+
+    std::array<float, maxFusedSteps> runLevels {};
+    bool allAsleep = true;
+
+    for (int index = 0; index < numSteps; ++index)
+    {
+        runLevels[static_cast<size_t>(index)] = levels[static_cast<size_t>(steps[index].slot)].getTargetValue();
+        allAsleep = allAsleep && steps[index].activity->asleep;
+    }
+
+    // Nothing in and nothing left ringing anywhere in the run
+    if (inputSilent && allAsleep)
+        return;
+
+    firstStep.fused(steps, runLevels.data(), block, pool);
+
+    const bool outputSilent = isSilent(block);
+    const auto numSamples = static_cast<juce::int64>(block.getNumSamples());
+
+    // Only the ends of the run are measured, so each effect also waits out the
+    // tails of the effects ahead of it before it counts its own input as silent
+    juce::int64 tailSamplesSoFar = 0;
+
+    for (int index = 0; index < numSteps; ++index)
+    {
+        auto& activity = *steps[index].activity;
+
+        if (inputSilent)
+        {
+            tailSamplesSoFar = activity.tailSamples > std::numeric_limits<juce::int64>::max() - tailSamplesSoFar
+                                 ? std::numeric_limits<juce::int64>::max()
+                                 : tailSamplesSoFar + activity.tailSamples;
+
+            activity.silentSamples += numSamples;
+            activity.asleep = outputSilent && activity.silentSamples >= tailSamplesSoFar;
+        }
+        else
+        {
+            activity.silentSamples = 0;
+            activity.asleep = false;
+        }
+    }
+
+    inputSilent = outputSilent;
+}
+
+template<typename SampleType>
+template<typename... NodeTypes>
+void OutsetVerbEngine<SampleType>::runFused(const PlanStep* steps, const float* levels, juce::dsp::AudioBlock<SampleType>& block, WorkerPool* pool)
+{
+    runFusedSteps<NodeTypes...>(std::index_sequence_for<NodeTypes...>(), steps, levels, block, pool);
+}
+
+template<typename SampleType>
+template<typename... NodeTypes, size_t... Indices>
+void OutsetVerbEngine<SampleType>::runFusedSteps(std::index_sequence<Indices...>, const PlanStep* steps, const float* levels,
+                                                 juce::dsp::AudioBlock<SampleType>& block, WorkerPool* pool)
+{
+    std::tuple<NodeTypes&...> nodes { static_cast<PooledNode<NodeTypes>*>(steps[Indices].node)->node... };
+
+    // Every node has to accept the sub-block, so the strictest one sets its length
+    constexpr int subBlockSize = std::min({ NodeTypes::maxSubBlockSize... });
+
+    using RunType = std::common_type_t<SampleType, typename NodeTypes::StateType...>;
+
+    const auto numChannels = block.getNumChannels();
+    const auto numSamples = block.getNumSamples();
+
+    for (size_t start = 0; start < numSamples; start += subBlockSize)
+    {
+        const auto subBlockSamples = juce::jmin(numSamples - start, static_cast<size_t>(subBlockSize));
+
+        // Ramps and coefficients are shared by every channel, so they move on here...
+        (std::get<Indices>(nodes).beginSubBlock(static_cast<int>(subBlockSamples)), ...);
+
+        // ...and each channel only touches its own state, so channels can run on any thread
+        auto processChannel = [&](int channelIndex)
+        {
+            const auto channel = static_cast<size_t>(channelIndex);
+            auto* data = block.getChannelPointer(channel) + start;
+
+            for (size_t sample = 0; sample < subBlockSamples; ++sample)
+            {
+                // The sample stays in a register from the first node of the run to the last
+                auto value = static_cast<RunType>(data[sample]);
+                ((value = static_cast<RunType>(std::get<Indices>(nodes).processSample(channel, static_cast<int>(sample),
+                                                   static_cast<typename NodeTypes::StateType>(value)))
+                          * static_cast<RunType>(levels[Indices])), ...);
+                data[sample] = static_cast<SampleType>(value);
+            }
+        };
+
+        if (pool != nullptr)
+        {
+            pool->run(static_cast<int>(numChannels), processChannel);
+        }
+        else
+        {
+            for (size_t channel = 0; channel < numChannels; ++channel)
+                processChannel(static_cast<int>(channel));
+        }
+    }
+}
+
+template<typename SampleType>
+constexpr size_t OutsetVerbEngine<SampleType>::countFusedSequences(int numSteps)
+{
+    size_t count = 1;
+
+    for (int step = 0; step < numSteps; ++step)
+        count *= numFusableTypes;
+
+    return count;
+}
+
+template<typename SampleType>
+template<size_t Sequence, size_t... Positions>
+constexpr typename OutsetVerbEngine<SampleType>::PlanStep::FusedFunction OutsetVerbEngine<SampleType>::makeFusedKernel(std::index_sequence<Positions...>)
+{
+    return &runFused<std::tuple_element_t<(Sequence / countFusedSequences(static_cast<int>(Positions))) % numFusableTypes,
+                                          FusableNodeTypes>...>;
+}
+
+template<typename SampleType>
+template<int NumSteps, size_t... Sequences>
+constexpr std::array<typename OutsetVerbEngine<SampleType>::PlanStep::FusedFunction, sizeof...(Sequences)>
+OutsetVerbEngine<SampleType>::makeFusedKernelTable(std::index_sequence<Sequences...>)
+{
+    return {{ makeFusedKernel<Sequences>(std::make_index_sequence<static_cast<size_t>(NumSteps)>())... }};
+}
+
+template<typename SampleType>
+typename OutsetVerbEngine<SampleType>::PlanStep::FusedFunction OutsetVerbEngine<SampleType>::getFusedKernel(const ChainConfiguration& chain, int firstSlot, int numSteps)
+{
+    static_assert(maxFusedSteps == 4, "getFusedKernel needs a table for every run length");
+
+    static constexpr auto singleKernels = makeFusedKernelTable<1>(std::make_index_sequence<countFusedSequences(1)>());
+    static constexpr auto pairKernels = makeFusedKernelTable<2>(std::make_index_sequence<countFusedSequences(2)>());
+    static constexpr auto tripleKernels = makeFusedKernelTable<3>(std::make_index_sequence<countFusedSequences(3)>());
+    static constexpr auto quadKernels = makeFusedKernelTable<4>(std::make_index_sequence<countFusedSequences(4)>());
+
+    size_t sequence = 0;
+
+    for (int slot = firstSlot + numSteps - 1; slot >= firstSlot; --slot)
+        sequence = sequence * numFusableTypes
+                 + static_cast<size_t>(chain.effects[static_cast<size_t>(slot)] - EffectType::bitCrusher);
+
+    switch (numSteps)
+    {
+        case 1: return singleKernels[sequence];
+        case 2: return pairKernels[sequence];
+        case 3: return tripleKernels[sequence];
+        case 4: return quadKernels[sequence];
+        default: return nullptr;
+    }
+}
+
+//==============================================================================
+template<typename SampleType>
+template<typename Function>
+void OutsetVerbEngine<SampleType>::visitPool(int effectType, Function&& function)
+{
+    switch (effectType)
+    {
+        case EffectType::bitCrusher:
+            function(bitCrusherPool);
+            break;
+        case EffectType::delay:
+            function(delayPool);
+            break;
+        case EffectType::eq:
+            function(eqPool);
+            break;
+        case EffectType::reverb:
+            function(reverbPool);
+            break;
+        default:
+            break;
+    }
+}
+
+template<typename SampleType>
+template<typename Function>
+void OutsetVerbEngine<SampleType>::forEachPlanInstance(const ExecutionPlan& plan, Function&& function)
+{
+    for (int slot = 0; slot < maxSlots; ++slot)
+    {
+        visitPool(plan.chain.effects[static_cast<size_t>(slot)], [&plan, &function, slot](auto& pool)
+        {
+            function(pool[plan.instances[static_cast<size_t>(slot)]]);
+        });
+    }
+}
+
+template<typename SampleType>
+void OutsetVerbEngine<SampleType>::prewarmPlan(const ExecutionPlan& plan, const Parameters& parameters)
+{
+    if (! prepared)
+        return;
+
+    forEachPlanInstance(plan, [this, &parameters](auto& pooledNode)
+    {
+        if (pooledNode.warm.load(std::memory_order_relaxed))
+            return;
+
+        // A cold instance is in no plan and is not live, so the audio thread leaves
+        // it alone. It starts on the given values, designed inline and snapped by
+        // configure(), and catches up on anything newer once a plan hands it over.
+        auto& node = pooledNode.node;
+
+        if constexpr (designsFilters<std::decay_t<decltype(node)>>)
+            node.setDesignInBackground(false);
+
+        applyParameters(node, parameters, ParameterFlags().set());
+        pooledNode.appliedParameters = parameters;
+
+        node.configure(nodeSpec);
+        pooledNode.state.build([&node](StateArena::Layout& layout) { node.layOutState(layout); });
+        node.reset();
+
+        pooledNode.warm.store(true, std::memory_order_release);
+    });
+}
+
+template<typename SampleType>
+template<typename NodeType, typename Function>
+void OutsetVerbEngine<SampleType>::forEachInstance(NodePool<NodeType>& pool, Function&& function)
+{
+    for (auto& pooledNode : pool)
+        function(pooledNode.node, pooledNode.activity);
+}
+
+template<typename SampleType>
+template<typename NodeType, typename Function>
+void OutsetVerbEngine<SampleType>::forEachLiveInstance(NodePool<NodeType>& pool, Function&& function)
+{
+    for (auto& pooledNode : pool)
+        if (pooledNode.live.load(std::memory_order_relaxed))
+            function(pooledNode);
+}
+
+template<typename SampleType>
+template<typename Function>
+void OutsetVerbEngine<SampleType>::forEachActivity(Function&& function)
+{
+    auto visit = [&function](auto&, NodeActivity& activity) { function(activity); };
+
+    forEachInstance(bitCrusherPool, visit);
+    forEachInstance(delayPool, visit);
+    forEachInstance(eqPool, visit);
+    forEachInstance(reverbPool, visit);
+}
+
+//==============================================================================
+template<typename SampleType>
+void OutsetVerbEngine<SampleType>::updateChainLatency()
+{
+    // Every instance is configured alike, so the plan's first EQ covers them all; a
+    // cold one may be in the middle of being prewarmed. The other branches of a
+    // parallel stage are delayed to match, so a stage with an EQ delays by it once.
+    int eqLatency = 0;
+
+    for (int index = 0; index < currentPlan.numSteps; ++index)
+    {
+        const auto& step = currentPlan.steps[static_cast<size_t>(index)];
+
+        if (step.node != nullptr && currentPlan.chain.effects[static_cast<size_t>(step.slot)] == EffectType::eq)
+        {
+            eqLatency = static_cast<PooledNode<typename EngineNodes::EQ>*>(step.node)->node.getLatencySamples();
+            break;
+        }
+    }
+
+    const auto& chain = currentPlan.chain;
+    int numStagesWithEQ = 0;
+
+    for (int stageStart = 0; stageStart < maxSlots;)
+    {
+        const int stageEnd = chain.getStageEnd(stageStart);
+
+        if (std::any_of(chain.effects.begin() + stageStart, chain.effects.begin() + stageEnd,
+                        [](int effectType) { return effectType == EffectType::eq; }))
+            ++numStagesWithEQ;
+
+        stageStart = stageEnd;
+    }
+
+    chainLatencySamples.store(eqLatency * numStagesWithEQ, std::memory_order_relaxed);
+}
+
+template<typename SampleType>
+void OutsetVerbEngine<SampleType>::updateTailLengths()
+{
+    // Each live instance estimates its own; cold ones are only estimated once handed over
+    auto setTail = [this](auto& pooledNode) { updateTailLength(pooledNode); };
+
+    forEachLiveInstance(bitCrusherPool, setTail);
+    forEachLiveInstance(delayPool, setTail);
+    forEachLiveInstance(eqPool, setTail);
+    forEachLiveInstance(reverbPool, setTail);
+
+    // While two orders run, the old one may still be ringing when the new one falls silent
+    auto chainTail = getStepsTailSeconds(currentPlan, 0, currentPlan.numSteps);
+
+    if (chainTransition != ChainTransition::idle)
+        chainTail = juce::jmax(chainTail, getStepsTailSeconds(pendingPlan, 0, pendingPlan.numSteps));
+
+    tailLengthSeconds.store(chainTail, std::memory_order_relaxed);
+
+    // Whatever differed between the channels before the input went dual-mono has to
+    // ring out of the mono steps before they can be run on one channel
+    const double monoStepsTail = getStepsTailSeconds(currentPlan, 0, currentPlan.numMonoSteps);
+
+    monoSettleSamples = std::isfinite(monoStepsTail)
+                          ? static_cast<juce::int64>(std::ceil(monoStepsTail * currentSampleRate))
+                          : std::numeric_limits<juce::int64>::max();
+
+    // The pipeline stages start from here when they next take up new values
+    for (int stage = 0; stage < numPipelineStages; ++stage)
+        stageTailSeconds[static_cast<size_t>(stage)].store(getStepsTailSeconds(currentPlan, pipelineStageStarts[static_cast<size_t>(stage)],
+                                                                               pipelineStageStarts[static_cast<size_t>(stage) + 1]),
+                                                           std::memory_order_relaxed);
+}
+
+template<typename SampleType>
+template<typename NodeType>
+void OutsetVerbEngine<SampleType>::updateTailLength(PooledNode<NodeType>& pooledNode)
+{
+    const double tailSeconds = pooledNode.node.getTailLengthSeconds(silenceThreshold);
+
+    // An infinite tail (frozen reverb) never lets the node sleep
+    pooledNode.activity.tailSeconds = tailSeconds;
+    pooledNode.activity.tailSamples = std::isfinite(tailSeconds)
+                                        ? static_cast<juce::int64>(std::ceil(tailSeconds * currentSampleRate))
+                                        : std::numeric_limits<juce::int64>::max();
+}
+
+template<typename SampleType>
+double OutsetVerbEngine<SampleType>::getStepsTailSeconds(const ExecutionPlan& plan, int firstStep, int endStep)
+{
+    double stepsTail = 0.0;
+    double stageTail = 0.0;
+
+    for (int index = firstStep; index < endStep; ++index)
+    {
+        const auto& step = plan.steps[static_cast<size_t>(index)];
+
+        if (! step.isBranch)
+        {
+            stepsTail += stageTail;
+            stageTail = 0.0;
+        }
+
+        if (step.activity == nullptr)
+            continue;
+
+        auto branchTail = step.activity->tailSeconds;
+
+        // A branch held back to match a linear-phase EQ rings on past its own tail
+        const auto& eqStep = plan.steps[static_cast<size_t>(juce::jmax(0, step.stageEQStep))];
+
+        if (step.stageEQStep >= 0 && plan.chain.effects[static_cast<size_t>(step.slot)] != EffectType::eq && eqStep.activity->blockBased)
+            branchTail += eqStep.activity->tailSeconds;
+
+        stageTail = juce::jmax(stageTail, branchTail);
+    }
+
+    return stepsTail + stageTail;
+}
+
+template<typename SampleType>
+void OutsetVerbEngine<SampleType>::updateFilterDesignThread()
+{
+    const bool designInBackground = ! nonRealtime.load(std::memory_order_relaxed);
+
+    if (designInBackground == filtersDesignedInBackground)
+        return;
+
+    // The stage workers may still be running tiles through the filters
+    if (! stageWorkers.empty())
+        drainPipeline();
+
+    filtersDesignedInBackground = designInBackground;
+
+    // Instances still cold are switched when they are handed over
+    forEachLiveInstance(delayPool, [designInBackground](auto& pooledNode) { pooledNode.node.setDesignInBackground(designInBackground); });
+    forEachLiveInstance(eqPool, [designInBackground](auto& pooledNode) { pooledNode.node.setDesignInBackground(designInBackground); });
+}
+
+template<typename SampleType>
+void OutsetVerbEngine<SampleType>::wakeAllNodes()
+{
+    forEachActivity([](NodeActivity& activity)
+    {
+        activity.silentSamples = 0;
+        activity.asleep = false;
+        activity.monoState = false;
+    });
+
+    dualMonoSamples = 0;
+}
+
+template<typename SampleType>
+bool OutsetVerbEngine<SampleType>::isSilent(const juce::dsp::AudioBlock<SampleType>& block)
+{
+    const auto range = block.findMinAndMax();
+    return range.getStart() > -silenceThreshold && range.getEnd() < silenceThreshold;
+}
+
+template<typename SampleType>
+bool OutsetVerbEngine<SampleType>::isDualMono(const juce::dsp::AudioBlock<SampleType>& block)
+{
+    // Bit-identical, not merely equal: -0 against 0 or differing NaNs would not
+    // come out of the effects the same way
+    const auto numBytes = block.getNumSamples() * sizeof(SampleType);
+    const auto* first = block.getChannelPointer(0);
+
+    for (size_t channel = 1; channel < block.getNumChannels(); ++channel)
+        if (std::memcmp(first, block.getChannelPointer(channel), numBytes) != 0)
+            return false;
+
+    return true;
+}
+
+template<typename SampleType>
+void OutsetVerbEngine<SampleType>::copyFirstChannel(juce::dsp::AudioBlock<SampleType>& block)
+{
+    const auto* first = block.getChannelPointer(0);
+
+    for (size_t channel = 1; channel < block.getNumChannels(); ++channel)
+        juce::FloatVectorOperations::copy(block.getChannelPointer(channel), first, static_cast<int>(block.getNumSamples()));
+}
+
+//==============================================================================
+template class OutsetVerbEngine<float>;
+template class OutsetVerbEngine<double>;
@@ -6,80 +6,806 @@
     Audio processing engine for Outset-Verb multi-effect processor.
     This class encapsulates all audio processing logic and can be used
     independently of JUCE's AudioProcessor framework.
-
+    
   ==============================================================================
 */
 
 #pragma once
 
-#include <juce_audio_processors/juce_audio_processors.h>
+#include <juce_audio_basics/juce_audio_basics.h>
 #include <juce_dsp/juce_dsp.h>
 #include <juce_core/juce_core.h>
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <bitset>
+#include <condition_variable>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <vector>
 #include "Effects/ReverbNode.h"
 #include "Effects/BitCrusherNode.h"
 #include "Effects/DelayNode.h"
-#include "Effects/ThreeBandEQNode.h"
+#include "Effects/ParametricEQNode.h"
+#include "Effects/StateArena.h"
+#include "OutsetVerbParameters.h"
+#include "SpscQueue.h"
+#include "TripleBuffer.h"
+#include "WorkerPool.h"
+
+//==============================================================================
+/**
+    The node classes an engine running at SampleType uses for each effect.
+    
+    A node's template argument is the precision it keeps its state in, which
+    need not match the engine's: blocks are converted sample by sample at the
+    node's boundary. The EQ always runs in double, as low shelves at high sample
+    rates are where float state first becomes audible.
+*/
+template<typename SampleType>
+struct OutsetVerbNodeTypes
+{
+    using BitCrusher = BitCrusherNode<SampleType>;
+    using Delay = DelayNode<SampleType>;
+    using EQ = ParametricEQNode<double>;
+    using Reverb = ReverbNode<SampleType>;
+};
 
 //==============================================================================
 /**
     Audio processing engine for Outset-Verb effects.
     
     This class manages the audio processing for all effects without being tied
-    to the AudioProcessor framework, making it reusable in other contexts.
+    to the AudioProcessor framework, making it reusable in other contexts. It
+    is driven by plain OutsetVerbParameters snapshots; the plugin feeds it
+    from its APVTS through OutsetVerbAPVTSAdapter.
+    
+    SampleType is the precision of the buffers it processes, float or double.
+    Each precision is a separate engine with its own effect state.
+    
+    Parameter values and the chain order reach the audio thread separately.
+    setParameters() hands over values and is safe on the audio thread itself;
+    updateChainOrder() compiles a new order into a plan, allocating the state of
+    any effect instance it adds, and belongs on the message thread. The audio
+    thread only ever picks up finished plans. While rendering offline it builds
+    each new order on a thread of its own instead, and waits for it, so the new
+    order starts on the tile its values arrive in.
+    
+    Effect instances only hold DSP state while a chain may run on them. A
+    prewarmed instance belongs to the thread that prewarmed it until a plan
+    hands it to the audio thread, which only then starts keeping it up to date.
+    Once the audio thread has moved on to plans that no longer bind it, the next
+    updateChainOrder() gives its state back.
 */
+template<typename SampleType>
 class OutsetVerbEngine
 {
 public:
     //==============================================================================
-    /** Constructor - accepts reference to external APVTS for parameter management. */
-    OutsetVerbEngine(juce::AudioProcessorValueTreeState& apvtsRef);
+    static constexpr int maxSlots = OutsetVerbParameters::maxSlots;
+    
+    /** When the per-channel effects may spread their channels across worker threads. */
+    enum class ChannelThreading
+    {
+        off,                // always process every channel on the calling thread
+        whenNonRealtime,    // only while setNonRealtime(true) is in effect
+        always              // whenever the channel and block size thresholds are met
+    };
+    
+    /** The filter structure the EQ bands run on. */
+    using EQTopology = typename OutsetVerbNodeTypes<SampleType>::EQ::Topology;
+    
+    //==============================================================================
+    /** Creates an engine starting from the given parameter values. */
+    explicit OutsetVerbEngine(const OutsetVerbParameters& initialParameters = OutsetVerbParameters::getDefaults());
     
-    /** Destructor. */
-    ~OutsetVerbEngine() = default;
+    /** Destructor. Stops the pipeline workers, if any are running. */
+    ~OutsetVerbEngine();
+    
+    //==============================================================================
+    /** Hands a new set of parameter values to the audio thread without locking
+        or allocating. The audio thread picks it up at the next tile boundary.
+        Call this from one thread at a time - the audio thread itself between
+        blocks is fine. The chain order in the values is left to
+        updateChainOrder(), except while rendering offline. */
+    void setParameters(const OutsetVerbParameters& newParameters);
+    
+    /** If the chain order in the given parameters differs from the last one
+        compiled, allocates the state of every effect instance it adds, compiles
+        it and hands the plan to the audio thread, which crossfades to it. Either
+        way, it first frees the state of every instance the audio thread has let
+        go of, so call it regularly even while the order stands still. Call this
+        from the message thread. It may allocate and briefly locks against
+        prepare(), but never blocks the audio thread. */
+    void updateChainOrder(const OutsetVerbParameters& parameters);
+    
+    /** Returns how many bytes of DSP state the effect instances hold between them.
+        Call this from the message thread. */
+    size_t getStateBytes();
     
     //==============================================================================
     /** Prepares the audio processing engine with the given specs. */
     void prepare(const juce::dsp::ProcessSpec& spec);
     
     /** Processes an audio buffer through the effect chain. */
-    void processBlock(juce::AudioBuffer<float>& buffer);
+    void processBlock(juce::AudioBuffer<SampleType>& buffer);
     
     /** Resets all effect processors. */
     void reset();
     
-    //==============================================================================
-    /** Creates the parameter layout for all Outset-Verb parameters.
-        This static method can be called to get the parameter layout for 
-        incorporating into an APVTS. */
-    static juce::AudioProcessorValueTreeState::ParameterLayout createParameterLayout();
+    /** Sets the ramp length used when smoothed parameters and slot levels change.
+        The reverb ramps its gains internally and is not affected. */
+    void setSmoothingTime(double seconds);
+    
+    /** Sets how long a chain re-order takes to crossfade from the old order to the new
+        one. Takes effect from the next re-order. */
+    void setChainCrossfadeTime(double seconds);
+    
+    /** Chooses when the per-channel effects may run on worker threads. Takes
+        effect from the next prepare(), which starts the workers if needed. */
+    void setChannelThreading(ChannelThreading newThreading);
+    
+    /** Tells the engine whether the host is rendering offline, which lets
+        ChannelThreading::whenNonRealtime use the workers. Safe to call from any thread. */
+    void setNonRealtime(bool isNonRealtime) noexcept { nonRealtime.store(isNonRealtime, std::memory_order_relaxed); }
+    
+    /** Runs each stage of the chain on its own worker thread, so one tile can move
+        through a later stage while the next is still in an earlier one. This adds
+        getLatencySamples() of delay. Parameter changes then apply once per host block
+        instead of once per tile, each stage taking them up as the first tile of the
+        block reaches it, so automation never holds the pipeline up. Meant for offline
+        rendering: the audio thread waits on the workers. Takes effect from the next
+        prepare(), unless channel threading could be used for the prepared layout,
+        which takes precedence. */
+    void setPipelined(bool shouldBePipelined);
+    
+    /** Chooses the filter structure of every EQ instance. State-variable bands
+        glide their settings and redesign inline, which keeps heavy EQ automation
+        cheap and smooth. Linear-phase EQs add their own delay to getLatencySamples(),
+        and convolve in float even in a double engine, as juce::dsp::FFT has no
+        double transform. Takes effect from the next prepare(). */
+    void setEQTopology(EQTopology newTopology);
+    
+    /** Returns the filter structure last passed to setEQTopology(). */
+    EQTopology getEQTopology() const noexcept { return eqTopology; }
+    
+    /** Returns the delay the engine adds: one prepared block rounded up to whole
+        tiles if prepare() started the pipeline, or zero, plus the delay of each
+        stage of the current chain that holds a linear-phase EQ. The latter follows
+        the chain order, so poll it. Safe to call from any thread. */
+    int getLatencySamples() const noexcept { return latencySamples + chainLatencySamples.load(std::memory_order_relaxed); }
+    
+    /** Returns how long the current chain keeps producing output after the input
+        stops, or infinity while the reverb is frozen. Safe to call from any thread. */
+    double getTailLengthSeconds() const noexcept { return tailLengthSeconds.load(std::memory_order_relaxed); }
     
 private:
     //==============================================================================
-    // Effect type enumeration
-    enum EffectType
+    using Parameters = OutsetVerbParameters;
+    using EffectType = OutsetVerbParameters::EffectType;
+    using EngineNodes = OutsetVerbNodeTypes<SampleType>;
+    
+    /** Peak level (about -100 dBFS) below which a block counts as silent. */
+    static constexpr float silenceThreshold = 1.0e-5f;
+    
+    /** How long an effect takes to fade in or out when it is bypassed or becomes an identity. */
+    static constexpr double engageRampSeconds = 0.01;
+    
+    /** Host buffers are cut into tiles of this many samples, and the whole chain
+        runs over one tile before moving on to the next, so the audio stays in
+        cache from the first effect to the last. Parameters, chain hand-overs and
+        slot levels all update at tile boundaries, whatever block size the host uses. */
+    static constexpr int tileSize = 128;
+    
+    /** Channel threading needs at least this many channels to be worth the hand-offs... */
+    static constexpr int minThreadedChannels = 4;
+    
+    /** ...and host blocks at least this long, as short blocks mean the host is playing live. */
+    static constexpr int minThreadedBlockSize = 512;
+    
+    // Sleep and bypass state for one effect. A node falls asleep once its input
+    // has been silent for longer than its tail and its own output is silent too;
+    // while asleep and fed silence it is skipped entirely. A disengaged node
+    // (bypassed, or with settings that make it an identity) is fed silence, so it
+    // rings out on top of the passed-through input and then falls asleep.
+    struct NodeActivity
     {
-        none = 0,
-        bitCrusher = 1,
-        delay = 2,
-        eq = 3,
-        reverb = 4
+        double tailSeconds = 0.0;
+        juce::int64 tailSamples = 0;
+        juce::int64 silentSamples = 0;
+        bool asleep = false;
+        bool monoState = false;     // ran on the first channel only; the others' state is stale
+        bool blockBased = false;    // buffers whole blocks of its own, so never runs in a fused kernel
+        juce::SmoothedValue<float> engage { 1.0f };
     };
     
-    // Individual effect processors
-    BitCrusherNode bitCrusherProcessor;
-    DelayNode delayProcessor;
-    ThreeBandEQNode eqProcessor;
-    ReverbNode reverbProcessor;
+    // A pooled effect instance together with its sleep and bypass state. Its DSP
+    // state lives in an arena of its own, allocated the first time a chain needs
+    // it; warm is set once that state is laid out and cleared, and only warm
+    // instances are ever bound into a plan.
+    //
+    // Until then the instance belongs to whichever thread prewarms it, and the audio
+    // thread leaves its node alone. live is set (audio thread only) once the audio
+    // thread has picked up a plan binding it, and from then on only the audio thread
+    // touches the node. It is cleared again once neither the plan running nor the one
+    // being faded to binds it, which hands the instance back. appliedParameters holds
+    // the values its node was last given, by whichever thread owned it at the time.
+    //
+    // lastBindingSerial is the serial of the newest plan compiled with the instance
+    // in it. Once the audio thread has picked up a plan at least that new and the
+    // instance is not live, no plan can hand it to the audio thread again, and its
+    // state can go.
+    template<typename NodeType>
+    struct PooledNode
+    {
+        NodeType node;
+        NodeActivity activity;
+        StateArena state;
+        std::atomic<bool> warm { false };
+        std::atomic<bool> live { false };
+        std::uint64_t lastBindingSerial = 0;     // guarded by prewarmLock
+        OutsetVerbParameters appliedParameters;
+    };
+    
+    // Every instance is configured up front, so warming one never reallocates what
+    // configure() sets up. Each occurrence of an effect in a chain runs on an
+    // instance of its own, so duplicates share the effect's parameters but each
+    // keeps its own state. A new order gets instances the old one is not using
+    // wherever the pool has them, so the two can run side by side while they crossfade.
+    template<typename NodeType>
+    using NodePool = std::array<PooledNode<NodeType>, maxSlots>;
+    
+    NodePool<typename EngineNodes::BitCrusher> bitCrusherPool;
+    NodePool<typename EngineNodes::Delay> delayPool;
+    NodePool<typename EngineNodes::EQ> eqPool;
+    NodePool<typename EngineNodes::Reverb> reverbPool;
+    
+    // Set once prepare() has configured the instances, after which cold ones can
+    // be laid out, along with the spec they were configured for. Guarded by
+    // prewarmLock, which keeps updateChainOrder() and prepare() apart.
+    bool prepared = false;
+    juce::dsp::ProcessSpec nodeSpec {};
+    std::mutex prewarmLock;
+    
+    // Chain configuration - which effect is in each slot, and whether each slot runs
+    // in parallel with the one before it. Consecutive parallel slots form one stage:
+    // every branch is fed the stage input and the branch outputs are summed, each at
+    // its slot level. An empty slot inside a parallel stage acts as a dry branch.
+    struct ChainConfiguration
+    {
+        std::array<int, maxSlots> effects {};
+        std::array<bool, maxSlots> parallelWithPrevious {};
+        
+        bool operator==(const ChainConfiguration& other) const noexcept
+        {
+            return effects == other.effects && parallelWithPrevious == other.parallelWithPrevious;
+        }
+        
+        bool operator!=(const ChainConfiguration& other) const noexcept { return ! operator==(other); }
+        
+        /** Returns the slot after the last one in the stage starting at stageStart. */
+        int getStageEnd(int stageStart) const noexcept
+        {
+            int stageEnd = stageStart + 1;
+            
+            while (stageEnd < maxSlots && parallelWithPrevious[static_cast<size_t>(stageEnd)])
+                ++stageEnd;
+            
+            return stageEnd;
+        }
+    };
+    
+    // Scratch for one thread walking the chain, one tile long. The stage input and
+    // branch hold the two sides of a parallel stage, and the delayed buffer sums the
+    // branches held back to match a linear-phase EQ beside them; the bypass buffer
+    // holds the dry input while an effect fades in or out, or the silence a bypassed
+    // one rings out from.
+    struct TileScratch
+    {
+        juce::AudioBuffer<SampleType> stageInput;
+        juce::AudioBuffer<SampleType> branch;
+        juce::AudioBuffer<SampleType> delayed;
+        juce::AudioBuffer<SampleType> bypass;
+        
+        void setSize(int numChannels)
+        {
+            stageInput.setSize(numChannels, tileSize);
+            branch.setSize(numChannels, tileSize);
+            delayed.setSize(numChannels, tileSize);
+            bypass.setSize(numChannels, tileSize);
+        }
+    };
+    
+    // One slot of a compiled chain. The node is type-erased behind the run and
+    // reset thunks, which are instantiated per node type, so walking the plan
+    // needs no switch over effect types and no lookups.
+    struct PlanStep
+    {
+        using RunFunction = void (*)(OutsetVerbEngine&, const PlanStep&, juce::dsp::AudioBlock<SampleType>&, bool&, TileScratch&);
+        using ResetFunction = void (*)(void*);
+        using FusedFunction = void (*)(const PlanStep*, const float*, juce::dsp::AudioBlock<SampleType>&, WorkerPool*);
+        using CopyStateFunction = void (*)(void*, size_t);
+        using AdoptFunction = bool (*)(OutsetVerbEngine&, void*);
+        using SyncFunction = void (*)(OutsetVerbEngine&, void*, const OutsetVerbParameters&);
+        
+        RunFunction run = nullptr;
+        ResetFunction reset = nullptr;          // null for an empty slot
+        AdoptFunction adopt = nullptr;          // null for an empty slot
+        SyncFunction sync = nullptr;            // null for an empty slot
+        CopyStateFunction copyFirstChannelState = nullptr;   // null for an empty slot or the reverb
+        void* node = nullptr;                   // the PooledNode the thunks operate on
+        NodeActivity* activity = nullptr;       // null for an empty slot
+        int slot = 0;
+        
+        bool opensParallelStage = false;        // copy the block into the stage input first
+        bool isBranch = false;                  // run on a copy of the stage input and sum into the block
+        bool closesParallelStage = false;       // re-measure the summed block
+        int stageEQStep = -1;                   // the first EQ of the parallel stage, if it has one
+        
+        // Set on the first step of a run of adjacent serial effects that can be
+        // processed by one kernel specialized for that sequence of node types. A
+        // lone effect gets a kernel too, but only uses it to spread its channels.
+        FusedFunction fused = nullptr;
+        int numFusedSteps = 0;
+    };
+    
+    // A chain compiled on the control thread into the steps the audio thread walks
+    struct ExecutionPlan
+    {
+        ChainConfiguration chain;
+        std::array<size_t, maxSlots> instances {};     // the pool instance each slot's effect runs on
+        std::array<PlanStep, maxSlots> steps {};
+        int numSteps = 0;
+        std::uint64_t serial = 0;    // counts up with every plan compiled
+        
+        // The steps ahead of the first stage holding a channel-coupling effect (the
+        // reverb). Only per-channel effects run there, so dual-mono input can go
+        // through them on one channel and be copied to the rest afterwards.
+        int numMonoSteps = 0;
+    };
+    
+    ExecutionPlan currentPlan;
+    
+    // Chain re-ordering state. New plans are compiled on the control thread and
+    // picked up by the audio thread, which runs the old and the new plan side by
+    // side and crossfades from one to the other at equal power. Only if the two
+    // share an instance, because a pool ran out, does it fade the old plan out to
+    // the dry signal, switch, and fade the new plan back in. A transition runs to
+    // its end before the next plan is picked up.
+    enum class ChainTransition { idle, crossfading, fadingOut, fadingIn };
+    
+    TripleBuffer<ExecutionPlan> publishedPlans;
+    ChainConfiguration lastPublishedChain;   // guarded by prewarmLock
+    std::uint64_t numPlansCompiled = 0;       // guarded by prewarmLock
+    
+    // The serial of the newest plan the audio thread has picked up, stored once it
+    // has taken over the plan's instances
+    std::atomic<std::uint64_t> acknowledgedPlanSerial { 0 };
+    ExecutionPlan pendingPlan;
+    ChainTransition chainTransition = ChainTransition::idle;
+    juce::SmoothedValue<float> chainMix { 1.0f };
+    double chainCrossfadeSeconds = 0.05;
+    
+    // Output level of each slot, applied to its branch before summing. The incoming
+    // plan of a crossfade ramps a copy of its own, as both plans run every tile.
+    using SlotLevels = std::array<juce::SmoothedValue<float>, maxSlots>;
+    
+    SlotLevels slotLevels;
+    SlotLevels incomingSlotLevels;
+    double smoothingTimeSeconds = 0.02;
+    
+    // Scratch for the chain when it runs on the audio thread
+    TileScratch scratch;
+    
+    std::atomic<double> tailLengthSeconds { 0.0 };
+    
+    // Workers for the per-channel effects, started by prepare() when channel
+    // threading could be used. threadedBlock says whether the current block uses them.
+    ChannelThreading channelThreading = ChannelThreading::whenNonRealtime;
+    std::atomic<bool> nonRealtime { false };
+    std::unique_ptr<WorkerPool> workerPool;
+    bool threadedBlock = false;
+    
+    // The EQ structure asked for, and the one the instances were last configured
+    // with. A linear-phase EQ adds its kernel's delay once per stage it sits in.
+    EQTopology eqTopology = EQTopology::biquad;
+    EQTopology preparedEQTopology = EQTopology::biquad;
+    std::atomic<int> chainLatencySamples { 0 };
+    
+    // Live, the delay and EQ filters are designed on the shared BiquadDesigner
+    // thread; offline they are designed inline so renders repeat exactly
+    bool filtersDesignedInBackground = true;
+    
+    // Pipelined mode. Tiles are gathered from the host blocks, handed from stage to
+    // stage through the queues (stage s reads stageQueues[s] and writes the next one)
+    // and come back to the audio thread through the output queue. Each
+    // stage worker walks the plan steps between two pipelineStageStarts with its own
+    // scratch. The plan only changes while no tile is in flight.
+    //
+    // Every tile carries the values it was submitted with. A stage owns the nodes
+    // and slot levels of its steps while tiles are in flight, and brings them up to
+    // date whenever a tile arrives with values newer than the last it applied, so
+    // each tile goes through every stage on the values it started with.
+    struct PipelineTile
+    {
+        juce::AudioBuffer<SampleType> buffer;
+        bool inputSilent = false;
+        Parameters parameters;
+        std::uint64_t parametersSerial = 0;
+    };
+    
+    bool pipelined = false;
+    int latencySamples = 0;
+    int preparedBlockSize = 0;
+    
+    std::vector<PipelineTile> pipelineTiles;
+    std::array<SpscQueue<int>, maxSlots> stageQueues;
+    SpscQueue<int> pipelineOutput;
+    std::array<TileScratch, maxSlots> stageScratch;
+    std::array<int, maxSlots + 1> pipelineStageStarts {};
+    int numPipelineStages = 0;
+    
+    // Counts the snapshots the audio thread has fetched; each stage remembers the
+    // newest one it applied and the tail its steps then had
+    std::uint64_t pipelineParametersSerial = 0;
+    std::array<std::uint64_t, maxSlots> stageParametersSerials {};
+    std::array<std::atomic<double>, maxSlots> stageTailSeconds {};
+    
+    std::vector<std::thread> stageWorkers;
+    std::mutex stageWakeMutex;
+    std::array<std::condition_variable, maxSlots> stageWakeConditions;   // one per stage
+    bool stageWorkersShouldExit = false;
+    bool stageWorkersSpin = false;      // only with a core for every stage and the audio thread
+    
+    // The last stage signals here, so the audio thread sleeps rather than spins
+    // while it waits for a finished tile
+    std::mutex pipelineOutputMutex;
+    std::condition_variable pipelineOutputCondition;
+    
+    // Offline chain builds. The audio thread leaves the values it needs an order
+    // for in chainBuildRequest and waits until the builder has published the plan.
+    // Started by the first prepare(); all but the thread guarded by chainBuildMutex.
+    std::thread chainBuilder;
+    std::mutex chainBuildMutex;
+    std::condition_variable chainBuildCondition;
+    Parameters chainBuildRequest;
+    bool chainBuildRequested = false;
+    bool chainBuilderShouldExit = false;
+    
+    // Audio thread only: tiles not in use, finished tiles taken off the last queue
+    // early, the tile being filled from the input and the one being read out
+    std::vector<int> freeTiles;
+    SpscQueue<int> finishedTiles;
+    int inputTile = -1;
+    int inputTileSamples = 0;
+    int outputTile = -1;
+    int outputTileSamples = 0;
+    int tilesInPipeline = 0;
+    int preRollSamples = 0;
+    
+    // How long the input has had every channel bit-identical to the first, and how
+    // long it has to stay that way before the mono steps run on one channel. Until
+    // then the channels' states may still differ from an earlier stereo passage.
+    juce::int64 dualMonoSamples = 0;
+    juce::int64 monoSettleSamples = 0;
+    
+    // Copy of the input, only filled while a chain transition is running. The
+    // incoming plan of a crossfade processes it in place; a fade through the dry
+    // signal mixes it in as it is.
+    juce::AudioBuffer<SampleType> transitionBuffer;
     
-    // Chain configuration - stores which effect is in each position
-    std::array<int, 4> chainConfiguration = {0, 0, 0, 0};
+    double currentSampleRate = 44100.0;
     
-    // Reference to external APVTS (not owned by this class)
-    juce::AudioProcessorValueTreeState& apvts;
+    // Parameter snapshots from the control thread. The newest one fetched stays
+    // readable, so prepare() can always start from it.
+    TripleBuffer<Parameters> publishedParameters;
+    
+    // The newest values the audio thread has picked up, used to skip unchanged parameters
+    Parameters lastParameterValues;
+    
+    //==============================================================================
+    /** One flag per parameter, in ParameterIndex order. */
+    using ParameterFlags = std::bitset<Parameters::numParameters>;
+    
+    /** Pushes parameters that changed since the last call to the live instances.
+        When forceUpdate is true every parameter is pushed regardless. */
+    void updateChainParameters(const Parameters& parameters, bool forceUpdate = false);
+    
+    /** Pushes the values the instance was not given yet, or all of them when
+        forceUpdate is true. Called by whichever thread runs the instance. */
+    template<typename NodeType>
+    void syncInstance(PooledNode<NodeType>& pooledNode, const Parameters& values, bool forceUpdate);
+    
+    /** Pushes the flagged values to one node, one overload per effect. */
+    static void applyParameters(typename EngineNodes::BitCrusher& node, const Parameters& values, const ParameterFlags& changed);
+    static void applyParameters(typename EngineNodes::Delay& node, const Parameters& values, const ParameterFlags& changed);
+    static void applyParameters(typename EngineNodes::EQ& node, const Parameters& values, const ParameterFlags& changed);
+    static void applyParameters(typename EngineNodes::Reverb& node, const Parameters& values, const ParameterFlags& changed);
+    
+    /** True for the nodes that can design their filters on the BiquadDesigner thread. */
+    template<typename NodeType>
+    static constexpr bool designsFilters = std::is_same_v<NodeType, typename EngineNodes::Delay>
+                                           || std::is_same_v<NodeType, typename EngineNodes::EQ>;
+    
+    /** Reads the chainSlot parameters into a chain configuration. */
+    static ChainConfiguration readChainConfiguration(const Parameters& parameters);
+    
+    /** Compiles a chain into a plan, binding each slot to a pooled instance, and
+        gives it the next serial. Call with prewarmLock held. */
+    void compilePlan(const ChainConfiguration& chain, ExecutionPlan& plan);
+    
+    /** Picks a pool instance for each effect in the plan's chain, preferring ones the
+        audio thread is not running and will not be handed by a plan it has yet to
+        pick up. Call with prewarmLock held. */
+    void chooseInstances(ExecutionPlan& plan);
+    
+    /** Processes one tile (at most tileSize samples) through the chain. */
+    void processTile(juce::dsp::AudioBlock<SampleType>& block);
+    
+    /** Walks the steps of the given plan over the block, scaling each slot by the
+        given levels. With runMono, the steps ahead of the reverb run on one channel. */
+    void processChain(const ExecutionPlan& plan, juce::dsp::AudioBlock<SampleType>& block, bool runMono, SlotLevels& levels);
+    
+    /** Walks the plan steps from firstStep up to endStep over every channel of the block.
+        numChannels is the prepared channel count, which the block has fewer of while
+        running mono. endStep must not fall inside a parallel stage. */
+    void processSteps(const ExecutionPlan& plan, int firstStep, int endStep, juce::dsp::AudioBlock<SampleType>& block,
+                      size_t numChannels, bool& inputSilent, TileScratch& tileScratch, SlotLevels& levels);
+    
+    /** Before numSteps steps run, marks their nodes as holding first-channel state
+        only if they are about to run on one channel, or otherwise copies the first
+        channel's state to the others wherever it was left that way. */
+    void updateChannelStates(const PlanStep* steps, int numSteps, bool runningMono, size_t numChannels);
+    
+    /** Runs one pooled effect, handling bypass ramps and sleep. inputSilent says whether
+        the block is silent on entry and is updated to match the block on return. */
+    template<typename NodeType>
+    void processSlot(NodeType& node, NodeActivity& activity, juce::dsp::AudioBlock<SampleType>& block, bool& inputSilent,
+                     TileScratch& tileScratch);
+    
+    /** Runs an effect that is fading in or out, blending it with its dry input. */
+    template<typename NodeType>
+    void processEngageRamp(NodeType& node, NodeActivity& activity, juce::dsp::AudioBlock<SampleType>& block, TileScratch& tileScratch);
+    
+    /** Feeds a bypassed effect silence and adds whatever it still outputs to the block.
+        Returns true if the effect produced nothing audible. */
+    template<typename NodeType>
+    bool processRingOut(NodeType& node, juce::dsp::AudioBlock<SampleType>& block, TileScratch& tileScratch);
+    
+    /** Scales the block by a slot's level, ramping if it is moving. Free at unity. */
+    static void applySlotLevel(juce::SmoothedValue<float>& level, juce::dsp::AudioBlock<SampleType>& block);
+    
+    /** Points each effect's engage ramps at 0 if it is bypassed or currently an identity. */
+    void updateEngageTargets();
+    
+    /** Points one instance's engage ramp according to the given values. */
+    template<typename NodeType>
+    void updateEngageTarget(PooledNode<NodeType>& pooledNode, const Parameters& values);
+    
+    /** Takes over every instance the plan binds that the audio thread does not own
+        yet, bringing it up to date with the newest parameters. */
+    void adoptInstances(const ExecutionPlan& plan);
+    
+    /** Starts a transition from the current plan to a newly published one. */
+    void beginChainTransition(const ExecutionPlan& newPlan);
+    
+    /** Picks up any published plan. Offline, if the newest values ask for an order
+        no plan covers yet, also has it built and waits for it. */
+    void fetchChainOrder();
+    
+    void startChainBuilder();
+    void stopChainBuilder();
+    void chainBuilderLoop();
+    
+    /** Blends the outgoing plan's output in the block with the incoming plan's at
+        equal power and advances the crossfade. */
+    void applyChainCrossfade(juce::dsp::AudioBlock<SampleType>& block, const juce::dsp::AudioBlock<SampleType>& incoming);
+    
+    /** Blends the processed block with the dry copy and advances a fade through the
+        dry signal, switching plans halfway. */
+    void applyDryPassage(juce::dsp::AudioBlock<SampleType>& block, const juce::dsp::AudioBlock<SampleType>& dry);
+    
+    /** Resets the pending plan's instances that the current plan is not running. */
+    void resetJoiningInstances();
+    
+    /** Makes the pending plan active. */
+    void switchToPendingPlan();
+    
+    /** Hands back every live instance neither the current nor the pending plan binds.
+        Audio thread only. */
+    void retireUnboundInstances();
+    
+    /** Frees the state of every instance the audio thread has handed back for good.
+        Call with prewarmLock held. */
+    void releaseRetiredInstances();
+    
+    //==============================================================================
+    /** Processes a host block in pipelined mode: the input goes into the pipeline
+        and the output comes from tiles submitted latencySamples earlier. */
+    void processPipelined(juce::dsp::AudioBlock<SampleType>& block);
+    
+    /** Sends a full input tile down the pipeline, or through the chain on the audio
+        thread while a chain transition is running. */
+    void submitTile(int tileIndex);
+    
+    /** Returns the oldest finished tile, waiting for the pipeline if need be. */
+    int takeFinishedTile();
+    
+    /** Waits until every tile in flight has left the last stage. */
+    void drainPipeline();
+    
+    /** Empties the tile FIFO back to latencySamples of silence. */
+    void resetPipelineTiles();
+    
+    /** Splits the current plan into pipeline stages, starting a new one at every
+        chain stage that holds an effect, and restarts the stage workers if their
+        number no longer matches. */
+    void updatePipelineStages();
+    
+    /** Brings a stage's nodes, slot levels and tail up to date with the values a
+        tile carries. Called on the stage's worker. */
+    void applyStageParameters(int stage, const Parameters& values);
+    
+    /** Waits until the last stage has handed back a tile. */
+    void waitForPipelineOutput();
+    
+    /** Starts one worker for each of the numPipelineStages stages. */
+    void startStageWorkers();
+    void stopStageWorkers();
+    void wakeStageWorker(int stage);
+    void stageWorkerLoop(int stage);
+    
+    //==============================================================================
+    /** Plan thunks, instantiated once per node type. */
+    template<typename NodeType>
+    static void runNode(OutsetVerbEngine& engine, const PlanStep& step, juce::dsp::AudioBlock<SampleType>& block, bool& inputSilent,
+                        TileScratch& tileScratch);
+    
+    template<typename NodeType>
+    static void resetNode(void* pooledNode);
+    
+    template<typename NodeType>
+    static void copyFirstChannelState(void* pooledNode, size_t numChannels);
+    
+    /** Marks the instance live and syncs it, returning false if it already was. */
+    template<typename NodeType>
+    static bool adoptNode(OutsetVerbEngine& engine, void* pooledNode);
+    
+    /** Brings the instance's parameters, engage ramp and tail up to date with the values. */
+    template<typename NodeType>
+    static void syncNode(OutsetVerbEngine& engine, void* pooledNode, const Parameters& values);
+    
+    /** An empty slot - the block passes through untouched. */
+    static void runEmptySlot(OutsetVerbEngine& engine, const PlanStep& step, juce::dsp::AudioBlock<SampleType>& block, bool& inputSilent,
+                             TileScratch& tileScratch);
+    
+    /** Binds a plan step to a pooled instance. */
+    template<typename NodeType>
+    static void bindStep(PlanStep& step, PooledNode<NodeType>& pooledNode);
+    
+    //==============================================================================
+    /** The effect a node type runs. */
+    template<typename NodeType>
+    static constexpr EffectType getEffectType()
+    {
+        if constexpr (std::is_same_v<NodeType, typename EngineNodes::BitCrusher>)
+            return EffectType::bitCrusher;
+        else if constexpr (std::is_same_v<NodeType, typename EngineNodes::Delay>)
+            return EffectType::delay;
+        else if constexpr (std::is_same_v<NodeType, typename EngineNodes::EQ>)
+            return EffectType::eq;
+        else
+            return EffectType::reverb;
+    }
+    
+    /** The per-channel effects, in EffectType order from bitCrusher. Adjacent
+        serial slots holding these can be fused into a single per-sample loop;
+        the reverb couples its channels and always runs on its own. */
+    using FusableNodeTypes = std::tuple<typename EngineNodes::BitCrusher, typename EngineNodes::Delay, typename EngineNodes::EQ>;
+    static constexpr size_t numFusableTypes = std::tuple_size<FusableNodeTypes>::value;
+    
+    /** The longest run of slots fused into one kernel. Every sequence of fusable
+        types up to this length gets its own kernel, so the table grows as
+        numFusableTypes to this power. */
+    static constexpr int maxFusedSteps = 4;
+    
+    /** Points the first step of every run of adjacent serial fusable slots at its kernel. */
+    static void fuseSerialRuns(ExecutionPlan& plan);
+    
+    /** Looks up the kernel for the numSteps slots starting at firstSlot. */
+    static typename PlanStep::FusedFunction getFusedKernel(const ChainConfiguration& chain, int firstSlot, int numSteps);
+    
+    /** True if every slot of a fused run is fully engaged at a steady level. Anything
+        fading in or out goes through the per-step path, which handles the ramps. */
+    static bool canRunFused(const PlanStep& firstStep, const SlotLevels& levels);
+    
+    /** Runs a fused kernel and keeps the sleep state of its slots up to date. With
+        a worker pool, the kernel's channels are shared out across its threads. */
+    void processFusedRun(const PlanStep& firstStep, juce::dsp::AudioBlock<SampleType>& block, bool& inputSilent, WorkerPool* pool,
+                         const SlotLevels& levels);
+    
+    /** A kernel for one sequence of node types. Each sample goes through every node
+        of the run, scaled by each slot's level, before the next sample is read.
+        Between nodes it is held in the widest precision any node of the run uses. */
+    template<typename... NodeTypes>
+    static void runFused(const PlanStep* steps, const float* levels, juce::dsp::AudioBlock<SampleType>& block, WorkerPool* pool);
+    
+    template<typename... NodeTypes, size_t... Indices>
+    static void runFusedSteps(std::index_sequence<Indices...>, const PlanStep* steps, const float* levels,
+                              juce::dsp::AudioBlock<SampleType>& block, WorkerPool* pool);
+    
+    /** Kernel table construction. A sequence is encoded as a base numFusableTypes
+        number with the first slot in the lowest digit. */
+    static constexpr size_t countFusedSequences(int numSteps);
+    
+    template<size_t Sequence, size_t... Positions>
+    static constexpr typename PlanStep::FusedFunction makeFusedKernel(std::index_sequence<Positions...>);
+    
+    template<int NumSteps, size_t... Sequences>
+    static constexpr std::array<typename PlanStep::FusedFunction, sizeof...(Sequences)> makeFusedKernelTable(std::index_sequence<Sequences...>);
+    
+    /** Calls function(pool) with the pool of the given effect type, if it has one. */
+    template<typename Function>
+    void visitPool(int effectType, Function&& function);
+    
+    /** Calls function(pooledNode) for every pooled instance the plan runs on. */
+    template<typename Function>
+    void forEachPlanInstance(const ExecutionPlan& plan, Function&& function);
+    
+    /** Sets up, lays out and clears every instance the plan runs on that has no
+        state yet, starting it on the given values. Call with prewarmLock held. */
+    void prewarmPlan(const ExecutionPlan& plan, const Parameters& parameters);
+    
+    /** Calls function(node, activity) for every instance in a pool. */
+    template<typename NodeType, typename Function>
+    static void forEachInstance(NodePool<NodeType>& pool, Function&& function);
+    
+    /** Calls function(pooledNode) for every live instance in a pool. Audio thread only. */
+    template<typename NodeType, typename Function>
+    static void forEachLiveInstance(NodePool<NodeType>& pool, Function&& function);
+    
+    /** Calls function(activity) for every pooled instance of every effect. */
+    template<typename Function>
+    void forEachActivity(Function&& function);
     
     //==============================================================================
-    /** Updates all effect parameters from APVTS values. */
-    void updateChainParameters();
+    /** Re-estimates every live effect's tail and the total tail of the active plan. */
+    void updateTailLengths();
+    
+    /** Re-estimates one instance's tail from its node. */
+    template<typename NodeType>
+    void updateTailLength(PooledNode<NodeType>& pooledNode);
+    
+    /** Adds up the tails of the plan steps from firstStep up to endStep: stages run
+        in series, so their tails add up, and within a stage the longest branch wins.
+        Neither end may fall inside a parallel stage. */
+    static double getStepsTailSeconds(const ExecutionPlan& plan, int firstStep, int endStep);
+    
+    /** Works out the delay the linear-phase EQs on the current plan add. */
+    void updateChainLatency();
+    
+    /** Moves the delay and EQ filter design onto or off the background thread to
+        match the realtime state. No node may be running while this is called. */
+    void updateFilterDesignThread();
+    
+    /** Wakes every effect and clears its silence count. Called whenever the nodes
+        have just been reset, so it also forgets any dual-mono run. */
+    void wakeAllNodes();
+    
+    /** True if every sample in the block is below silenceThreshold. */
+    static bool isSilent(const juce::dsp::AudioBlock<SampleType>& block);
+    
+    /** True if every channel of the block is bit-identical to the first. */
+    static bool isDualMono(const juce::dsp::AudioBlock<SampleType>& block);
+    
+    /** Copies the first channel of the block over all the others. */
+    static void copyFirstChannel(juce::dsp::AudioBlock<SampleType>& block);
     
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(OutsetVerbEngine)
 };
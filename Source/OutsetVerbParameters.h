@@ -0,0 +1,209 @@
+/*
+  ==============================================================================
+
+    OutsetVerbParameters.h
+    
+    Plain parameter snapshot for the Outset-Verb engine. Has no dependencies
+    beyond the standard library, so hosts without an AudioProcessor can fill
+    one in and hand it to the engine.
+    
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <array>
+#include <cmath>
+
+//==============================================================================
+/**
+    Every Outset-Verb parameter as a plain value, indexed by ParameterIndex.
+    
+    Values are in the same units the plugin's parameters use: continuous
+    parameters hold their real value (dB, Hz, ms, 0-1 mixes), switches hold
+    0 or 1, each chain slot holds an EffectType and each EQ band an EQBandType
+    and an EQSlope.
+*/
+struct OutsetVerbParameters
+{
+    //==============================================================================
+    /** The longest chain the engine can run. Each slot may hold any effect,
+        including one already used in another slot. */
+    static constexpr int maxSlots = 8;
+    
+    /** The most bands the EQ can have. */
+    static constexpr int maxEQBands = 8;
+    
+    /** What a chain slot holds. */
+    enum EffectType
+    {
+        none = 0,
+        bitCrusher = 1,
+        delay = 2,
+        eq = 3,
+        reverb = 4,
+        numEffectTypes
+    };
+    
+    /** What an EQ band does, in the order of ParametricEQNode::BandType. */
+    enum EQBandType
+    {
+        bandOff = 0,
+        bandPeak,
+        bandLowShelf,
+        bandHighShelf,
+        bandHighPass,
+        bandLowPass
+    };
+    
+    /** How steeply a high- or low-pass EQ band cuts. */
+    enum EQSlope
+    {
+        slope12dB = 0,
+        slope24dB,
+        slope48dB
+    };
+    
+    enum ParameterIndex
+    {
+        bitDepthParam = 0,
+        sampleRateReductionParam,
+        bitCrusherMixParam,
+        delayTimeParam,
+        delayFeedbackParam,
+        delayMixParam,
+        delayLowPassCutoffParam,
+        eqNumBandsParam,
+        roomSizeParam,
+        dampingParam,
+        widthParam,
+        freezeModeParam,
+        reverbMixParam,
+        bitCrusherBypassParam,
+        delayBypassParam,
+        eqBypassParam,
+        reverbBypassParam,
+        
+        // One run of maxSlots (or maxSlots - 1 for the parallel switches) per chain parameter
+        chainSlot1Param,
+        chainSlot2ParallelParam = chainSlot1Param + maxSlots,
+        chainSlot1LevelParam = chainSlot2ParallelParam + maxSlots - 1,
+        
+        // One run of maxEQBands per EQ band parameter
+        eqBand1TypeParam = chainSlot1LevelParam + maxSlots,
+        eqBand1FreqParam = eqBand1TypeParam + maxEQBands,
+        eqBand1GainParam = eqBand1FreqParam + maxEQBands,
+        eqBand1QParam = eqBand1GainParam + maxEQBands,
+        eqBand1SlopeParam = eqBand1QParam + maxEQBands,
+        numParameters = eqBand1SlopeParam + maxEQBands
+    };
+    
+    //==============================================================================
+    std::array<float, numParameters> values {};
+    
+    float& operator[](int index) noexcept { return values[static_cast<size_t>(index)]; }
+    float operator[](int index) const noexcept { return values[static_cast<size_t>(index)]; }
+    
+    bool operator==(const OutsetVerbParameters& other) const noexcept { return values == other.values; }
+    bool operator!=(const OutsetVerbParameters& other) const noexcept { return values != other.values; }
+    
+    //==============================================================================
+    /** The values a fresh plugin instance starts with: every effect dry, an
+        empty serial chain and every slot at full level. The EQ starts as the
+        classic three-band layout - a low shelf, a peak and a high shelf, all
+        flat - with the remaining bands set up as peaks spread over the range. */
+    static OutsetVerbParameters getDefaults() noexcept
+    {
+        OutsetVerbParameters parameters;
+        
+        parameters[bitDepthParam] = 16.0f;
+        parameters[sampleRateReductionParam] = 1.0f;
+        parameters[delayTimeParam] = 250.0f;
+        parameters[delayFeedbackParam] = 0.3f;
+        parameters[delayLowPassCutoffParam] = 8000.0f;
+        parameters[eqNumBandsParam] = 3.0f;
+        parameters[roomSizeParam] = 0.5f;
+        parameters[dampingParam] = 0.5f;
+        parameters[widthParam] = 0.5f;
+        
+        for (int slot = 0; slot < maxSlots; ++slot)
+            parameters[chainSlot1LevelParam + slot] = 1.0f;
+        
+        static constexpr std::array<EQBandType, maxEQBands> bandTypes { bandLowShelf, bandPeak, bandHighShelf, bandPeak,
+                                                                        bandPeak, bandPeak, bandPeak, bandPeak };
+        static constexpr std::array<float, maxEQBands> bandFrequencies { 200.0f, 1000.0f, 8000.0f, 60.0f,
+                                                                         400.0f, 2500.0f, 5000.0f, 12000.0f };
+        
+        for (int band = 0; band < maxEQBands; ++band)
+        {
+            const auto type = bandTypes[static_cast<size_t>(band)];
+            
+            parameters[eqBand1TypeParam + band] = static_cast<float>(type);
+            parameters[eqBand1FreqParam + band] = bandFrequencies[static_cast<size_t>(band)];
+            parameters[eqBand1QParam + band] = type == bandPeak ? 1.0f : 0.707f;
+        }
+        
+        return parameters;
+    }
+    
+    //==============================================================================
+    /** False if the effect is bypassed or its settings make it an identity (a
+        fully dry mix, or a flat EQ). The engines fade such an effect out and
+        let whatever it still holds ring out. */
+    bool isEngaged(EffectType effect) const noexcept
+    {
+        // Mix and gain parameters snap to steps of 0.01 and 0.1, so compare against half a step
+        auto isOn = [this](int index) { return (*this)[index] > 0.5f; };
+        auto isZero = [this](int index, float step) { return std::abs((*this)[index]) < step * 0.5f; };
+        
+        switch (effect)
+        {
+            case bitCrusher:
+                return ! (isOn(bitCrusherBypassParam) || isZero(bitCrusherMixParam, 0.01f));
+            case delay:
+                return ! (isOn(delayBypassParam) || isZero(delayMixParam, 0.01f));
+            case eq:
+                return ! isOn(eqBypassParam) && isAnyEQBandActive();
+            case reverb:
+                return ! (isOn(reverbBypassParam) || isZero(reverbMixParam, 0.01f));
+            case none:
+            case numEffectTypes:
+            default:
+                return false;
+        }
+    }
+    
+    /** How many EQ bands are in use. */
+    int getNumEQBands() const noexcept
+    {
+        const int numBands = static_cast<int>(std::lround((*this)[eqNumBandsParam]));
+        return numBands < 0 ? 0 : (numBands > maxEQBands ? maxEQBands : numBands);
+    }
+    
+    /** True if any EQ band in use changes the signal: a cut, or a peak or shelf
+        with some gain. */
+    bool isAnyEQBandActive() const noexcept
+    {
+        for (int band = 0; band < getNumEQBands(); ++band)
+        {
+            switch (static_cast<int>((*this)[eqBand1TypeParam + band]))
+            {
+                case bandHighPass:
+                case bandLowPass:
+                    return true;
+                case bandPeak:
+                case bandLowShelf:
+                case bandHighShelf:
+                    // Gains snap to steps of 0.1 dB, so compare against half a step
+                    if (std::abs((*this)[eqBand1GainParam + band]) >= 0.05f)
+                        return true;
+                    break;
+                case bandOff:
+                default:
+                    break;
+            }
+        }
+        
+        return false;
+    }
+};
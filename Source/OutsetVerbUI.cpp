@@ -9,6 +9,8 @@
 */
 
 #include "OutsetVerbUI.h"
+#include "OutsetVerbParameters.h"
+#include "OutsetVerbAPVTSAdapter.h"
 
 //==============================================================================
 OutsetVerbUI::OutsetVerbUI(juce::AudioProcessorValueTreeState& apvtsRef)
@@ -27,26 +29,32 @@ OutsetVerbUI::OutsetVerbUI(juce::AudioProcessorValueTreeState& apvtsRef)
     // Setup all effect containers
     setupEffectContainers();
     
-    // Update dropdown options based on initial chain configuration
-    updateChainDropdownOptions();
-    
     // Update effect container states based on initial chain configuration
     updateEffectContainerStates();
     
+    // Show the initial routing on the flow arrows
+    updateFlowArrows();
+    
     // Add parameter listeners for chain configuration changes
-    apvts.addParameterListener("chainSlot1", this);
-    apvts.addParameterListener("chainSlot2", this);
-    apvts.addParameterListener("chainSlot3", this);
-    apvts.addParameterListener("chainSlot4", this);
+    for (int slot = 1; slot <= numChainSlots; ++slot)
+    {
+        apvts.addParameterListener("chainSlot" + juce::String(slot), this);
+        
+        if (slot > 1)
+            apvts.addParameterListener("chainSlot" + juce::String(slot) + "Parallel", this);
+    }
 }
 
 OutsetVerbUI::~OutsetVerbUI()
 {
     // Remove parameter listeners
-    apvts.removeParameterListener("chainSlot1", this);
-    apvts.removeParameterListener("chainSlot2", this);
-    apvts.removeParameterListener("chainSlot3", this);
-    apvts.removeParameterListener("chainSlot4", this);
+    for (int slot = 1; slot <= numChainSlots; ++slot)
+    {
+        apvts.removeParameterListener("chainSlot" + juce::String(slot), this);
+        
+        if (slot > 1)
+            apvts.removeParameterListener("chainSlot" + juce::String(slot) + "Parallel", this);
+    }
 }
 
 //==============================================================================
@@ -79,79 +87,94 @@ void OutsetVerbUI::resized()
     int outputLabelWidth = 90;
     int arrowWidth = 25;
     int dropdownSpacing = 8;
-    int totalFixedWidth = inputLabelWidth + outputLabelWidth + (3 * arrowWidth) + (7 * dropdownSpacing);
+    int totalFixedWidth = inputLabelWidth + outputLabelWidth + ((slotsPerRow - 1) * arrowWidth) + ((2 * slotsPerRow - 1) * dropdownSpacing);
     int availableDropdownWidth = chainBounds.getWidth() - totalFixedWidth;
-    int dropdownWidth = availableDropdownWidth / 4;
-    
-    // Layout with proper spacing
-    audioInputLabel.setBounds(chainBounds.removeFromLeft(inputLabelWidth));
-    chainBounds.removeFromLeft(dropdownSpacing);
+    int dropdownWidth = availableDropdownWidth / slotsPerRow;
+    int rowHeight = chainBounds.getHeight() / numChainRows;
     
-    for (int i = 0; i < 4; ++i)
+    // Layout with proper spacing, one row of slots at a time
+    for (int row = 0; row < numChainRows; ++row)
     {
-        if (i > 0)
+        auto rowBounds = chainBounds.removeFromTop(rowHeight);
+        
+        // Routing controls sit in a row under the dropdowns and arrows they belong to
+        auto routingBounds = rowBounds.removeFromBottom(routingRowHeight);
+        
+        auto leadInBounds = rowBounds.removeFromLeft(inputLabelWidth);
+        auto leadInRoutingBounds = routingBounds.removeFromLeft(inputLabelWidth);
+        rowBounds.removeFromLeft(dropdownSpacing);
+        routingBounds.removeFromLeft(dropdownSpacing);
+        
+        const int firstSlot = row * slotsPerRow;
+        
+        if (row == 0)
+        {
+            audioInputLabel.setBounds(leadInBounds);
+        }
+        else
+        {
+            // The arrow into a wrapped row takes the place of the input label
+            flowArrows[firstSlot - 1].setBounds(leadInBounds.removeFromRight(arrowWidth));
+            parallelToggles[firstSlot - 1]->setBounds(leadInRoutingBounds.removeFromRight(arrowWidth));
+        }
+        
+        for (int column = 0; column < slotsPerRow; ++column)
         {
-            flowArrows[i-1].setBounds(chainBounds.removeFromLeft(arrowWidth));
-            chainBounds.removeFromLeft(dropdownSpacing);
+            const int i = firstSlot + column;
+            
+            if (column > 0)
+            {
+                flowArrows[i-1].setBounds(rowBounds.removeFromLeft(arrowWidth));
+                parallelToggles[i-1]->setBounds(routingBounds.removeFromLeft(arrowWidth));
+                rowBounds.removeFromLeft(dropdownSpacing);
+                routingBounds.removeFromLeft(dropdownSpacing);
+            }
+            
+            chainDropdowns[i]->setBounds(rowBounds.removeFromLeft(dropdownWidth));
+            levelSliders[i]->setBounds(routingBounds.removeFromLeft(dropdownWidth));
+            
+            if (column < slotsPerRow - 1)
+            {
+                rowBounds.removeFromLeft(dropdownSpacing);
+                routingBounds.removeFromLeft(dropdownSpacing);
+            }
         }
         
-        chainDropdowns[i]->setBounds(chainBounds.removeFromLeft(dropdownWidth));
-        if (i < 3) chainBounds.removeFromLeft(dropdownSpacing);
+        if (row == numChainRows - 1)
+        {
+            rowBounds.removeFromLeft(dropdownSpacing);
+            audioOutputLabel.setBounds(rowBounds.removeFromLeft(outputLabelWidth));
+        }
     }
     
-    chainBounds.removeFromLeft(dropdownSpacing);
-    audioOutputLabel.setBounds(chainBounds.removeFromLeft(outputLabelWidth));
-    
     // Add padding below chain ordering
     bounds.reduce(containerPadding, containerPadding);
     
-    // Get current chain configuration
-    std::array<int, 4> chainConfig = {0, 0, 0, 0};
-    chainConfig[0] = static_cast<int>(apvts.getRawParameterValue("chainSlot1")->load());
-    chainConfig[1] = static_cast<int>(apvts.getRawParameterValue("chainSlot2")->load());
-    chainConfig[2] = static_cast<int>(apvts.getRawParameterValue("chainSlot3")->load());
-    chainConfig[3] = static_cast<int>(apvts.getRawParameterValue("chainSlot4")->load());
-    
-    // Calculate container width for 4 slots
-    int totalContainerPadding = containerPadding * 5;
-    int containerWidth = (bounds.getWidth() - totalContainerPadding) / 4;
+    // Each effect's controls appear once, in the order the effects first appear in the chain
+    std::array<EffectContainer*, 4> containerOrder {};
+    size_t numContainers = 0;
     
-    // Position containers based on chain configuration
-    for (int slotIndex = 0; slotIndex < 4; ++slotIndex)
+    for (int effectType : getChainConfiguration())
     {
-        int effectType = chainConfig[slotIndex];
+        auto* container = getContainerForEffect(effectType);
         
-        // Get the container bounds for this slot
-        auto slotBounds = bounds.removeFromLeft(containerWidth);
-        
-        // Position the appropriate container in this slot
-        EffectContainer* containerToPosition = nullptr;
-        
-        switch (effectType)
+        if (container != nullptr
+            && std::find(containerOrder.begin(), containerOrder.begin() + numContainers, container) == containerOrder.begin() + numContainers)
         {
-            case 1: // Bit Crusher
-                containerToPosition = bitCrusherContainer.get();
-                break;
-            case 2: // Delay
-                containerToPosition = delayContainer.get();
-                break;
-            case 3: // EQ
-                containerToPosition = eqContainer.get();
-                break;
-            case 4: // Reverb
-                containerToPosition = reverbContainer.get();
-                break;
-            default: // None (0) or invalid
-                break;
-        }
-        
-        // Position the container if one was selected for this slot
-        if (containerToPosition != nullptr)
-        {
-            containerToPosition->setBounds(slotBounds);
+            containerOrder[numContainers++] = container;
         }
+    }
+    
+    // Calculate container width for 4 columns
+    int totalContainerPadding = containerPadding * 5;
+    int containerWidth = (bounds.getWidth() - totalContainerPadding) / 4;
+    
+    // Position containers in columns from the left
+    for (size_t column = 0; column < numContainers; ++column)
+    {
+        containerOrder[column]->setBounds(bounds.removeFromLeft(containerWidth));
         
-        // Add spacing between slots
+        // Add spacing between columns
         bounds.removeFromLeft(containerPadding);
     }
 }
@@ -169,6 +192,7 @@ void OutsetVerbUI::setupEffectContainers()
     bitCrusherContainer->addSlider("bitDepth", "Bit Depth", apvts);
     bitCrusherContainer->addSlider("sampleRateReduction", "Rate Reduction", apvts);
     bitCrusherContainer->addSlider("bitCrusherMix", "Mix", apvts);
+    bitCrusherContainer->addToggleButton("bitCrusherBypass", "Bypass", apvts);
     addAndMakeVisible(*bitCrusherContainer);
     
     // Create Delay container
@@ -177,17 +201,26 @@ void OutsetVerbUI::setupEffectContainers()
     delayContainer->addSlider("delayFeedback", "Feedback", apvts);
     delayContainer->addSlider("delayMix", "Mix", apvts);
     delayContainer->addSlider("delayLowPassCutoff", "LP Cutoff", apvts);
+    delayContainer->addToggleButton("delayBypass", "Bypass", apvts);
     addAndMakeVisible(*delayContainer);
     
-    // Create EQ container with 2-column layout for better space utilization
-    eqContainer = std::make_unique<EffectContainer>("Three Band EQ", EffectContainer::LayoutMode::TwoColumn);
-    eqContainer->addSlider("lowGain", "Low Gain", apvts);
-    eqContainer->addSlider("lowFreq", "Low Freq", apvts);
-    eqContainer->addSlider("midGain", "Mid Gain", apvts);
-    eqContainer->addSlider("midFreq", "Mid Freq", apvts);
-    eqContainer->addSlider("midQ", "Mid Q", apvts);
-    eqContainer->addSlider("highGain", "High Gain", apvts);
-    eqContainer->addSlider("highFreq", "High Freq", apvts);
+    // Create EQ container with 2-column layout for better space utilization.
+    // One set of band controls edits whichever band is picked in the Band selector.
+    juce::StringArray bandNames;
+    
+    for (int band = 1; band <= OutsetVerbParameters::maxEQBands; ++band)
+        bandNames.add(juce::String(band));
+    
+    eqContainer = std::make_unique<EffectContainer>("Parametric EQ", EffectContainer::LayoutMode::TwoColumn);
+    eqContainer->addSlider("eqBands", "Bands", apvts);
+    eqContainer->addSelector("Band", bandNames, [this](int band) { selectEQBand(band); });
+    eqContainer->addComboBox("eqBand1Type", "Type", apvts);
+    eqContainer->addComboBox("eqBand1Slope", "Slope", apvts);
+    eqContainer->addSlider(OutsetVerbAPVTSAdapter::getParameterID(OutsetVerbParameters::eqBand1FreqParam), "Freq", apvts);
+    eqContainer->addSlider(OutsetVerbAPVTSAdapter::getParameterID(OutsetVerbParameters::eqBand1GainParam), "Gain", apvts);
+    eqContainer->addSlider(OutsetVerbAPVTSAdapter::getParameterID(OutsetVerbParameters::eqBand1QParam), "Q", apvts);
+    eqContainer->addComboBox("eqTopology", "Topology", apvts);
+    eqContainer->addToggleButton("eqBypass", "Bypass", apvts);
     addAndMakeVisible(*eqContainer);
     
     // Create Reverb container
@@ -197,9 +230,22 @@ void OutsetVerbUI::setupEffectContainers()
     reverbContainer->addSlider("reverbMix", "Mix", apvts);
     reverbContainer->addSlider("width", "Width", apvts);
     reverbContainer->addToggleButton("freezeMode", "Freeze", apvts);
+    reverbContainer->addToggleButton("reverbBypass", "Bypass", apvts);
     addAndMakeVisible(*reverbContainer);
 }
 
+void OutsetVerbUI::selectEQBand(int band)
+{
+    // The first band of each setting's run of parameters, so the band is an offset into it
+    for (const int firstBandParam : { OutsetVerbParameters::eqBand1TypeParam, OutsetVerbParameters::eqBand1SlopeParam,
+                                      OutsetVerbParameters::eqBand1FreqParam, OutsetVerbParameters::eqBand1GainParam,
+                                      OutsetVerbParameters::eqBand1QParam })
+        eqContainer->retargetControl(OutsetVerbAPVTSAdapter::getParameterID(firstBandParam + selectedEQBand),
+                                     OutsetVerbAPVTSAdapter::getParameterID(firstBandParam + band), apvts);
+    
+    selectedEQBand = band;
+}
+
 void OutsetVerbUI::setupChainOrderingUI()
 {
     // Setup audio input label
@@ -210,7 +256,7 @@ void OutsetVerbUI::setupChainOrderingUI()
     addAndMakeVisible(audioInputLabel);
     
     // Setup flow arrows
-    for (int i = 0; i < 3; ++i)
+    for (int i = 0; i < numChainSlots - 1; ++i)
     {
         flowArrows[i].setText("->", juce::dontSendNotification);
         flowArrows[i].setFont(juce::Font(16.0f, juce::Font::bold));
@@ -229,7 +275,7 @@ void OutsetVerbUI::setupChainOrderingUI()
     // Setup chain dropdowns and their attachments
     const juce::StringArray effectOptions = {"None", "Bit Crusher", "Delay", "EQ", "Reverb"};
     
-    for (int i = 0; i < 4; ++i)
+    for (int i = 0; i < numChainSlots; ++i)
     {
         // Create dropdown
         chainDropdowns[i] = std::make_unique<juce::ComboBox>();
@@ -241,17 +287,44 @@ void OutsetVerbUI::setupChainOrderingUI()
         juce::String paramID = "chainSlot" + juce::String(i + 1);
         chainAttachments[i] = std::make_unique<juce::AudioProcessorValueTreeState::ComboBoxAttachment>(
             apvts, paramID, *chainDropdowns[i]);
+        
+        // Create level slider for this slot's branch
+        levelSliders[i] = std::make_unique<juce::Slider>(juce::Slider::LinearHorizontal, juce::Slider::NoTextBox);
+        levelSliders[i]->setTooltip("Slot " + juce::String(i + 1) + " level");
+        addAndMakeVisible(*levelSliders[i]);
+        
+        levelAttachments[i] = std::make_unique<juce::AudioProcessorValueTreeState::SliderAttachment>(
+            apvts, paramID + "Level", *levelSliders[i]);
+    }
+    
+    // Setup parallel toggles - slot i + 2 can share its input with the slot before it
+    for (int i = 0; i < numChainSlots - 1; ++i)
+    {
+        parallelToggles[i] = std::make_unique<juce::ToggleButton>();
+        parallelToggles[i]->setTooltip("Run slot " + juce::String(i + 2) + " in parallel with slot " + juce::String(i + 1));
+        parallelToggles[i]->setColour(juce::ToggleButton::tickColourId, juce::Colours::lightblue);
+        addAndMakeVisible(*parallelToggles[i]);
+        
+        parallelAttachments[i] = std::make_unique<juce::AudioProcessorValueTreeState::ButtonAttachment>(
+            apvts, "chainSlot" + juce::String(i + 2) + "Parallel", *parallelToggles[i]);
+    }
+}
+
+void OutsetVerbUI::updateFlowArrows()
+{
+    for (int i = 0; i < numChainSlots - 1; ++i)
+    {
+        juce::String paramID = "chainSlot" + juce::String(i + 2) + "Parallel";
+        const bool parallel = apvts.getRawParameterValue(paramID)->load() > 0.5f;
+        
+        flowArrows[i].setText(parallel ? "||" : "->", juce::dontSendNotification);
     }
 }
 
 void OutsetVerbUI::updateEffectContainerStates()
 {
     // Get current chain configuration
-    std::array<int, 4> chainConfig;
-    chainConfig[0] = static_cast<int>(apvts.getRawParameterValue("chainSlot1")->load());
-    chainConfig[1] = static_cast<int>(apvts.getRawParameterValue("chainSlot2")->load());
-    chainConfig[2] = static_cast<int>(apvts.getRawParameterValue("chainSlot3")->load());
-    chainConfig[3] = static_cast<int>(apvts.getRawParameterValue("chainSlot4")->load());
+    const auto chainConfig = getChainConfiguration();
     
     // Check which effects are currently in the chain
     bool bitCrusherInChain = false;
@@ -300,44 +373,28 @@ void OutsetVerbUI::updateEffectContainerStates()
     resized();
 }
 
-void OutsetVerbUI::updateChainDropdownOptions()
+std::array<int, OutsetVerbUI::numChainSlots> OutsetVerbUI::getChainConfiguration() const
 {
-    // Get current chain configuration
-    std::array<int, 4> chainConfig;
-    for (int i = 0; i < 4; ++i)
+    std::array<int, numChainSlots> chainConfig {};
+    
+    for (int i = 0; i < numChainSlots; ++i)
     {
         juce::String paramID = "chainSlot" + juce::String(i + 1);
         chainConfig[i] = static_cast<int>(apvts.getRawParameterValue(paramID)->load());
     }
     
-    // Update each dropdown
-    for (int dropdownIndex = 0; dropdownIndex < 4; ++dropdownIndex)
+    return chainConfig;
+}
+
+EffectContainer* OutsetVerbUI::getContainerForEffect(int effectType) const
+{
+    switch (effectType)
     {
-        if (!chainDropdowns[dropdownIndex])
-            continue;
-        
-        // Effect IDs: 1=None, 2=BitCrusher, 3=Delay, 4=EQ, 5=Reverb
-        // Check which effects are used in OTHER slots
-        for (int effectID = 2; effectID <= 5; ++effectID)  // Skip "None" (ID 1)
-        {
-            bool isUsedInOtherSlot = false;
-            
-            // Check all OTHER slots for this effect
-            for (int otherSlot = 0; otherSlot < 4; ++otherSlot)
-            {
-                if (otherSlot != dropdownIndex && chainConfig[otherSlot] + 1 == effectID)
-                {
-                    isUsedInOtherSlot = true;
-                    break;
-                }
-            }
-            
-            // Enable/disable the item in the current dropdown
-            chainDropdowns[dropdownIndex]->setItemEnabled(effectID, !isUsedInOtherSlot);
-        }
-        
-        // "None" (ID 1) should always be enabled
-        chainDropdowns[dropdownIndex]->setItemEnabled(1, true);
+        case 1: return bitCrusherContainer.get();  // Bit Crusher
+        case 2: return delayContainer.get();       // Delay
+        case 3: return eqContainer.get();          // EQ
+        case 4: return reverbContainer.get();      // Reverb
+        default: return nullptr;                   // None (0) or invalid
     }
 }
 
@@ -346,7 +403,7 @@ void OutsetVerbUI::parameterChanged(const juce::String& parameterID, float newVa
     // Update effect container states when chain configuration changes
     if (parameterID.startsWith("chainSlot"))
     {
-        updateChainDropdownOptions();  // Update dropdown options first
         updateEffectContainerStates();
+        updateFlowArrows();
     }
 }
@@ -55,35 +55,59 @@ private:
     std::unique_ptr<EffectContainer> eqContainer;
     std::unique_ptr<EffectContainer> reverbContainer;
 
+    // The EQ band whose parameters the EQ container's band controls are attached to
+    int selectedEQBand = 0;
+
+    // Chain slots, shown in rows of slotsPerRow
+    static constexpr int numChainSlots = 8;
+    static constexpr int slotsPerRow = 4;
+    static constexpr int numChainRows = numChainSlots / slotsPerRow;
+    
     // Chain ordering UI components
-    std::array<std::unique_ptr<juce::ComboBox>, 4> chainDropdowns;
-    std::array<std::unique_ptr<juce::AudioProcessorValueTreeState::ComboBoxAttachment>, 4> chainAttachments;
+    std::array<std::unique_ptr<juce::ComboBox>, numChainSlots> chainDropdowns;
+    std::array<std::unique_ptr<juce::AudioProcessorValueTreeState::ComboBoxAttachment>, numChainSlots> chainAttachments;
     juce::Label audioInputLabel;
     juce::Label audioOutputLabel;
-    std::array<juce::Label, 3> flowArrows;
+    std::array<juce::Label, numChainSlots - 1> flowArrows;
+    
+    // Routing controls - a parallel toggle under each arrow and a level under each slot
+    std::array<std::unique_ptr<juce::ToggleButton>, numChainSlots - 1> parallelToggles;
+    std::array<std::unique_ptr<juce::AudioProcessorValueTreeState::ButtonAttachment>, numChainSlots - 1> parallelAttachments;
+    std::array<std::unique_ptr<juce::Slider>, numChainSlots> levelSliders;
+    std::array<std::unique_ptr<juce::AudioProcessorValueTreeState::SliderAttachment>, numChainSlots> levelAttachments;
 
     // Main title label
     juce::Label titleLabel;
     
     // Layout constants
     static constexpr int windowWidth = 950;
-    static constexpr int windowHeight = 700;
+    static constexpr int windowHeight = 810;
     static constexpr int titleHeight = 40;
-    static constexpr int chainOrderingHeight = 60;
+    static constexpr int chainOrderingHeight = 170;
+    static constexpr int routingRowHeight = 28;
     static constexpr int containerPadding = 12;
     
     //==============================================================================
     /** Initializes all effect containers with their parameters. */
     void setupEffectContainers();
 
+    /** Re-attaches the EQ container's band controls to another band's parameters. */
+    void selectEQBand(int band);
+
     /** Initializes the chain ordering UI components. */
     void setupChainOrderingUI();
 
     /** Updates EffectContainer enabled states based on current chain configuration. */
     void updateEffectContainerStates();
 
-    /** Updates the available options in chain dropdowns based on current selections. */
-    void updateChainDropdownOptions();
+    /** Shows each flow arrow as serial or parallel to match the routing parameters. */
+    void updateFlowArrows();
+    
+    /** Reads the effect selected in each chain slot. */
+    std::array<int, numChainSlots> getChainConfiguration() const;
+    
+    /** Returns the container holding an effect type's controls, or nullptr for None. */
+    EffectContainer* getContainerForEffect(int effectType) const;
 
     // AudioProcessorValueTreeState::Listener override
     void parameterChanged(const juce::String& parameterID, float newValue) override;
@@ -22,7 +22,7 @@ OutsetVerbAudioProcessor::OutsetVerbAudioProcessor()
     {
         // Now initialize APVTS after base class is fully constructed
         apvts = std::make_unique<juce::AudioProcessorValueTreeState>(
-            *this, nullptr, "Parameters", OutsetVerbEngine::createParameterLayout());
+            *this, nullptr, "Parameters", OutsetVerbAPVTSAdapter::createParameterLayout());
         
         if (apvts)
             DBG("APVTS created successfully - pointer is valid");
@@ -36,15 +36,21 @@ OutsetVerbAudioProcessor::OutsetVerbAudioProcessor()
     }
     
     DBG("About to create engine...");
-    // Create the audio processing engine
-    engine = std::make_unique<OutsetVerbEngine>(*apvts);
-    DBG("Engine created successfully");
+    // Create the audio processing engines, starting from the APVTS values
+    parameterAdapter = std::make_unique<OutsetVerbAPVTSAdapter>(*apvts);
+    floatEngine = std::make_unique<OutsetVerbEngine<float>>(parameterAdapter->readParameters());
+    doubleEngine = std::make_unique<OutsetVerbEngine<double>>(parameterAdapter->readParameters());
+    DBG("Engines created successfully");
+    
+    // Chain order changes wait for their effects' state, which is allocated here
+    startTimerHz(30);
     
     DBG("=== PluginProcessor Constructor END ===");
 }
 
 OutsetVerbAudioProcessor::~OutsetVerbAudioProcessor()
 {
+    stopTimer();
 }
 
 //==============================================================================
@@ -82,7 +88,11 @@ bool OutsetVerbAudioProcessor::isMidiEffect() const
 
 double OutsetVerbAudioProcessor::getTailLengthSeconds() const
 {
-    return 3.0;
+    // Follows the active chain and its settings (infinite while the reverb is frozen)
+    if (isUsingDoublePrecision())
+        return doubleEngine ? doubleEngine->getTailLengthSeconds() : 0.0;
+
+    return floatEngine ? floatEngine->getTailLengthSeconds() : 0.0;
 }
 
 int OutsetVerbAudioProcessor::getNumPrograms()
@@ -119,8 +129,32 @@ void OutsetVerbAudioProcessor::prepareToPlay (double sampleRate, int samplesPerB
     spec.maximumBlockSize = static_cast<juce::uint32>(samplesPerBlock);
     spec.numChannels = static_cast<juce::uint32>(getTotalNumOutputChannels());
 
-    if (engine)
-        engine->prepare(spec);
+    // The host picks the precision before preparing. The adapter only pushes what
+    // changed, so force a full push in case the other engine was active last time,
+    // and bring its chain order up to date before its state is laid out.
+    // Offline renders pipeline the chain across cores, which delays the output, and
+    // a linear-phase EQ adds its own delay.
+    if (isUsingDoublePrecision() && doubleEngine)
+    {
+        parameterAdapter->pushParameters(*doubleEngine, true);
+        doubleEngine->updateChainOrder(parameterAdapter->readParameters());
+        doubleEngine->setPipelined(isNonRealtime());
+        doubleEngine->setEQTopology(parameterAdapter->getEQTopology<double>());
+        doubleEngine->prepare(spec);
+        setLatencySamples(doubleEngine->getLatencySamples());
+    }
+    else if (! isUsingDoublePrecision() && floatEngine)
+    {
+        parameterAdapter->pushParameters(*floatEngine, true);
+        floatEngine->updateChainOrder(parameterAdapter->readParameters());
+        floatEngine->setPipelined(isNonRealtime());
+        floatEngine->setEQTopology(parameterAdapter->getEQTopology<float>());
+        floatEngine->prepare(spec);
+        setLatencySamples(floatEngine->getLatencySamples());
+    }
+
+    preparedSpec = spec;
+    enginePrepared = true;
 
     DBG("Engine prepared - Sample Rate: " + juce::String(sampleRate) +
         ", Buffer Size: " + juce::String(samplesPerBlock) +
@@ -130,9 +164,13 @@ void OutsetVerbAudioProcessor::prepareToPlay (double sampleRate, int samplesPerB
 
 void OutsetVerbAudioProcessor::releaseResources()
 {
+    enginePrepared = false;
+
     // Reset the audio processing engine
-    if (engine)
-        engine->reset();
+    if (isUsingDoublePrecision() && doubleEngine)
+        doubleEngine->reset();
+    else if (! isUsingDoublePrecision() && floatEngine)
+        floatEngine->reset();
 }
 
 #ifndef JucePlugin_PreferredChannelConfigurations
@@ -142,12 +180,9 @@ bool OutsetVerbAudioProcessor::isBusesLayoutSupported (const BusesLayout& layout
     juce::ignoreUnused (layouts);
     return true;
   #else
-    // This is the place where you check if the layout is supported.
-    // In this template code we only support mono or stereo.
-    // Some plugin hosts, such as certain GarageBand versions, will only
-    // load plugins that support stereo bus layouts.
-    if (layouts.getMainOutputChannelSet() != juce::AudioChannelSet::mono()
-     && layouts.getMainOutputChannelSet() != juce::AudioChannelSet::stereo())
+    // Every effect sizes its per-channel state in prepareToPlay, so any layout
+    // works - mono, stereo, surround or ambisonics - as long as there is one
+    if (layouts.getMainOutputChannelSet().isDisabled())
         return false;
 
     // This checks if the input layout matches the output layout
@@ -161,7 +196,30 @@ bool OutsetVerbAudioProcessor::isBusesLayoutSupported (const BusesLayout& layout
 }
 #endif
 
+bool OutsetVerbAudioProcessor::supportsDoublePrecisionProcessing() const
+{
+    return true;
+}
+
 void OutsetVerbAudioProcessor::processBlock (juce::AudioBuffer<float>& buffer, juce::MidiBuffer& midiMessages)
+{
+    juce::ignoreUnused (midiMessages);
+
+    if (floatEngine)
+        processWithEngine (buffer, *floatEngine);
+}
+
+void OutsetVerbAudioProcessor::processBlock (juce::AudioBuffer<double>& buffer, juce::MidiBuffer& midiMessages)
+{
+    juce::ignoreUnused (midiMessages);
+
+    // Double hosts run the double engine directly, with no conversion to float and back
+    if (doubleEngine)
+        processWithEngine (buffer, *doubleEngine);
+}
+
+template<typename SampleType>
+void OutsetVerbAudioProcessor::processWithEngine (juce::AudioBuffer<SampleType>& buffer, OutsetVerbEngine<SampleType>& engine)
 {
     juce::ScopedNoDenormals noDenormals;
     auto totalNumInputChannels  = getTotalNumInputChannels();
@@ -176,9 +234,49 @@ void OutsetVerbAudioProcessor::processBlock (juce::AudioBuffer<float>& buffer, j
     if (totalNumInputChannels == 0)
         return;
 
-    // Process through the audio engine
-    if (engine)
-        engine->processBlock(buffer);
+    // Offline renders may spread the per-channel effects across worker threads
+    engine.setNonRealtime(isNonRealtime());
+
+    // Process through the audio engine with the latest parameter values
+    parameterAdapter->pushParameters(engine);
+    engine.processBlock(buffer);
+}
+
+void OutsetVerbAudioProcessor::timerCallback()
+{
+    if (! enginePrepared)
+        return;
+
+    if (isUsingDoublePrecision() && doubleEngine)
+        updateEngine(*doubleEngine);
+    else if (! isUsingDoublePrecision() && floatEngine)
+        updateEngine(*floatEngine);
+}
+
+template<typename SampleType>
+void OutsetVerbAudioProcessor::updateEngine (OutsetVerbEngine<SampleType>& engine)
+{
+    // A new chain order is compiled here, with any state it needs allocated, while
+    // the audio thread keeps running the old one. Offline renders have the engine
+    // build it at the block it arrives in instead.
+    if (! isNonRealtime())
+        engine.updateChainOrder(parameterAdapter->readParameters());
+
+    const auto topology = parameterAdapter->getEQTopology<SampleType>();
+
+    // The EQ state is laid out for its structure, so switching means preparing
+    // again - with the audio thread held off, as prepare() may not overlap a block
+    if (topology != engine.getEQTopology())
+    {
+        suspendProcessing(true);
+        engine.setEQTopology(topology);
+        engine.prepare(preparedSpec);
+        suspendProcessing(false);
+    }
+
+    // Linear-phase EQs move the latency whenever the chain order changes
+    if (engine.getLatencySamples() != getLatencySamples())
+        setLatencySamples(engine.getLatencySamples());
 }
 
 //==============================================================================
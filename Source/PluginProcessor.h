@@ -2,11 +2,13 @@
 
 #include <juce_audio_processors/juce_audio_processors.h>
 #include "OutsetVerbEngine.h"
+#include "OutsetVerbAPVTSAdapter.h"
 
 //==============================================================================
 /**
 */
-class OutsetVerbAudioProcessor  : public juce::AudioProcessor
+class OutsetVerbAudioProcessor  : public juce::AudioProcessor,
+                                  private juce::Timer
 {
 public:
     //==============================================================================
@@ -22,6 +24,9 @@ public:
    #endif
 
     void processBlock (juce::AudioBuffer<float>&, juce::MidiBuffer&) override;
+    void processBlock (juce::AudioBuffer<double>&, juce::MidiBuffer&) override;
+
+    bool supportsDoublePrecisionProcessing() const override;
 
     //==============================================================================
     juce::AudioProcessorEditor* createEditor() override;
@@ -48,10 +53,33 @@ public:
     
     // Declare as a unique_ptr so we can initialize it later
     std::unique_ptr<juce::AudioProcessorValueTreeState> apvts;
+    
+    // Feeds the engine from the APVTS
+    std::unique_ptr<OutsetVerbAPVTSAdapter> parameterAdapter;
 private:
     //==============================================================================
-    // Audio processing engine
-    std::unique_ptr<OutsetVerbEngine> engine;
+    // Audio processing engines, one per precision. Only the one matching the
+    // host's processing precision is prepared and run.
+    std::unique_ptr<OutsetVerbEngine<float>> floatEngine;
+    std::unique_ptr<OutsetVerbEngine<double>> doubleEngine;
+    
+    /** Shared body of both processBlock overloads. */
+    template<typename SampleType>
+    void processWithEngine (juce::AudioBuffer<SampleType>& buffer, OutsetVerbEngine<SampleType>& engine);
+    
+    /** Compiles a new chain order, prepares the engine again if the EQ structure
+        was switched, and passes on any change in its latency. Message thread only. */
+    template<typename SampleType>
+    void updateEngine (OutsetVerbEngine<SampleType>& engine);
+    
+    // What the active engine was last prepared with, so a new EQ structure can be
+    // applied between blocks
+    juce::dsp::ProcessSpec preparedSpec {};
+    bool enginePrepared = false;
+    
+    /** Keeps the chain order and EQ structure of the active engine up to date,
+        so none of that work lands on the audio thread. */
+    void timerCallback() override;
     
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (OutsetVerbAudioProcessor)
 };
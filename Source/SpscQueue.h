@@ -0,0 +1,90 @@
+/*
+  ==============================================================================
+
+    SpscQueue.h
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <atomic>
+#include <vector>
+
+//==============================================================================
+/**
+    A lock-free single-producer / single-consumer queue with a fixed capacity.
+
+    One thread calls push() and one other thread calls pop(); neither blocks
+    or allocates. Values come out in the order they went in. The storage is
+    allocated by setCapacity(), which must not run while either side is in use.
+*/
+template<typename ValueType>
+class SpscQueue
+{
+public:
+    //==============================================================================
+    SpscQueue() = default;
+
+    /** Makes room for at least capacity values and empties the queue. */
+    void setCapacity(int capacity)
+    {
+        size_t size = 2;
+
+        while (size < static_cast<size_t>(capacity) + 1)
+            size *= 2;
+
+        slots.assign(size, ValueType());
+        clear();
+    }
+
+    /** Empties the queue. Neither side may be in use. */
+    void clear() noexcept
+    {
+        head.store(0, std::memory_order_relaxed);
+        tail.store(0, std::memory_order_relaxed);
+    }
+
+    //==============================================================================
+    /** Producer side: adds a value. Returns false if the queue is full. */
+    bool push(const ValueType& value) noexcept
+    {
+        const auto currentTail = tail.load(std::memory_order_relaxed);
+        const auto nextTail = (currentTail + 1) & (slots.size() - 1);
+
+        if (nextTail == head.load(std::memory_order_acquire))
+            return false;
+
+        slots[currentTail] = value;
+        tail.store(nextTail, std::memory_order_release);
+        return true;
+    }
+
+    /** Consumer side: takes the oldest value. Returns false if the queue is empty. */
+    bool pop(ValueType& value) noexcept
+    {
+        const auto currentHead = head.load(std::memory_order_relaxed);
+
+        if (currentHead == tail.load(std::memory_order_acquire))
+            return false;
+
+        value = slots[currentHead];
+        head.store((currentHead + 1) & (slots.size() - 1), std::memory_order_release);
+        return true;
+    }
+
+    /** Either side: true if nothing is waiting to be popped. */
+    bool isEmpty() const noexcept
+    {
+        return head.load(std::memory_order_acquire) == tail.load(std::memory_order_acquire);
+    }
+
+private:
+    //==============================================================================
+    std::vector<ValueType> slots = std::vector<ValueType>(2);
+    std::atomic<size_t> head { 0 };
+    std::atomic<size_t> tail { 0 };
+
+    SpscQueue(const SpscQueue&) = delete;
+    SpscQueue& operator=(const SpscQueue&) = delete;
+};
@@ -0,0 +1,70 @@
+/*
+  ==============================================================================
+
+    TripleBuffer.h
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <array>
+#include <atomic>
+
+//==============================================================================
+/**
+    A lock-free single-producer / single-consumer triple buffer.
+
+    The writer fills getWriteBuffer() and calls publish(); the reader calls
+    fetch() and, if it returns true, reads the newest value via read(). Neither
+    side ever blocks or allocates, and the reader always sees a complete value.
+    Intermediate values published between two fetches are dropped.
+*/
+template<typename ValueType>
+class TripleBuffer
+{
+public:
+    //==============================================================================
+    TripleBuffer() = default;
+
+    //==============================================================================
+    /** Writer side: the slot to fill completely before calling publish(). */
+    ValueType& getWriteBuffer() noexcept { return buffers[static_cast<size_t>(writeIndex)]; }
+
+    /** Writer side: hands the filled slot to the reader. */
+    void publish() noexcept
+    {
+        writeIndex = sharedState.exchange(writeIndex | newDataFlag, std::memory_order_acq_rel) & indexMask;
+    }
+
+    //==============================================================================
+    /** Reader side: takes ownership of the newest published slot.
+        Returns false if nothing was published since the last fetch. */
+    bool fetch() noexcept
+    {
+        if ((sharedState.load(std::memory_order_relaxed) & newDataFlag) == 0)
+            return false;
+
+        readIndex = sharedState.exchange(readIndex, std::memory_order_acq_rel) & indexMask;
+        return true;
+    }
+
+    /** Reader side: the value picked up by the last successful fetch(). */
+    const ValueType& read() const noexcept { return buffers[static_cast<size_t>(readIndex)]; }
+
+private:
+    //==============================================================================
+    static constexpr int indexMask = 3;
+    static constexpr int newDataFlag = 4;
+
+    std::array<ValueType, 3> buffers {};
+
+    // Index of the slot in the middle, plus a flag set while it holds unread data
+    std::atomic<int> sharedState { 1 };
+
+    int writeIndex = 0;
+    int readIndex = 2;
+
+    TripleBuffer(const TripleBuffer&) = delete;
+    TripleBuffer& operator=(const TripleBuffer&) = delete;
+};
@@ -0,0 +1,184 @@
+/*
+  ==============================================================================
+
+    WorkerPool.cpp
+
+  ==============================================================================
+*/
+
+#include "WorkerPool.h"
+#include <juce_audio_basics/juce_audio_basics.h>
+
+//==============================================================================
+WorkerPool::WorkerPool(int numWorkers)
+    : ranges(new TaskRange[static_cast<size_t>(juce::jmax(0, numWorkers)) + 1])
+{
+    workers.reserve(static_cast<size_t>(juce::jmax(0, numWorkers)));
+
+    for (int index = 0; index < numWorkers; ++index)
+        workers.emplace_back([this, index] { workerLoop(index + 1); });
+}
+
+WorkerPool::~WorkerPool()
+{
+    {
+        std::lock_guard<std::mutex> lock(wakeMutex);
+        shouldExit = true;
+    }
+
+    wakeCondition.notify_all();
+
+    for (auto& worker : workers)
+        worker.join();
+}
+
+//==============================================================================
+void WorkerPool::runTasks(int numTasks, TaskFunction function, void* context)
+{
+    jassert(numTasks <= 0xffff);
+
+    if (numTasks <= 0)
+        return;
+
+    // Every task of the previous batch has finished, so nothing reads these now
+    taskFunction = function;
+    taskContext = context;
+    tasksRemaining.store(numTasks, std::memory_order_relaxed);
+
+    // Each thread starts on an even share of the tasks
+    const auto batch = currentBatch.load(std::memory_order_relaxed) + 1;
+    const int numThreads = getNumThreads();
+
+    for (int thread = 0; thread < numThreads; ++thread)
+        ranges[static_cast<size_t>(thread)].state.store(makeState(batch, numTasks * thread / numThreads, numTasks * (thread + 1) / numThreads),
+                                                        std::memory_order_release);
+
+    currentBatch.store(batch, std::memory_order_release);
+
+    // Taking the lock means a worker about to sleep either sees the new batch or gets
+    // the notification; workers that are still spinning pick it up without one
+    bool anyAsleep = false;
+
+    {
+        std::lock_guard<std::mutex> lock(wakeMutex);
+        anyAsleep = numSleepingWorkers > 0;
+    }
+
+    if (anyAsleep)
+        wakeCondition.notify_all();
+
+    runBatch(batch, 0);
+
+    auto batchFinished = [this] { return tasksRemaining.load(std::memory_order_acquire) == 0; };
+
+    if (! spinUntil(batchFinished))
+    {
+        std::unique_lock<std::mutex> lock(doneMutex);
+        doneCondition.wait(lock, batchFinished);
+    }
+}
+
+void WorkerPool::runBatch(std::uint32_t batch, int thread) noexcept
+{
+    auto& ownRange = ranges[static_cast<size_t>(thread)];
+
+    for (int task = 0; claimTask(ownRange, batch, task);)
+        runTask(task);
+
+    // Then help whoever still has work, starting with the next thread along. Stolen
+    // tasks are run straight away rather than published, so ranges never grow back.
+    const int numThreads = getNumThreads();
+
+    for (int offset = 1; offset < numThreads; ++offset)
+    {
+        auto& victim = ranges[static_cast<size_t>((thread + offset) % numThreads)];
+
+        for (int begin = 0, end = 0; stealTasks(victim, batch, begin, end);)
+            for (int task = begin; task < end; ++task)
+                runTask(task);
+    }
+}
+
+bool WorkerPool::claimTask(TaskRange& range, std::uint32_t batch, int& task) noexcept
+{
+    auto state = range.state.load(std::memory_order_acquire);
+
+    while (getBatch(state) == batch && getNextTask(state) < getEndTask(state))
+    {
+        // Claiming a task in this batch proves the batch is still running, so its
+        // function and context are still the ones published with it
+        if (range.state.compare_exchange_weak(state, makeState(batch, getNextTask(state) + 1, getEndTask(state)),
+                                              std::memory_order_acquire, std::memory_order_acquire))
+        {
+            task = getNextTask(state);
+            return true;
+        }
+    }
+
+    return false;
+}
+
+bool WorkerPool::stealTasks(TaskRange& range, std::uint32_t batch, int& begin, int& end) noexcept
+{
+    auto state = range.state.load(std::memory_order_acquire);
+
+    while (getBatch(state) == batch && getNextTask(state) < getEndTask(state))
+    {
+        // The owner keeps the front half, and a lone task goes to the thief
+        const int next = getNextTask(state);
+        const int middle = next + (getEndTask(state) - next) / 2;
+
+        if (range.state.compare_exchange_weak(state, makeState(batch, next, middle),
+                                              std::memory_order_acquire, std::memory_order_acquire))
+        {
+            begin = middle;
+            end = getEndTask(state);
+            return true;
+        }
+    }
+
+    return false;
+}
+
+void WorkerPool::runTask(int task) noexcept
+{
+    taskFunction(taskContext, task);
+
+    if (tasksRemaining.fetch_sub(1, std::memory_order_acq_rel) == 1)
+    {
+        // Taking the lock means run() either sees the count or gets the notification
+        {
+            std::lock_guard<std::mutex> lock(doneMutex);
+        }
+
+        doneCondition.notify_one();
+    }
+}
+
+void WorkerPool::workerLoop(int thread)
+{
+    // The tasks are audio processing, so flush denormals as the audio thread does
+    juce::ScopedNoDenormals noDenormals;
+
+    std::uint32_t lastBatch = 0;
+
+    for (;;)
+    {
+        // Spin briefly, as the next batch usually follows close behind, then sleep
+        auto newBatch = [this, &lastBatch] { return currentBatch.load(std::memory_order_acquire) != lastBatch; };
+
+        if (! spinUntil(newBatch))
+        {
+            std::unique_lock<std::mutex> lock(wakeMutex);
+            ++numSleepingWorkers;
+            wakeCondition.wait(lock, [this, &newBatch] { return shouldExit || newBatch(); });
+            --numSleepingWorkers;
+
+            if (shouldExit)
+                return;
+        }
+
+        lastBatch = currentBatch.load(std::memory_order_acquire);
+        runBatch(lastBatch, thread);
+    }
+}
@@ -0,0 +1,163 @@
+/*
+  ==============================================================================
+
+    WorkerPool.h
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <juce_core/juce_core.h>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#if JUCE_INTEL
+ #include <emmintrin.h>
+#endif
+
+//==============================================================================
+/**
+    A fixed set of worker threads that share out batches of small tasks.
+
+    run() hands a batch of numbered tasks to the workers and works on the batch
+    itself until every task has finished. The batch is split into one range of
+    tasks per thread, and each thread works through its own range from the front.
+    A thread whose range runs dry steals the back half of another thread's, so a
+    thread held up by a slow task leaves the rest of its share to the others.
+
+    Idle threads pause the core for at most maxSpinMicroseconds, so back-to-back
+    batches start without a wake-up, and then sleep on a condition variable until
+    the next batch; run() waits for the last task the same way. Nothing in run()
+    allocates, but it does wait for other threads, so it is meant for offline
+    rendering rather than a realtime audio thread. Call run() from one thread at
+    a time.
+*/
+class WorkerPool
+{
+public:
+    //==============================================================================
+    /** Starts numWorkers threads, in addition to the thread that calls run(). */
+    explicit WorkerPool(int numWorkers);
+
+    /** Stops and joins the workers. */
+    ~WorkerPool();
+
+    //==============================================================================
+    /** How many threads work on a batch, counting the one that calls run(). */
+    int getNumThreads() const noexcept { return static_cast<int>(workers.size()) + 1; }
+
+    /** Calls function(index) for every index from 0 to numTasks - 1, spread across
+        the workers and the calling thread, and returns once every call has returned. */
+    template<typename Function>
+    void run(int numTasks, Function& function)
+    {
+        runTasks(numTasks, [](void* context, int index) { (*static_cast<Function*>(context))(index); }, &function);
+    }
+
+    //==============================================================================
+    /** How long a thread that expects work at any moment checks for it before it
+        goes to sleep. */
+    static constexpr int maxSpinMicroseconds = 50;
+
+    /** Checks condition() until it holds or maxSpinMicroseconds have passed, pausing
+        the core between checks, and returns whether it held. A thread that gets
+        false back should block until it is woken. */
+    template<typename Condition>
+    static bool spinUntil(Condition&& condition) noexcept
+    {
+        const auto deadline = std::chrono::steady_clock::now() + std::chrono::microseconds(maxSpinMicroseconds);
+
+        for (;;)
+        {
+            // Reading the clock costs more than a check, so it is only read every so often
+            for (int check = 0; check < 64; ++check)
+            {
+                if (condition())
+                    return true;
+
+                pauseCore();
+            }
+
+            if (std::chrono::steady_clock::now() >= deadline)
+                return condition();
+        }
+    }
+
+private:
+    //==============================================================================
+    using TaskFunction = void (*)(void*, int);
+
+    // One thread's share of the batch being run. It packs the batch number with the
+    // next unclaimed task and the end of the range, so a thread that was slow to see
+    // a batch can never claim a task from the one after it. The owner claims from the
+    // front and thieves cut off the back, so a range only ever shrinks within a batch.
+    struct alignas(64) TaskRange
+    {
+        std::atomic<std::uint64_t> state { 0 };
+    };
+
+    std::unique_ptr<TaskRange[]> ranges;    // the caller's first, then one per worker
+    std::atomic<std::uint32_t> currentBatch { 0 };
+    std::atomic<int> tasksRemaining { 0 };
+    TaskFunction taskFunction = nullptr;
+    void* taskContext = nullptr;
+
+    std::vector<std::thread> workers;
+    std::mutex wakeMutex;
+    std::condition_variable wakeCondition;
+    int numSleepingWorkers = 0;     // guarded by wakeMutex
+    bool shouldExit = false;
+
+    // The thread finishing a batch's last task signals here, in case run() is asleep
+    std::mutex doneMutex;
+    std::condition_variable doneCondition;
+
+    /** Publishes a batch, helps run it and waits for it to finish. */
+    void runTasks(int numTasks, TaskFunction function, void* context);
+
+    /** Runs the given thread's range of the batch, then steals from the others
+        until none of them has anything left. */
+    void runBatch(std::uint32_t batch, int thread) noexcept;
+
+    /** Claims the next task of a range, returning false if it is empty or belongs
+        to another batch. */
+    bool claimTask(TaskRange& range, std::uint32_t batch, int& task) noexcept;
+
+    /** Cuts off the back half of a range, returning false if it is empty or belongs
+        to another batch. */
+    bool stealTasks(TaskRange& range, std::uint32_t batch, int& begin, int& end) noexcept;
+
+    /** Runs one claimed task and signals run() if it was the batch's last. */
+    void runTask(int task) noexcept;
+
+    void workerLoop(int thread);
+
+    static std::uint64_t makeState(std::uint32_t batch, int next, int end) noexcept
+    {
+        return (static_cast<std::uint64_t>(batch) << 32) | (static_cast<std::uint64_t>(next) << 16) | static_cast<std::uint64_t>(end);
+    }
+
+    static std::uint32_t getBatch(std::uint64_t state) noexcept { return static_cast<std::uint32_t>(state >> 32); }
+    static int getNextTask(std::uint64_t state) noexcept { return static_cast<int>((state >> 16) & 0xffff); }
+    static int getEndTask(std::uint64_t state) noexcept { return static_cast<int>(state & 0xffff); }
+
+    /** Tells the core this thread is spinning, so it can hand its resources to the
+        other hardware thread sharing it. */
+    static void pauseCore() noexcept
+    {
+       #if JUCE_INTEL
+        _mm_pause();
+       #elif JUCE_ARM && ! JUCE_MSVC
+        __asm__ __volatile__ ("yield");
+       #endif
+    }
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(WorkerPool)
+};
@@ -0,0 +1,282 @@
+/*
+  ==============================================================================
+
+    BatchEngineTests.cpp
+
+    Checks that every lane of an OutsetVerbBatchEngine sounds like an
+    OutsetVerbEngine<float> given the same parameters and audio.
+
+  ==============================================================================
+*/
+
+#include <juce_core/juce_core.h>
+#include <juce_dsp/juce_dsp.h>
+#include <memory>
+#include <vector>
+#include "../Source/OutsetVerbBatchEngine.h"
+#include "../Source/OutsetVerbEngine.h"
+
+//==============================================================================
+/**
+    Runs a batch and one single-instance engine per lane side by side over the
+    same noise, with different settings in every lane, and compares each lane
+    with its engine block by block: on serial and parallel chains, while
+    parameters move, and across a reset and a second prepare.
+
+    The batch keeps its filter state in float where the single path keeps the
+    EQ and the delay's feedback filter in double, so the two agree to within
+    rounding rather than bit for bit. The bit crusher always comes first: fed
+    audio that differs by rounding, it can land a whole step apart.
+*/
+class BatchEngineTests : public juce::UnitTest
+{
+public:
+    BatchEngineTests() : juce::UnitTest("Batch engine", "Engine") {}
+
+    void runTest() override
+    {
+        beginTest("Serial chain");
+        {
+            Harness harness(makeChain({ Parameters::bitCrusher, Parameters::delay, Parameters::eq, Parameters::reverb }, {}));
+            harness.run(*this, 40);
+        }
+
+        beginTest("Parallel stages");
+        {
+            // Delay and reverb in parallel after the bit crusher and the EQ
+            Harness harness(makeChain({ Parameters::bitCrusher, Parameters::eq, Parameters::delay, Parameters::reverb }, { 3 }));
+            harness.run(*this, 40);
+        }
+
+        beginTest("Parallel stage with a dry branch");
+        {
+            Harness harness(makeChain({ Parameters::delay, Parameters::none, Parameters::eq, Parameters::reverb }, { 1, 3 }));
+            harness.run(*this, 40);
+        }
+
+        beginTest("Parameter changes");
+        {
+            Harness harness(makeChain({ Parameters::bitCrusher, Parameters::delay, Parameters::eq, Parameters::reverb }, { 3 }));
+            harness.run(*this, 10);
+
+            // Glide every lane somewhere new, each its own way
+            harness.changeEveryLane([](size_t lane, Parameters& parameters)
+            {
+                const auto offset = static_cast<float>(lane);
+
+                parameters[Parameters::delayTimeParam] = 40.0f + 90.0f * offset;
+                parameters[Parameters::delayFeedbackParam] = 0.6f - 0.1f * offset;
+                parameters[Parameters::delayLowPassCutoffParam] = 2000.0f + 3000.0f * offset;
+                parameters[Parameters::eqBand1GainParam] = -6.0f + 2.0f * offset;
+                parameters[Parameters::eqBand1FreqParam + 1] = 300.0f * (offset + 1.0f);
+                parameters[Parameters::roomSizeParam] = 0.9f - 0.2f * offset;
+                parameters[Parameters::chainSlot1LevelParam + 1] = 0.5f + 0.1f * offset;
+            });
+
+            harness.run(*this, 10);
+
+            // Change the EQ's shape: more bands, a band turned into a steep cut,
+            // and a bypass in every other lane
+            harness.changeEveryLane([](size_t lane, Parameters& parameters)
+            {
+                parameters[Parameters::eqNumBandsParam] = 5.0f;
+                parameters[Parameters::eqBand1TypeParam + 3] = static_cast<float>(Parameters::bandHighPass);
+                parameters[Parameters::eqBand1FreqParam + 3] = 80.0f + 40.0f * static_cast<float>(lane);
+                parameters[Parameters::eqBand1SlopeParam + 3] = static_cast<float>(lane % 3);
+                parameters[Parameters::delayBypassParam] = lane % 2 == 0 ? 1.0f : 0.0f;
+            });
+
+            harness.run(*this, 20);
+
+            // Back the other way, with the bypassed effects brought in again
+            harness.changeEveryLane([](size_t lane, Parameters& parameters)
+            {
+                parameters[Parameters::eqNumBandsParam] = 2.0f;
+                parameters[Parameters::delayBypassParam] = 0.0f;
+                parameters[Parameters::reverbBypassParam] = lane % 2 == 1 ? 1.0f : 0.0f;
+                parameters[Parameters::bitDepthParam] = 6.0f + static_cast<float>(lane);
+            });
+
+            harness.run(*this, 20);
+        }
+
+        beginTest("Reset and prepare again");
+        {
+            // Long enough to fill the delay lines, so any history a reset
+            // left readable would be heard
+            const int blocksToFillDelay = static_cast<int>(2.0 * sampleRate) / blockSize + 1;
+
+            Harness harness(makeChain({ Parameters::delay, Parameters::reverb, Parameters::eq, Parameters::none }, {}));
+            harness.run(*this, blocksToFillDelay);
+
+            harness.reset();
+            harness.run(*this, blocksToFillDelay);
+
+            harness.prepare();
+            harness.run(*this, 20);
+        }
+    }
+
+private:
+    //==============================================================================
+    using Parameters = OutsetVerbParameters;
+
+    static constexpr size_t numLanes = OutsetVerbBatchEngine::numLanes;
+    static constexpr double sampleRate = 48000.0;
+    static constexpr int numChannels = 2;
+    static constexpr int blockSize = 256;
+
+    /** The largest difference allowed between a lane and its engine. */
+    static constexpr float tolerance = 1.0e-3f;
+
+    /** Puts the given effects in the first slots and switches each slot listed in
+        parallelSlots parallel with the one before it. */
+    static Parameters makeChain(std::initializer_list<Parameters::EffectType> effects, std::initializer_list<int> parallelSlots)
+    {
+        auto parameters = Parameters::getDefaults();
+        int slot = 0;
+
+        for (const auto effect : effects)
+            parameters[Parameters::chainSlot1Param + slot++] = static_cast<float>(effect);
+
+        for (const int parallelSlot : parallelSlots)
+            parameters[Parameters::chainSlot2ParallelParam + parallelSlot - 1] = 1.0f;
+
+        return parameters;
+    }
+
+    /** Gives a lane settings of its own, with every effect audible. */
+    static Parameters makeLaneParameters(const Parameters& chain, size_t lane)
+    {
+        auto parameters = chain;
+        const auto offset = static_cast<float>(lane);
+
+        parameters[Parameters::bitDepthParam] = 8.0f + offset;
+        parameters[Parameters::sampleRateReductionParam] = 1.0f + offset;
+        parameters[Parameters::bitCrusherMixParam] = 0.3f + 0.1f * offset;
+        parameters[Parameters::delayTimeParam] = 5.0f + 30.0f * offset;
+        parameters[Parameters::delayFeedbackParam] = 0.2f + 0.1f * offset;
+        parameters[Parameters::delayMixParam] = 0.4f;
+        parameters[Parameters::delayLowPassCutoffParam] = 4000.0f + 1000.0f * offset;
+        parameters[Parameters::eqBand1GainParam] = 3.0f;
+        parameters[Parameters::eqBand1GainParam + 1] = -4.0f + offset;
+        parameters[Parameters::eqBand1GainParam + 2] = 2.0f;
+        parameters[Parameters::roomSizeParam] = 0.3f + 0.1f * offset;
+        parameters[Parameters::dampingParam] = 0.2f + 0.15f * offset;
+        parameters[Parameters::widthParam] = 0.25f * offset;
+        parameters[Parameters::reverbMixParam] = 0.25f;
+        parameters[Parameters::chainSlot1LevelParam + 2] = 0.8f;
+
+        return parameters;
+    }
+
+    //==============================================================================
+    /** A batch and the single engines it is checked against, with their parameters. */
+    struct Harness
+    {
+        explicit Harness(const Parameters& chain)
+            : batch(chain)
+        {
+            for (size_t lane = 0; lane < numLanes; ++lane)
+            {
+                laneParameters[lane] = makeLaneParameters(chain, lane);
+                engines[lane] = std::make_unique<OutsetVerbEngine<float>>(laneParameters[lane]);
+
+                // Offline, so the engines design their filters inline as the batch does
+                engines[lane]->setNonRealtime(true);
+                batch.setParameters(lane, laneParameters[lane]);
+            }
+
+            prepare();
+        }
+
+        void prepare()
+        {
+            const juce::dsp::ProcessSpec spec { sampleRate, static_cast<juce::uint32>(blockSize), static_cast<juce::uint32>(numChannels) };
+
+            batch.prepare(spec);
+
+            for (auto& engine : engines)
+                engine->prepare(spec);
+        }
+
+        void reset()
+        {
+            batch.reset();
+
+            for (auto& engine : engines)
+                engine->reset();
+        }
+
+        /** Applies a change to every lane's parameters, in the batch and in its engine. */
+        template<typename Change>
+        void changeEveryLane(Change&& change)
+        {
+            for (size_t lane = 0; lane < numLanes; ++lane)
+            {
+                change(lane, laneParameters[lane]);
+                batch.setParameters(lane, laneParameters[lane]);
+                engines[lane]->setParameters(laneParameters[lane]);
+            }
+        }
+
+        /** Runs numBlocks blocks of fresh noise through both and compares every lane. */
+        void run(juce::UnitTest& test, int numBlocks)
+        {
+            std::array<juce::AudioBuffer<float>, numLanes> batchBuffers, engineBuffers;
+            std::array<juce::AudioBuffer<float>*, numLanes> batchPointers;
+
+            for (size_t lane = 0; lane < numLanes; ++lane)
+            {
+                batchBuffers[lane].setSize(numChannels, blockSize);
+                engineBuffers[lane].setSize(numChannels, blockSize);
+                batchPointers[lane] = &batchBuffers[lane];
+            }
+
+            float worstDifference = 0.0f;
+
+            for (int block = 0; block < numBlocks; ++block)
+            {
+                // Every lane and channel gets noise of its own, so no engine takes its
+                // input for dual mono
+                for (size_t lane = 0; lane < numLanes; ++lane)
+                {
+                    for (int channel = 0; channel < numChannels; ++channel)
+                    {
+                        for (int sample = 0; sample < blockSize; ++sample)
+                        {
+                            const float value = (random.nextFloat() * 2.0f - 1.0f) * 0.5f;
+                            batchBuffers[lane].setSample(channel, sample, value);
+                            engineBuffers[lane].setSample(channel, sample, value);
+                        }
+                    }
+                }
+
+                batch.processBlock(batchPointers);
+
+                for (size_t lane = 0; lane < numLanes; ++lane)
+                {
+                    engines[lane]->processBlock(engineBuffers[lane]);
+
+                    for (int channel = 0; channel < numChannels; ++channel)
+                    {
+                        const auto* batchData = batchBuffers[lane].getReadPointer(channel);
+                        const auto* engineData = engineBuffers[lane].getReadPointer(channel);
+
+                        for (int sample = 0; sample < blockSize; ++sample)
+                            worstDifference = juce::jmax(worstDifference, std::abs(batchData[sample] - engineData[sample]));
+                    }
+                }
+            }
+
+            test.expectLessThan(worstDifference, tolerance);
+        }
+
+        OutsetVerbBatchEngine batch;
+        std::array<std::unique_ptr<OutsetVerbEngine<float>>, numLanes> engines;
+        std::array<Parameters, numLanes> laneParameters;
+        juce::Random random { 1 };
+    };
+};
+
+static BatchEngineTests batchEngineTests;
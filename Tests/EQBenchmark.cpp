@@ -0,0 +1,173 @@
+/*
+  ==============================================================================
+
+    EQBenchmark.cpp
+
+    Times the EQ's fused cascade against running its bands one filter at a
+    time, the way ThreeBandEQNode did before the cascade. Run it with the
+    "Benchmarks" category; see TestMain.cpp.
+
+    The target is a cascade at least three times as fast. Each channel's
+    sections still run one sample after another, so the gain comes from
+    filtering a channel per SIMD lane: a lone channel has nothing to share its
+    lanes with and runs about as fast as the separate filters, and the target
+    is only in reach once every lane has a channel.
+
+  ==============================================================================
+*/
+
+#include <juce_core/juce_core.h>
+#include <juce_dsp/juce_dsp.h>
+#include <vector>
+#include "../Source/Effects/ThreeBandEQNode.h"
+
+//==============================================================================
+/**
+    Runs three boosted or cut bands - so none of them drops out - over the
+    same noise through both paths and logs the cost of each in nanoseconds
+    per sample per channel, and how many times faster the cascade is.
+*/
+class EQBenchmark : public juce::UnitTest
+{
+public:
+    EQBenchmark() : juce::UnitTest("EQ cascade", "Benchmarks") {}
+
+    void runTest() override
+    {
+        for (const int numChannels : { 1, 2, 8 })
+        {
+            beginTest(juce::String(numChannels) + (numChannels == 1 ? " channel" : " channels"));
+
+            const double perBand = timePerBand(numChannels);
+            const double fused = timeFused<float>(numChannels);
+            const double fusedDouble = timeFused<double>(numChannels);
+
+            const double speedup = perBand / fused;
+
+            logMessage("per band " + juce::String(perBand, 2) + " ns/sample, fused "
+                       + juce::String(fused, 2) + " ns/sample (" + juce::String(speedup, 2) + "x, "
+                       + (speedup >= targetSpeedup ? "meets" : "misses") + " the " + juce::String(targetSpeedup, 1) + "x target), "
+                       + "fused in double " + juce::String(fusedDouble, 2) + " ns/sample ("
+                       + juce::String(perBand / fusedDouble, 2) + "x)");
+
+            // Shared timing runs are too noisy to fail on the target itself, but with
+            // every lane in use the cascade has to come out ahead
+            if (numChannels >= numLanes)
+                expectGreaterThan(speedup, 1.5);
+        }
+    }
+
+private:
+    //==============================================================================
+    static constexpr double sampleRate = 48000.0;
+    static constexpr int blockSize = 512;
+    static constexpr int numBlocks = 2000;
+    static constexpr int numRuns = 5;
+
+    static constexpr double targetSpeedup = 3.0;
+    static constexpr int numLanes = static_cast<int>(juce::dsp::SIMDRegister<float>::SIMDNumElements);
+
+    static constexpr float lowGain = 4.0f, lowFreq = 120.0f;
+    static constexpr float midGain = -3.0f, midFreq = 1500.0f, midQ = 1.4f;
+    static constexpr float highGain = 2.5f, highFreq = 9000.0f;
+
+    /** Fills a buffer with noise, the same every time. */
+    static void fillWithNoise(juce::AudioBuffer<float>& buffer)
+    {
+        juce::Random random(1);
+
+        for (int channel = 0; channel < buffer.getNumChannels(); ++channel)
+            for (int sample = 0; sample < buffer.getNumSamples(); ++sample)
+                buffer.setSample(channel, sample, random.nextFloat() * 2.0f - 1.0f);
+    }
+
+    /** Runs process over numBlocks blocks numRuns times and returns the fastest
+        run in nanoseconds per sample per channel. */
+    template<typename ProcessFunction>
+    static double timeBlocks(int numChannels, ProcessFunction&& process)
+    {
+        juce::AudioBuffer<float> source(numChannels, blockSize), buffer(numChannels, blockSize);
+        fillWithNoise(source);
+
+        double fastest = 0.0;
+
+        for (int run = 0; run < numRuns; ++run)
+        {
+            const auto start = juce::Time::getHighResolutionTicks();
+
+            for (int block = 0; block < numBlocks; ++block)
+            {
+                for (int channel = 0; channel < numChannels; ++channel)
+                    buffer.copyFrom(channel, 0, source, channel, 0, blockSize);
+
+                process(buffer);
+            }
+
+            const double seconds = juce::Time::highResolutionTicksToSeconds(juce::Time::getHighResolutionTicks() - start);
+            const double nanoseconds = seconds * 1.0e9 / (static_cast<double>(numBlocks) * blockSize * numChannels);
+            fastest = run == 0 ? nanoseconds : juce::jmin(fastest, nanoseconds);
+        }
+
+        return fastest;
+    }
+
+    /** Three IIR::Filters per channel, one processSample() call each per sample. */
+    static double timePerBand(int numChannels)
+    {
+        using Filter = juce::dsp::IIR::Filter<float>;
+        using Coefficients = juce::dsp::IIR::Coefficients<float>;
+
+        const auto lowShelf = Coefficients::makeLowShelf(sampleRate, lowFreq, 0.707f, juce::Decibels::decibelsToGain(lowGain));
+        const auto mid = Coefficients::makePeakFilter(sampleRate, midFreq, midQ, juce::Decibels::decibelsToGain(midGain));
+        const auto highShelf = Coefficients::makeHighShelf(sampleRate, highFreq, 0.707f, juce::Decibels::decibelsToGain(highGain));
+
+        std::vector<Filter> lowShelfFilters, midFilters, highShelfFilters;
+
+        for (int channel = 0; channel < numChannels; ++channel)
+        {
+            lowShelfFilters.emplace_back(lowShelf);
+            midFilters.emplace_back(mid);
+            highShelfFilters.emplace_back(highShelf);
+        }
+
+        return timeBlocks(numChannels, [&](juce::AudioBuffer<float>& buffer)
+        {
+            for (int channel = 0; channel < numChannels; ++channel)
+            {
+                auto* data = buffer.getWritePointer(channel);
+                auto& lowShelfFilter = lowShelfFilters[static_cast<size_t>(channel)];
+                auto& midFilter = midFilters[static_cast<size_t>(channel)];
+                auto& highShelfFilter = highShelfFilters[static_cast<size_t>(channel)];
+
+                for (int sample = 0; sample < blockSize; ++sample)
+                    data[sample] = highShelfFilter.processSample(midFilter.processSample(lowShelfFilter.processSample(data[sample])));
+            }
+        });
+    }
+
+    /** ThreeBandEQNode, whose bands run as one cascade - in double precision, as
+        the engine runs its EQ, or in float like the filters it replaced. */
+    template<typename SampleType>
+    static double timeFused(int numChannels)
+    {
+        ThreeBandEQNode<SampleType> eq;
+        eq.setDesignInBackground(false);
+        eq.setSmoothingTime(0.0);
+        eq.setLowGain(lowGain);
+        eq.setLowFreq(lowFreq);
+        eq.setMidGain(midGain);
+        eq.setMidFreq(midFreq);
+        eq.setMidQ(midQ);
+        eq.setHighGain(highGain);
+        eq.setHighFreq(highFreq);
+        eq.prepare({ sampleRate, static_cast<juce::uint32>(blockSize), static_cast<juce::uint32>(numChannels) });
+
+        return timeBlocks(numChannels, [&eq](juce::AudioBuffer<float>& buffer)
+        {
+            juce::dsp::AudioBlock<float> block(buffer);
+            eq.process(juce::dsp::ProcessContextReplacing<float>(block));
+        });
+    }
+};
+
+static EQBenchmark eqBenchmark;
@@ -0,0 +1,293 @@
+/*
+  ==============================================================================
+
+    EngineTests.cpp
+
+    Checks how OutsetVerbEngine looks after its effect instances as the chain
+    order changes.
+
+  ==============================================================================
+*/
+
+#include <juce_core/juce_core.h>
+#include <juce_dsp/juce_dsp.h>
+#include <cmath>
+#include "../Source/OutsetVerbEngine.h"
+
+//==============================================================================
+/**
+    Drives an engine the way the plugin does, with the order handed over from
+    the same thread between blocks, as the message thread's timer would.
+*/
+class EngineTests : public juce::UnitTest
+{
+public:
+    EngineTests() : juce::UnitTest("Engine", "Engine") {}
+
+    void runTest() override
+    {
+        const auto fullChain = makeChain({ Parameters::delay, Parameters::reverb, Parameters::eq, Parameters::bitCrusher });
+        const auto eqOnly = makeChain({ Parameters::eq });
+
+        beginTest("Effects taken out of the chain give their state back");
+        {
+            OutsetVerbEngine<float> engine(fullChain);
+            engine.prepare(spec);
+            run(engine, 4);
+
+            const auto fullBytes = engine.getStateBytes();
+            expectGreaterThan(fullBytes, static_cast<size_t>(0));
+
+            // The instances only go once the crossfade away from them has finished
+            changeOrder(engine, eqOnly);
+            run(engine, crossfadeBlocks);
+            engine.updateChainOrder(eqOnly);
+
+            OutsetVerbEngine<float> reference(eqOnly);
+            reference.prepare(spec);
+
+            expectLessThan(engine.getStateBytes(), fullBytes);
+            expectEquals(engine.getStateBytes(), reference.getStateBytes());
+
+            // Bringing them back gives them fresh state. The EQ moves to another
+            // instance while the two orders crossfade, and gives the old one back after.
+            changeOrder(engine, fullChain);
+            expectGreaterThan(engine.getStateBytes(), fullBytes);
+            expect(run(engine, crossfadeBlocks), "The output stays finite");
+
+            engine.updateChainOrder(fullChain);
+            expectEquals(engine.getStateBytes(), fullBytes);
+        }
+
+        beginTest("An order replaced before it ran gives its state back");
+        {
+            OutsetVerbEngine<float> engine(eqOnly);
+            engine.prepare(spec);
+            run(engine, 4);
+
+            const auto eqBytes = engine.getStateBytes();
+
+            // The audio thread only ever sees the second order
+            changeOrder(engine, fullChain);
+            changeOrder(engine, makeChain({ Parameters::eq, Parameters::bitCrusher }));
+            run(engine, crossfadeBlocks);
+            engine.updateChainOrder(makeChain({ Parameters::eq, Parameters::bitCrusher }));
+
+            OutsetVerbEngine<float> reference(makeChain({ Parameters::eq, Parameters::bitCrusher }));
+            reference.prepare(spec);
+
+            expectGreaterThan(engine.getStateBytes(), eqBytes);
+            expectEquals(engine.getStateBytes(), reference.getStateBytes());
+        }
+
+        beginTest("Re-ordering a chain keeps its level");
+        {
+            // Well above the dry signal, so passing through it would be clearly heard.
+            // Both orders sound from the first sample, as neither is fully wet.
+            auto parameters = makeChain({ Parameters::delay, Parameters::eq });
+            parameters[Parameters::delayMixParam] = 0.5f;
+            parameters[Parameters::delayTimeParam] = 20.0f;
+            parameters[Parameters::delayFeedbackParam] = 0.5f;
+            parameters[Parameters::eqBand1GainParam + 2] = 12.0f;
+
+            OutsetVerbEngine<float> engine(parameters);
+            engine.prepare(spec);
+
+            const auto settledLevel = getLevel(engine, 100);
+
+            auto reordered = parameters;
+            reordered[Parameters::chainSlot1Param] = static_cast<float>(Parameters::eq);
+            reordered[Parameters::chainSlot1Param + 1] = static_cast<float>(Parameters::delay);
+            changeOrder(engine, reordered);
+
+            // The level is measured block by block through the crossfade and after it
+            float quietestLevel = settledLevel;
+
+            for (int block = 0; block < crossfadeBlocks; ++block)
+                quietestLevel = juce::jmin(quietestLevel, getLevel(engine, 1));
+
+            expectGreaterThan(quietestLevel, settledLevel * 0.7f);
+        }
+
+        beginTest("Parallel branches line up with a linear-phase EQ");
+        {
+            // A flat EQ in parallel with a dry branch, which only line up if the dry
+            // branch is delayed by as much as the EQ
+            auto parameters = makeChain({ Parameters::eq, Parameters::none });
+            parameters[Parameters::chainSlot2ParallelParam] = 1.0f;
+
+            OutsetVerbEngine<float> engine(parameters);
+            engine.setEQTopology(OutsetVerbEngine<float>::EQTopology::linearPhase);
+            engine.setNonRealtime(true);
+            engine.prepare(spec);
+
+            const int latency = engine.getLatencySamples();
+            expectGreaterThan(latency, 0);
+
+            const int numBlocks = latency / blockSize + 8;
+            juce::AudioBuffer<float> input(numChannels, blockSize * numBlocks), output(numChannels, blockSize * numBlocks);
+            juce::AudioBuffer<float> buffer(numChannels, blockSize);
+            fillWithNoise(input);
+
+            for (int block = 0; block < numBlocks; ++block)
+            {
+                for (int channel = 0; channel < numChannels; ++channel)
+                    buffer.copyFrom(channel, 0, input, channel, block * blockSize, blockSize);
+
+                engine.processBlock(buffer);
+
+                for (int channel = 0; channel < numChannels; ++channel)
+                    output.copyFrom(channel, block * blockSize, buffer, channel, 0, blockSize);
+            }
+
+            // Both branches come out as one copy of the input each, latency samples late
+            float worstDifference = 0.0f;
+
+            for (int channel = 0; channel < numChannels; ++channel)
+                for (int sample = latency; sample < blockSize * numBlocks; ++sample)
+                    worstDifference = juce::jmax(worstDifference, std::abs(output.getSample(channel, sample)
+                                                                           - 2.0f * input.getSample(channel, sample - latency)));
+
+            expectLessThan(worstDifference, 1.0e-2f);
+        }
+
+        beginTest("Pipelined rendering follows automation");
+        {
+            // Every effect in a stage of its own, with values moving every block
+            auto parameters = makeChain({ Parameters::delay, Parameters::eq, Parameters::reverb, Parameters::bitCrusher });
+            parameters[Parameters::eqBypassParam] = 0.0f;
+            parameters[Parameters::delayMixParam] = 0.5f;
+            parameters[Parameters::reverbMixParam] = 0.3f;
+
+            OutsetVerbEngine<float> single(parameters), pipelined(parameters);
+            single.setNonRealtime(true);
+            pipelined.setNonRealtime(true);
+            pipelined.setPipelined(true);
+            single.prepare(spec);
+            pipelined.prepare(spec);
+
+            const int latency = pipelined.getLatencySamples();
+            expectEquals(latency % blockSize, 0);
+
+            const int numBlocks = 60;
+            const int latencyBlocks = latency / blockSize;
+            juce::AudioBuffer<float> singleOutput(numChannels, blockSize * numBlocks), pipelinedOutput(numChannels, blockSize * numBlocks);
+
+            for (int block = 0; block < numBlocks; ++block)
+            {
+                parameters[Parameters::delayFeedbackParam] = 0.2f + 0.01f * static_cast<float>(block);
+                parameters[Parameters::eqBand1GainParam] = static_cast<float>(block % 12) - 6.0f;
+                parameters[Parameters::chainSlot1LevelParam + 2] = block % 2 == 0 ? 1.0f : 0.5f;
+                parameters[Parameters::bitCrusherBypassParam] = block % 20 < 10 ? 0.0f : 1.0f;
+                single.setParameters(parameters);
+                pipelined.setParameters(parameters);
+
+                juce::AudioBuffer<float> singleBlock(numChannels, blockSize);
+                fillWithNoise(singleBlock);
+
+                juce::AudioBuffer<float> pipelinedBlock(singleBlock);
+                single.processBlock(singleBlock);
+                pipelined.processBlock(pipelinedBlock);
+
+                for (int channel = 0; channel < numChannels; ++channel)
+                {
+                    singleOutput.copyFrom(channel, block * blockSize, singleBlock, channel, 0, blockSize);
+                    pipelinedOutput.copyFrom(channel, block * blockSize, pipelinedBlock, channel, 0, blockSize);
+                }
+            }
+
+            // Each tile meets every value change exactly where the single path does
+            float worstDifference = 0.0f;
+
+            for (int channel = 0; channel < numChannels; ++channel)
+                for (int sample = 0; sample < blockSize * (numBlocks - latencyBlocks); ++sample)
+                    worstDifference = juce::jmax(worstDifference, std::abs(singleOutput.getSample(channel, sample)
+                                                                           - pipelinedOutput.getSample(channel, sample + latency)));
+
+            expectLessThan(worstDifference, 1.0e-4f);
+        }
+    }
+
+private:
+    //==============================================================================
+    using Parameters = OutsetVerbParameters;
+
+    static constexpr double sampleRate = 48000.0;
+    static constexpr int numChannels = 2;
+    static constexpr int blockSize = 256;
+
+    /** Comfortably longer than the default crossfade between orders. */
+    static constexpr int crossfadeBlocks = 20;
+
+    const juce::dsp::ProcessSpec spec { sampleRate, static_cast<juce::uint32>(blockSize), static_cast<juce::uint32>(numChannels) };
+    juce::Random random { 0x5eed };
+
+    /** Puts the given effects in the first slots, all in series. */
+    static Parameters makeChain(std::initializer_list<Parameters::EffectType> effects)
+    {
+        auto parameters = Parameters::getDefaults();
+        auto effect = effects.begin();
+
+        for (int slot = 0; slot < Parameters::maxSlots; ++slot)
+            parameters[Parameters::chainSlot1Param + slot] = static_cast<float>(effect != effects.end() ? *effect++ : Parameters::none);
+
+        return parameters;
+    }
+
+    /** Hands the engine new values and the order in them. */
+    static void changeOrder(OutsetVerbEngine<float>& engine, const Parameters& parameters)
+    {
+        engine.setParameters(parameters);
+        engine.updateChainOrder(parameters);
+    }
+
+    /** Fills every channel with noise of its own, so the engine never takes it for dual mono. */
+    void fillWithNoise(juce::AudioBuffer<float>& buffer)
+    {
+        for (int channel = 0; channel < buffer.getNumChannels(); ++channel)
+            for (int sample = 0; sample < buffer.getNumSamples(); ++sample)
+                buffer.setSample(channel, sample, (random.nextFloat() * 2.0f - 1.0f) * 0.5f);
+    }
+
+    /** Runs numBlocks blocks of noise through the engine and returns the RMS level of
+        the last one. */
+    float getLevel(OutsetVerbEngine<float>& engine, int numBlocks)
+    {
+        juce::AudioBuffer<float> buffer(numChannels, blockSize);
+        double sumOfSquares = 0.0;
+
+        for (int block = 0; block < numBlocks; ++block)
+        {
+            fillWithNoise(buffer);
+            engine.processBlock(buffer);
+        }
+
+        for (int channel = 0; channel < numChannels; ++channel)
+            for (int sample = 0; sample < blockSize; ++sample)
+                sumOfSquares += static_cast<double>(buffer.getSample(channel, sample)) * buffer.getSample(channel, sample);
+
+        return static_cast<float>(std::sqrt(sumOfSquares / (numChannels * blockSize)));
+    }
+
+    /** Runs numBlocks blocks of noise through the engine and returns whether every
+        output sample was finite. */
+    bool run(OutsetVerbEngine<float>& engine, int numBlocks)
+    {
+        juce::AudioBuffer<float> buffer(numChannels, blockSize);
+        bool allFinite = true;
+
+        for (int block = 0; block < numBlocks; ++block)
+        {
+            fillWithNoise(buffer);
+            engine.processBlock(buffer);
+
+            for (int channel = 0; channel < numChannels; ++channel)
+                for (int sample = 0; sample < blockSize; ++sample)
+                    allFinite = allFinite && std::isfinite(buffer.getSample(channel, sample));
+        }
+
+        return allFinite;
+    }
+};
+
+static EngineTests engineTests;
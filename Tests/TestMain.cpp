@@ -0,0 +1,47 @@
+/*
+  ==============================================================================
+
+    TestMain.cpp
+
+    Console entry point for the tests. OutsetVerbTests.jucer in this folder
+    builds it as a console application with the juce_core, juce_audio_basics
+    and juce_dsp modules, every .cpp file in Source/Effects plus
+    Source/OutsetVerbEngine.cpp, Source/OutsetVerbBatchEngine.cpp and
+    Source/WorkerPool.cpp, and the other files in this folder.
+
+    With no arguments every category but "Benchmarks" runs; pass a category
+    name to run only that one.
+
+  ==============================================================================
+*/
+
+#include <juce_core/juce_core.h>
+
+//==============================================================================
+int main(int argc, char* argv[])
+{
+    juce::UnitTestRunner runner;
+    runner.setAssertOnFailure(false);
+
+    if (argc > 1)
+    {
+        runner.runTestsInCategory(argv[1]);
+    }
+    else
+    {
+        juce::Array<juce::UnitTest*> tests;
+
+        for (auto* test : juce::UnitTest::getAllTests())
+            if (test->getCategory() != "Benchmarks")
+                tests.add(test);
+
+        runner.runTests(tests);
+    }
+
+    int failures = 0;
+
+    for (int index = 0; index < runner.getNumResults(); ++index)
+        failures += runner.getResult(index)->failures;
+
+    return failures > 0 ? 1 : 0;
+}